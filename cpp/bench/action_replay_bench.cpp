@@ -0,0 +1,433 @@
+// Replays recorded model replies through the action pipeline
+// (AIResponseParser -> AIActionRegistry::execute) against a HeadlessBoard
+// and reports parse/apply time, heap allocations and the final board
+// checksum. The final board is then handed to a TaskContext as the chat
+// panel's setTasks() would, and the context built for "query" is timed
+// and folded into the checksum. A transcript is a JSON file:
+//
+//   {"name": "...", "seed_tasks": 0, "query": "...", "checksum": "0x...",
+//    "replies": ["text with inline JSON", {"content": "", "tool_calls": []}]}
+//
+// A transcript file without "checksum", or with a different one, fails the
+// run; --record writes the current checksums back into the files instead.
+// Generated transcripts (--synthetic) carry no checksum.
+
+#include "ai/ai_action_registry.hpp"
+#include "ai/ai_response_parser.hpp"
+#include "alloc_counter.hpp"
+#include "headless_board.hpp"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+
+#ifndef DEVPLANNER_BENCH_TRANSCRIPTS
+#define DEVPLANNER_BENCH_TRANSCRIPTS "transcripts"
+#endif
+
+using namespace DevPlanner;
+
+namespace {
+
+struct Transcript {
+  QString name;
+  QString path; // empty for generated transcripts
+  int seedTasks = 0;
+  QString query;
+  QString expectedChecksum;
+  QJsonArray replies;
+};
+
+struct Result {
+  int actions = 0;
+  int failures = 0;
+  int tasks = 0;
+  int connections = 0;
+  double parseMedianMs = 0;
+  double parseMinMs = 0;
+  double applyMedianMs = 0;
+  double applyMinMs = 0;
+  double contextMedianMs = 0;
+  int contextChars = 0;
+  QString dependencySummary;
+  AllocStats parseAllocs;
+  AllocStats applyAllocs;
+  QString checksum;
+};
+
+QTextStream &out() {
+  static QTextStream stream(stdout);
+  return stream;
+}
+
+bool loadTranscript(const QString &path, Transcript *t, QString *error) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    *error = file.errorString();
+    return false;
+  }
+  QJsonParseError parseError;
+  QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+  if (!doc.isObject()) {
+    *error = parseError.errorString();
+    return false;
+  }
+  QJsonObject o = doc.object();
+  t->name = o["name"].toString(QFileInfo(path).completeBaseName());
+  t->path = path;
+  t->seedTasks = o["seed_tasks"].toInt();
+  t->query = o["query"].toString();
+  t->expectedChecksum = o["checksum"].toString();
+  t->replies = o["replies"].toArray();
+  return true;
+}
+
+bool recordChecksum(const Transcript &t, const QString &checksum) {
+  QFile file(t.path);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+  QJsonObject o = QJsonDocument::fromJson(file.readAll()).object();
+  file.close();
+  o["checksum"] = checksum;
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+  file.write(QJsonDocument(o).toJson(QJsonDocument::Indented));
+  return true;
+}
+
+// Deterministic replies shaped like real ones: prose around inline JSON,
+// {"actions": [...]} wrappers, chains, and tool calls with string arguments
+Transcript generate(int actionCount) {
+  Transcript t;
+  t.name = QString("synthetic-%1").arg(actionCount);
+  // Large enough boards go through retrieval
+  t.query = "модуль 7: статус задач после этапа 2";
+  const QStringList statuses = {"todo", "progress", "done", "none"};
+  quint32 rng = 0x9e3779b9u ^ quint32(actionCount);
+  auto next = [&rng](int bound) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return int(rng % quint32(bound));
+  };
+
+  int emitted = 0;
+  int tasks = 0;
+  int reply = 0;
+  while (emitted < actionCount) {
+    int batch = std::min(actionCount - emitted, 1 + next(40));
+    QJsonArray actions;
+    for (int i = 0; i < batch; ++i) {
+      QJsonObject a;
+      int kind = tasks < 3 ? 0 : next(10);
+      if (kind <= 3) {
+        a["action"] = "create_task";
+        a["title"] = QString("Задача %1: модуль %2").arg(tasks + 1).arg(
+            next(100));
+        a["description"] = QString("Описание {шаг %1} с деталями и "
+                                   "критериями приёмки")
+                               .arg(next(1000));
+        a["status"] = statuses[next(statuses.size())];
+        tasks++;
+      } else if (kind == 4) {
+        QJsonArray chain;
+        int len = 2 + next(4);
+        for (int k = 0; k < len; ++k)
+          chain.append(QJsonObject{{"title", QString("Этап %1").arg(k + 1)}});
+        a["action"] = "create_tasks_chain";
+        a["tasks"] = chain;
+        tasks += len;
+      } else if (kind <= 6) {
+        a["action"] = "connect";
+        a["from"] = 1 + next(tasks);
+        a["to"] = 1 + next(tasks);
+      } else if (kind == 7) {
+        a["action"] = "set_status";
+        a["task"] = 1 + next(tasks);
+        a["status"] = statuses[next(statuses.size())];
+      } else if (kind == 8) {
+        a["action"] = "rename";
+        a["task"] = 1 + next(tasks);
+        a["title"] = QString("Переименовано %1").arg(next(1000));
+      } else {
+        QJsonArray many;
+        for (int k = 0; k < 5; ++k)
+          many.append(1 + next(tasks));
+        a["action"] = "set_many_status";
+        a["tasks"] = many;
+        a["status"] = "done";
+      }
+      actions.append(a);
+    }
+    emitted += batch;
+
+    switch (reply++ % 3) {
+    case 0: {
+      QString text = "Сделаю так:\n";
+      for (const auto &a : actions)
+        text += QString::fromUtf8(
+                    QJsonDocument(a.toObject()).toJson(
+                        QJsonDocument::Compact)) +
+                "\n";
+      t.replies.append(text + "Готово");
+      break;
+    }
+    case 1:
+      t.replies.append(QString::fromUtf8(
+          QJsonDocument(QJsonObject{{"actions", actions}})
+              .toJson(QJsonDocument::Indented)));
+      break;
+    default: {
+      QJsonArray calls;
+      for (int i = 0; i < actions.size(); ++i) {
+        QJsonObject args = actions[i].toObject();
+        QString name = args.take("action").toString();
+        calls.append(QJsonObject{
+            {"id", QString("call_%1_%2").arg(reply).arg(i)},
+            {"type", "function"},
+            {"function",
+             QJsonObject{{"name", name},
+                         {"arguments", QString::fromUtf8(
+                                           QJsonDocument(args).toJson(
+                                               QJsonDocument::Compact))}}}});
+      }
+      t.replies.append(QJsonObject{{"content", ""}, {"tool_calls", calls}});
+    }
+    }
+  }
+  return t;
+}
+
+QList<QJsonObject> parseReply(const QJsonValue &reply) {
+  if (reply.isString())
+    return AIResponseParser::inlineActions(reply.toString());
+  QJsonObject message = reply.toObject();
+  QJsonArray toolCalls = message["tool_calls"].toArray();
+  if (toolCalls.isEmpty())
+    return AIResponseParser::inlineActions(message["content"].toString());
+  return AIResponseParser::toolCallActions(toolCalls);
+}
+
+double median(QVector<double> v) {
+  std::sort(v.begin(), v.end());
+  return v.isEmpty() ? 0 : v[v.size() / 2];
+}
+
+Result run(const Transcript &t, int iterations) {
+  Result r;
+  auto &registry = AIActionRegistry::instance();
+  QVector<double> parseMs, applyMs, contextMs;
+  HeadlessBoard board;
+  TaskContext context;
+  QList<TaskSnapshot> tasks;
+  QList<QPair<int, int>> connections;
+  QString contextText;
+
+  // The first pass warms up caches and is not measured
+  for (int it = -1; it < iterations; ++it) {
+    board.clear();
+    board.seed(t.seedTasks);
+    ActionContext ctx = board.context();
+
+    QList<QList<QJsonObject>> parsed;
+    parsed.reserve(t.replies.size());
+    AllocStats before = allocStats();
+    QElapsedTimer timer;
+    timer.start();
+    for (const auto &reply : t.replies)
+      parsed.append(parseReply(reply));
+    qint64 parseNs = timer.nsecsElapsed();
+    AllocStats parseAllocs = allocStats() - before;
+
+    int actions = 0;
+    int failures = 0;
+    before = allocStats();
+    timer.restart();
+    for (const auto &replyActions : parsed) {
+      for (const auto &a : replyActions) {
+        QString name = a["action"].toString();
+        if (name.isEmpty())
+          continue;
+        actions++;
+        if (isActionFailure(registry.execute(name, a, ctx)))
+          failures++;
+      }
+    }
+    qint64 applyNs = timer.nsecsElapsed();
+    AllocStats applyAllocs = allocStats() - before;
+
+    timer.restart();
+    board.snapshot(&tasks, &connections);
+    context.setTasks(tasks, connections);
+    contextText = context.build(t.query);
+    qint64 contextNs = timer.nsecsElapsed();
+
+    if (it < 0)
+      continue;
+    parseMs.append(parseNs / 1e6);
+    applyMs.append(applyNs / 1e6);
+    contextMs.append(contextNs / 1e6);
+    r.actions = actions;
+    r.failures = failures;
+    r.parseAllocs = parseAllocs;
+    r.applyAllocs = applyAllocs;
+  }
+
+  r.parseMedianMs = median(parseMs);
+  r.parseMinMs = *std::min_element(parseMs.begin(), parseMs.end());
+  r.applyMedianMs = median(applyMs);
+  r.applyMinMs = *std::min_element(applyMs.begin(), applyMs.end());
+  r.contextMedianMs = median(contextMs);
+  r.contextChars = contextText.size();
+  r.dependencySummary = context.dependencySummary();
+  r.tasks = board.taskCount();
+  r.connections = board.connectionCount();
+  quint64 checksum =
+      HeadlessBoard::checksum(board.checksum(), contextText.toUtf8());
+  r.checksum = "0x" + QString::number(checksum, 16).rightJustified(16, '0');
+  return r;
+}
+
+void usage() {
+  out() << "Usage: action_replay_bench [options] [transcript.json | dir]...\n"
+           "  --iterations N  measured passes per transcript (default 20)\n"
+           "  --synthetic     also replay generated transcripts "
+           "(100, 1000, 5000 actions)\n"
+           "  --record        store the resulting checksums in the files\n"
+           "  --json          print results as JSON lines\n"
+           "Without paths the bundled transcripts are used: "
+        << DEVPLANNER_BENCH_TRANSCRIPTS << "\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  registerAllActions();
+
+  int iterations = 20;
+  bool synthetic = false;
+  bool record = false;
+  bool json = false;
+  QStringList paths;
+  QStringList args = app.arguments().mid(1);
+  for (int i = 0; i < args.size(); ++i) {
+    const QString &a = args[i];
+    if (a == "--iterations" && i + 1 < args.size())
+      iterations = std::max(1, args[++i].toInt());
+    else if (a == "--synthetic")
+      synthetic = true;
+    else if (a == "--record")
+      record = true;
+    else if (a == "--json")
+      json = true;
+    else if (a == "--help" || a == "-h") {
+      usage();
+      return 0;
+    } else
+      paths << a;
+  }
+  if (paths.isEmpty())
+    paths << DEVPLANNER_BENCH_TRANSCRIPTS;
+
+  QList<Transcript> transcripts;
+  for (const auto &path : paths) {
+    QStringList files;
+    if (QFileInfo(path).isDir()) {
+      QDir dir(path);
+      for (const auto &f : dir.entryList({"*.json"}, QDir::Files, QDir::Name))
+        files << dir.filePath(f);
+    } else {
+      files << path;
+    }
+    for (const auto &f : files) {
+      Transcript t;
+      QString error;
+      if (!loadTranscript(f, &t, &error)) {
+        std::fprintf(stderr, "%s: %s\n", qPrintable(f), qPrintable(error));
+        return 2;
+      }
+      transcripts << t;
+    }
+  }
+  if (synthetic) {
+    for (int n : {100, 1000, 5000})
+      transcripts << generate(n);
+  }
+
+  if (!json) {
+    out() << QString("%1 %2 %3 %4 %5 %6 %7 %8  %9\n")
+                 .arg("transcript", -24)
+                 .arg("actions", 8)
+                 .arg("parse ms", 10)
+                 .arg("apply ms", 10)
+                 .arg("context ms", 10)
+                 .arg("parse alloc", 12)
+                 .arg("apply alloc", 12)
+                 .arg("tasks", 6)
+                 .arg("checksum");
+  }
+
+  int mismatches = 0;
+  for (const auto &t : transcripts) {
+    Result r = run(t, iterations);
+    QString verdict;
+    bool verify = !record && !t.path.isEmpty();
+    if (verify && t.expectedChecksum.isEmpty()) {
+      verdict = "NO CHECKSUM, run with --record";
+      mismatches++;
+    } else if (verify && t.expectedChecksum != r.checksum) {
+      verdict = "MISMATCH, expected " + t.expectedChecksum;
+      mismatches++;
+    }
+    if (record && !t.path.isEmpty() && !recordChecksum(t, r.checksum))
+      std::fprintf(stderr, "%s: could not record checksum\n",
+                   qPrintable(t.path));
+
+    if (json) {
+      QJsonObject o{{"name", t.name},
+                    {"actions", r.actions},
+                    {"failures", r.failures},
+                    {"parse_ms_median", r.parseMedianMs},
+                    {"parse_ms_min", r.parseMinMs},
+                    {"apply_ms_median", r.applyMedianMs},
+                    {"apply_ms_min", r.applyMinMs},
+                    {"context_ms_median", r.contextMedianMs},
+                    {"context_chars", r.contextChars},
+                    {"dependency_summary", r.dependencySummary},
+                    {"parse_allocs", qint64(r.parseAllocs.count)},
+                    {"parse_alloc_bytes", qint64(r.parseAllocs.bytes)},
+                    {"apply_allocs", qint64(r.applyAllocs.count)},
+                    {"apply_alloc_bytes", qint64(r.applyAllocs.bytes)},
+                    {"tasks", r.tasks},
+                    {"connections", r.connections},
+                    {"checksum", r.checksum},
+                    {"checksum_ok", verdict.isEmpty()}};
+      out() << QJsonDocument(o).toJson(QJsonDocument::Compact) << "\n";
+    } else {
+      out() << QString("%1 %2 %3 %4 %5 %6 %7 %8  %9 %10\n")
+                   .arg(t.name.left(24), -24)
+                   .arg(r.actions, 8)
+                   .arg(r.parseMedianMs, 10, 'f', 3)
+                   .arg(r.applyMedianMs, 10, 'f', 3)
+                   .arg(r.contextMedianMs, 10, 'f', 3)
+                   .arg(qint64(r.parseAllocs.count), 12)
+                   .arg(qint64(r.applyAllocs.count), 12)
+                   .arg(r.tasks, 6)
+                   .arg(r.checksum)
+                   .arg(verdict);
+    }
+  }
+
+  if (!json && !allocStatsCoverMalloc())
+    out() << "note: allocation counts include operator new only\n";
+  out().flush();
+  return mismatches > 0 ? 1 : 0;
+}
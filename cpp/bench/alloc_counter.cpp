@@ -0,0 +1,76 @@
+#include "alloc_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> g_count{0};
+std::atomic<std::uint64_t> g_bytes{0};
+
+inline void record(std::size_t size) {
+  g_count.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+
+// glibc exports its allocator under __libc_* names, so the executable can
+// interpose malloc without dlsym. operator new ends up here as well.
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t n, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+
+void *malloc(std::size_t size) {
+  record(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t n, std::size_t size) {
+  record(n * size);
+  return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, std::size_t size) {
+  record(size);
+  return __libc_realloc(ptr, size);
+}
+}
+
+#else
+
+void *operator new(std::size_t size) {
+  record(size);
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+#endif
+
+namespace DevPlanner {
+
+AllocStats allocStats() {
+  return {g_count.load(std::memory_order_relaxed),
+          g_bytes.load(std::memory_order_relaxed)};
+}
+
+bool allocStatsCoverMalloc() {
+#if defined(__GLIBC__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,25 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstdint>
+
+namespace DevPlanner {
+
+// Process-wide heap allocation counters. On glibc malloc itself is wrapped,
+// which also covers Qt containers; elsewhere only operator new is seen.
+struct AllocStats {
+  std::uint64_t count = 0;
+  std::uint64_t bytes = 0;
+
+  AllocStats operator-(const AllocStats &o) const {
+    return {count - o.count, bytes - o.bytes};
+  }
+};
+
+AllocStats allocStats();
+// Whether allocations made by Qt (malloc) are included
+bool allocStatsCoverMalloc();
+
+} // namespace DevPlanner
+
+#endif
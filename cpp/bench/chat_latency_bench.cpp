@@ -0,0 +1,217 @@
+// End-to-end latency of the chat pipeline against MockOpenRouterServer:
+// AIChatPanel::submit() -> request queue -> OpenAIProvider (SSE or JSON)
+// -> reply parsing -> action execution. Requests are sent one at a time and
+// each is timed to the first streamed token, the first applied action and
+// the last applied action (the reply fully handled).
+
+#include "ai/ai_action_registry.hpp"
+#include "ai/providers/provider_registry.hpp"
+#include "mock_openrouter_server.hpp"
+#include "ui/ai_chat_panel.hpp"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <cstdio>
+
+using namespace DevPlanner;
+
+namespace {
+
+struct Options {
+  int requests = 50;
+  int actions = 20;
+  bool stream = true;
+  bool toolCalls = true;
+  int timeoutMs = 60000;
+  MockOpenRouterServer::Config server;
+};
+
+void usage() {
+  QTextStream(stdout)
+      << "Usage: chat_latency_bench [options]\n"
+         "  --requests N        requests to send (default 50)\n"
+         "  --actions N         actions per reply (default 20)\n"
+         "  --latency MS        server delay before headers (default 200)\n"
+         "  --jitter MS         extra uniform delay (default 0)\n"
+         "  --chunk-chars N     characters per SSE delta (default 64)\n"
+         "  --chunk-interval MS delay between SSE deltas (default 5)\n"
+         "  --error-rate R      share of HTTP errors, 0..1 (default 0)\n"
+         "  --drop-rate R       share of streams cut halfway (default 0)\n"
+         "  --no-stream         plain JSON responses\n"
+         "  --inline            inline JSON actions instead of tool calls\n";
+}
+
+bool parseOptions(const QStringList &args, Options *o) {
+  for (int i = 0; i < args.size(); ++i) {
+    const QString &a = args[i];
+    if (a == "--no-stream") {
+      o->stream = false;
+      continue;
+    }
+    if (a == "--inline") {
+      o->toolCalls = false;
+      continue;
+    }
+    if (i + 1 >= args.size())
+      return false;
+    QString value = args[++i];
+    if (a == "--requests")
+      o->requests = qMax(1, value.toInt());
+    else if (a == "--actions")
+      o->actions = qMax(0, value.toInt());
+    else if (a == "--latency")
+      o->server.latencyMs = value.toInt();
+    else if (a == "--jitter")
+      o->server.jitterMs = value.toInt();
+    else if (a == "--chunk-chars")
+      o->server.chunkChars = value.toInt();
+    else if (a == "--chunk-interval")
+      o->server.chunkIntervalMs = value.toInt();
+    else if (a == "--error-rate")
+      o->server.errorRate = value.toDouble();
+    else if (a == "--drop-rate")
+      o->server.dropRate = value.toDouble();
+    else
+      return false;
+  }
+  return true;
+}
+
+QString row(const QString &name, const LatencyStats &s) {
+  return QString("%1 %2 %3 %4 %5\n")
+      .arg(name, -22)
+      .arg(s.count(), 6)
+      .arg(s.percentile(0.5), 10, 'f', 1)
+      .arg(s.percentile(0.95), 10, 'f', 1)
+      .arg(s.mean(), 10, 'f', 1);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  // No window is shown; keep the harness usable on headless machines
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  // Settings, providers.json and the response cache go to a scratch home
+  QTemporaryDir home;
+  qputenv("HOME", home.path().toUtf8());
+  qputenv("USERPROFILE", home.path().toUtf8());
+
+  QApplication app(argc, argv);
+  Options options;
+  if (!parseOptions(app.arguments().mid(1), &options)) {
+    usage();
+    return 2;
+  }
+  registerAllActions();
+
+  options.server.replies.append(
+      options.toolCalls ? MockOpenRouterServer::toolCallReply(options.actions)
+                        : MockOpenRouterServer::inlineReply(options.actions));
+  MockOpenRouterServer server(options.server);
+  if (!server.listen()) {
+    std::fprintf(stderr, "could not listen on 127.0.0.1\n");
+    return 1;
+  }
+
+  AIChatPanel panel;
+  ProviderConfig config;
+  config.id = "mock-openrouter";
+  config.name = "Mock OpenRouter";
+  config.baseUrl = server.baseUrl();
+  config.auth = "bearer";
+  config.apiKey = "sk-mock";
+  config.models = {"mock/model"};
+  config.options["stream"] = options.stream;
+  panel.providers()->addProvider(config);
+  if (!panel.selectModel(config.id, "mock/model")) {
+    std::fprintf(stderr, "mock provider is not selectable\n");
+    return 1;
+  }
+
+  // The board the replies build, handed back whenever the panel builds a
+  // request, so the prompt grows as it would against the canvas
+  QList<TaskSnapshot> board;
+  QList<QPair<int, int>> connections;
+  QObject::connect(&panel, &AIChatPanel::taskCreated,
+                   [&](const QString &title, const QString &description,
+                       const QString &status, int, int) {
+                     board.append({title, description, status});
+                   });
+  QObject::connect(&panel, &AIChatPanel::tasksConnect,
+                   [&](int from, int to) { connections.append({from, to}); });
+  QObject::connect(&panel, &AIChatPanel::taskUpdateStatus,
+                   [&](int idx, const QString &status) {
+                     if (idx >= 0 && idx < board.size())
+                       board[idx].status = status;
+                   });
+  QObject::connect(&panel, &AIChatPanel::requestTasks,
+                   [&]() { panel.setTasks(board, connections); });
+
+  LatencyStats firstToken(options.requests);
+  LatencyStats firstAction(options.requests);
+  LatencyStats lastAction(options.requests);
+  int timeouts = 0;
+
+  QElapsedTimer clock;
+  bool started = false;
+  bool applied = false;
+  QEventLoop loop;
+  QObject::connect(&panel, &AIChatPanel::replyStarted, [&]() {
+    if (!started)
+      firstToken.add(clock.nsecsElapsed() / 1e6);
+    started = true;
+  });
+  QObject::connect(&panel, &AIChatPanel::actionApplied, [&]() {
+    if (!applied)
+      firstAction.add(clock.nsecsElapsed() / 1e6);
+    applied = true;
+  });
+  QObject::connect(&panel, &AIChatPanel::replyHandled, [&]() {
+    if (applied)
+      lastAction.add(clock.nsecsElapsed() / 1e6);
+    loop.quit();
+  });
+  QTimer timeout;
+  timeout.setSingleShot(true);
+  QObject::connect(&timeout, &QTimer::timeout, [&]() {
+    timeouts++;
+    loop.quit();
+  });
+
+  for (int i = 0; i < options.requests; ++i) {
+    started = applied = false;
+    clock.start();
+    // Distinct prompts, so the response cache never answers
+    panel.submit(QString("Запрос %1: распиши план этапа %1").arg(i + 1));
+    timeout.start(options.timeoutMs);
+    loop.exec();
+    timeout.stop();
+  }
+
+  QTextStream out(stdout);
+  out << QString("%1 requests, %2 actions per reply, %3, %4, server latency "
+                 "%5 ms\n\n")
+             .arg(options.requests)
+             .arg(options.actions)
+             .arg(options.stream ? "SSE" : "JSON")
+             .arg(options.toolCalls ? "tool calls" : "inline JSON")
+             .arg(options.server.latencyMs);
+  out << QString("%1 %2 %3 %4 %5\n")
+             .arg("ms", -22)
+             .arg("n", 6)
+             .arg("p50", 10)
+             .arg("p95", 10)
+             .arg("mean", 10);
+  out << row("first token", firstToken);
+  out << row("first action applied", firstAction);
+  out << row("last action applied", lastAction);
+  out << QString("\nserver requests: %1, timeouts: %2\n")
+             .arg(server.requestCount())
+             .arg(timeouts);
+  return timeouts > 0 ? 1 : 0;
+}
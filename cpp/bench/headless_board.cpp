@@ -0,0 +1,158 @@
+#include "headless_board.hpp"
+#include <QHash>
+#include <algorithm>
+
+namespace DevPlanner {
+
+namespace {
+
+constexpr quint64 FNV_OFFSET = 14695981039346656037ULL;
+constexpr quint64 FNV_PRIME = 1099511628211ULL;
+
+void hashBytes(quint64 &h, const QByteArray &bytes) {
+  for (char c : bytes) {
+    h ^= static_cast<unsigned char>(c);
+    h *= FNV_PRIME;
+  }
+  // Field separator, so "ab"+"c" and "a"+"bc" differ
+  h ^= 0x1f;
+  h *= FNV_PRIME;
+}
+
+void hashInt(quint64 &h, qint64 v) { hashBytes(h, QByteArray::number(v)); }
+
+} // namespace
+
+ActionContext HeadlessBoard::context() {
+  ActionContext ctx;
+
+  ctx.createTask = [this](const QString &title, const QString &desc,
+                          const QString &status, int x, int y) {
+    m_tasks.append({m_nextId++, title, desc, status, x, y});
+  };
+
+  ctx.connectTasks = [this](int from, int to) {
+    if (from < 0 || to < 0 || from >= m_tasks.size() ||
+        to >= m_tasks.size() || from == to)
+      return;
+    m_connections.append(qMakePair(m_tasks[from].id, m_tasks[to].id));
+  };
+
+  ctx.disconnectTasks = [this](int from, int to) {
+    if (from < 0 || to < 0 || from >= m_tasks.size() || to >= m_tasks.size())
+      return;
+    quint64 f = m_tasks[from].id, t = m_tasks[to].id;
+    m_connections.erase(
+        std::remove_if(m_connections.begin(), m_connections.end(),
+                       [f, t](const auto &c) {
+                         return (c.first == f && c.second == t) ||
+                                (c.first == t && c.second == f);
+                       }),
+        m_connections.end());
+  };
+
+  ctx.setStatus = [this](int idx, const QString &status) {
+    if (idx >= 0 && idx < m_tasks.size())
+      m_tasks[idx].status = status;
+  };
+
+  ctx.setTitle = [this](int idx, const QString &title) {
+    if (idx >= 0 && idx < m_tasks.size())
+      m_tasks[idx].title = title;
+  };
+
+  ctx.setDescription = [this](int idx, const QString &desc) {
+    if (idx >= 0 && idx < m_tasks.size())
+      m_tasks[idx].description = desc;
+  };
+
+  ctx.deleteTask = [this](int idx) {
+    if (idx < 0 || idx >= m_tasks.size())
+      return;
+    quint64 id = m_tasks.takeAt(idx).id;
+    m_connections.erase(std::remove_if(m_connections.begin(),
+                                       m_connections.end(),
+                                       [id](const auto &c) {
+                                         return c.first == id ||
+                                                c.second == id;
+                                       }),
+                        m_connections.end());
+  };
+
+  ctx.clearAll = [this]() {
+    m_tasks.clear();
+    m_connections.clear();
+  };
+
+  ctx.arrange = [this](const QString &type) { m_arrangements.append(type); };
+
+  // Counted from the board itself, so deletes and clears are reflected
+  ctx.getTaskCount = [this]() -> int { return m_tasks.size(); };
+
+  ctx.getPositionCounter = [this]() -> int & { return m_positionCounter; };
+
+  return ctx;
+}
+
+void HeadlessBoard::clear() {
+  m_tasks.clear();
+  m_connections.clear();
+  m_arrangements.clear();
+  m_nextId = 1;
+  m_positionCounter = 0;
+}
+
+void HeadlessBoard::seed(int count) {
+  for (int i = 0; i < count; ++i) {
+    int col = m_positionCounter % 3;
+    int row = m_positionCounter / 3;
+    m_positionCounter++;
+    m_tasks.append({m_nextId++, QString("Задача %1").arg(i + 1), QString(),
+                    "todo", 50 + col * 250, 50 + row * 180});
+  }
+}
+
+void HeadlessBoard::snapshot(QList<TaskSnapshot> *tasks,
+                             QList<QPair<int, int>> *connections) const {
+  tasks->clear();
+  connections->clear();
+  QHash<quint64, int> index;
+  index.reserve(m_tasks.size());
+  for (int i = 0; i < m_tasks.size(); ++i) {
+    index.insert(m_tasks[i].id, i);
+    tasks->append({m_tasks[i].title, m_tasks[i].description,
+                   m_tasks[i].status});
+  }
+  for (const auto &c : m_connections)
+    connections->append({index.value(c.first), index.value(c.second)});
+}
+
+quint64 HeadlessBoard::checksum() const {
+  quint64 h = FNV_OFFSET;
+  for (const auto &t : m_tasks) {
+    hashBytes(h, t.title.toUtf8());
+    hashBytes(h, t.description.toUtf8());
+    hashBytes(h, t.status.toUtf8());
+    hashInt(h, t.x);
+    hashInt(h, t.y);
+  }
+  // Connections by current index, which is what the user sees
+  QHash<quint64, int> index;
+  index.reserve(m_tasks.size());
+  for (int i = 0; i < m_tasks.size(); ++i)
+    index.insert(m_tasks[i].id, i);
+  for (const auto &c : m_connections) {
+    hashInt(h, index.value(c.first, -1));
+    hashInt(h, index.value(c.second, -1));
+  }
+  for (const auto &a : m_arrangements)
+    hashBytes(h, a.toUtf8());
+  return h;
+}
+
+quint64 HeadlessBoard::checksum(quint64 h, const QByteArray &bytes) {
+  hashBytes(h, bytes);
+  return h;
+}
+
+} // namespace DevPlanner
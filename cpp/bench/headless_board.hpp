@@ -0,0 +1,53 @@
+#ifndef HEADLESS_BOARD_HPP
+#define HEADLESS_BOARD_HPP
+
+#include "ai/ai_action.hpp"
+#include "ai/task_context.hpp"
+#include <QList>
+#include <QPair>
+#include <QStringList>
+
+namespace DevPlanner {
+
+// Widget-free stand-in for NodeCanvas: the same task list and connection
+// semantics (indices shift on delete, disconnect removes both directions),
+// without layout or painting.
+class HeadlessBoard {
+public:
+  struct Task {
+    quint64 id;
+    QString title;
+    QString description;
+    QString status;
+    int x;
+    int y;
+  };
+
+  ActionContext context();
+
+  void clear();
+  // Adds count placeholder tasks laid out like CreateTaskAction does
+  void seed(int count);
+
+  // The board as the chat panel is given it, connections by index
+  void snapshot(QList<TaskSnapshot> *tasks,
+                QList<QPair<int, int>> *connections) const;
+
+  int taskCount() const { return m_tasks.size(); }
+  int connectionCount() const { return m_connections.size(); }
+  // FNV-1a over tasks, connections and arrange requests, in board order
+  quint64 checksum() const;
+  // Continues an FNV-1a hash with more bytes
+  static quint64 checksum(quint64 h, const QByteArray &bytes);
+
+private:
+  QList<Task> m_tasks;
+  QList<QPair<quint64, quint64>> m_connections;
+  QStringList m_arrangements;
+  quint64 m_nextId = 1;
+  int m_positionCounter = 0;
+};
+
+} // namespace DevPlanner
+
+#endif
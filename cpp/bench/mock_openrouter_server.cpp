@@ -0,0 +1,320 @@
+#include "mock_openrouter_server.hpp"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QPointer>
+#include <QTimer>
+#include <memory>
+
+namespace DevPlanner {
+
+namespace {
+
+QByteArray reasonPhrase(int status) {
+  switch (status) {
+  case 200:
+    return "OK";
+  case 400:
+    return "Bad Request";
+  case 404:
+    return "Not Found";
+  case 429:
+    return "Too Many Requests";
+  case 502:
+    return "Bad Gateway";
+  case 503:
+    return "Service Unavailable";
+  default:
+    return status >= 500 ? "Internal Server Error" : "Error";
+  }
+}
+
+void writeChunk(QTcpSocket *socket, const QByteArray &data) {
+  socket->write(QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n");
+}
+
+QByteArray event(const QJsonObject &chunk) {
+  return "data: " + QJsonDocument(chunk).toJson(QJsonDocument::Compact) +
+         "\n\n";
+}
+
+QList<QJsonObject> mockActions(int count) {
+  QList<QJsonObject> actions;
+  const QStringList statuses = {"todo", "progress", "done"};
+  int created = 0;
+  for (int i = 0; i < count; ++i) {
+    if (created < 2 || i % 3 == 0) {
+      created++;
+      actions.append(
+          QJsonObject{{"action", "create_task"},
+                      {"title", QString("Задача %1").arg(created)},
+                      {"description", "Сгенерировано тестовым сервером"},
+                      {"status", statuses[i % statuses.size()]}});
+    } else if (i % 3 == 1) {
+      actions.append(QJsonObject{
+          {"action", "connect"}, {"from", created - 1}, {"to", created}});
+    } else {
+      actions.append(QJsonObject{{"action", "set_status"},
+                                 {"task", created},
+                                 {"status", statuses[i % statuses.size()]}});
+    }
+  }
+  return actions;
+}
+
+} // namespace
+
+MockOpenRouterServer::MockOpenRouterServer(const Config &config,
+                                           QObject *parent)
+    : QObject(parent), m_config(config), m_rng(config.seed) {
+  connect(&m_server, &QTcpServer::newConnection, this,
+          &MockOpenRouterServer::onNewConnection);
+}
+
+bool MockOpenRouterServer::listen(quint16 port) {
+  return m_server.listen(QHostAddress::LocalHost, port);
+}
+
+QString MockOpenRouterServer::baseUrl() const {
+  return QString("http://127.0.0.1:%1/api/v1").arg(port());
+}
+
+QJsonObject MockOpenRouterServer::toolCallReply(int actions) {
+  QJsonArray calls;
+  int i = 0;
+  for (QJsonObject args : mockActions(actions)) {
+    QString name = args.take("action").toString();
+    calls.append(QJsonObject{
+        {"id", QString("call_%1").arg(i++)},
+        {"type", "function"},
+        {"function",
+         QJsonObject{{"name", name},
+                     {"arguments", QString::fromUtf8(QJsonDocument(args).toJson(
+                                       QJsonDocument::Compact))}}}});
+  }
+  return {{"role", "assistant"}, {"content", ""}, {"tool_calls", calls}};
+}
+
+QJsonObject MockOpenRouterServer::inlineReply(int actions) {
+  QString content = "План:\n";
+  for (const auto &a : mockActions(actions))
+    content +=
+        QString::fromUtf8(QJsonDocument(a).toJson(QJsonDocument::Compact)) +
+        "\n";
+  return {{"role", "assistant"}, {"content", content}};
+}
+
+void MockOpenRouterServer::onNewConnection() {
+  while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+    m_connections.insert(socket, Connection());
+    connect(socket, &QTcpSocket::readyRead, this,
+            [this, socket]() { onReadyRead(socket); });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+      m_connections.remove(socket);
+      socket->deleteLater();
+    });
+  }
+}
+
+void MockOpenRouterServer::onReadyRead(QTcpSocket *socket) {
+  auto it = m_connections.find(socket);
+  if (it == m_connections.end())
+    return;
+  it->buffer += socket->readAll();
+  if (it->busy)
+    return;
+
+  int headerEnd = it->buffer.indexOf("\r\n\r\n");
+  if (headerEnd < 0)
+    return;
+  QList<QByteArray> lines = it->buffer.left(headerEnd).split('\n');
+  QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+  qsizetype contentLength = 0;
+  for (int i = 1; i < lines.size(); ++i) {
+    QByteArray line = lines[i].trimmed();
+    int colon = line.indexOf(':');
+    if (colon > 0 &&
+        line.left(colon).trimmed().toLower() == "content-length")
+      contentLength = line.mid(colon + 1).trimmed().toLongLong();
+  }
+  qsizetype total = headerEnd + 4 + contentLength;
+  if (it->buffer.size() < total)
+    return;
+
+  QByteArray body = it->buffer.mid(headerEnd + 4, contentLength);
+  it->buffer.remove(0, total);
+  it->busy = true;
+  handleRequest(socket, requestLine.value(0), requestLine.value(1), body);
+}
+
+void MockOpenRouterServer::handleRequest(QTcpSocket *socket,
+                                         const QByteArray &method,
+                                         const QByteArray &path,
+                                         const QByteArray &body) {
+  if (method == "GET" && path.endsWith("/models")) {
+    QJsonArray models;
+    models.append(QJsonObject{{"id", "mock/model"}});
+    respondJson(socket, 200, {{"data", models}});
+    return;
+  }
+  if (method != "POST" || !path.endsWith("/chat/completions")) {
+    respondJson(socket, 404,
+                {{"error", QJsonObject{{"message", "Not found"},
+                                       {"code", 404}}}});
+    return;
+  }
+
+  QJsonObject payload = QJsonDocument::fromJson(body).object();
+  m_requests++;
+  emit requestReceived(payload);
+
+  QPointer<QTcpSocket> guard(socket);
+  QTimer::singleShot(delayMs(), this, [this, guard, payload]() {
+    if (!guard)
+      return;
+    if (roll(m_config.errorRate)) {
+      int status = m_config.errorStatus;
+      respondJson(guard, status,
+                  {{"error", QJsonObject{{"message", "Mock upstream error"},
+                                         {"code", status}}}});
+      return;
+    }
+    QJsonObject message = nextReply(payload);
+    QString model = payload["model"].toString("mock/model");
+    if (payload["stream"].toBool()) {
+      respondStream(guard, message, model);
+      return;
+    }
+    QJsonObject choice{{"index", 0},
+                       {"message", message},
+                       {"finish_reason", message.contains("tool_calls")
+                                             ? "tool_calls"
+                                             : "stop"}};
+    respondJson(guard, 200,
+                {{"id", QString("gen-mock-%1").arg(m_requests)},
+                 {"object", "chat.completion"},
+                 {"created", QDateTime::currentSecsSinceEpoch()},
+                 {"model", model},
+                 {"choices", QJsonArray{choice}}});
+  });
+}
+
+void MockOpenRouterServer::respondJson(QTcpSocket *socket, int status,
+                                       const QJsonObject &body) {
+  QByteArray data = QJsonDocument(body).toJson(QJsonDocument::Compact);
+  socket->write("HTTP/1.1 " + QByteArray::number(status) + " " +
+                reasonPhrase(status) +
+                "\r\nContent-Type: application/json\r\nContent-Length: " +
+                QByteArray::number(data.size()) + "\r\n\r\n" + data);
+  auto it = m_connections.find(socket);
+  if (it != m_connections.end())
+    it->busy = false;
+  // A request may already be waiting in the buffer
+  QTimer::singleShot(0, socket, [this, socket]() { onReadyRead(socket); });
+}
+
+void MockOpenRouterServer::respondStream(QTcpSocket *socket,
+                                         const QJsonObject &message,
+                                         const QString &model) {
+  QJsonObject base{{"id", QString("gen-mock-%1").arg(m_requests)},
+                   {"object", "chat.completion.chunk"},
+                   {"created", QDateTime::currentSecsSinceEpoch()},
+                   {"model", model}};
+  auto chunk = [&base](const QJsonObject &delta,
+                       const QJsonValue &finish = QJsonValue()) {
+    QJsonObject c = base;
+    c["choices"] = QJsonArray{QJsonObject{
+        {"index", 0}, {"delta", delta}, {"finish_reason", finish}}};
+    return event(c);
+  };
+  const int step = qMax(1, m_config.chunkChars);
+
+  // OpenRouter sends keep-alive comments while the model warms up
+  QList<QByteArray> events{": OPENROUTER PROCESSING\n\n"};
+  events << chunk({{"role", "assistant"}, {"content", ""}});
+  QString content = message["content"].toString();
+  for (int i = 0; i < content.size(); i += step)
+    events << chunk({{"content", content.mid(i, step)}});
+
+  QJsonArray calls = message["tool_calls"].toArray();
+  for (int i = 0; i < calls.size(); ++i) {
+    QJsonObject call = calls[i].toObject();
+    QJsonObject function = call["function"].toObject();
+    QJsonObject head{{"index", i},
+                     {"id", call["id"]},
+                     {"type", "function"},
+                     {"function", QJsonObject{{"name", function["name"]},
+                                              {"arguments", ""}}}};
+    events << chunk({{"tool_calls", QJsonArray{head}}});
+    QString args = function["arguments"].toString();
+    for (int k = 0; k < args.size(); k += step) {
+      QJsonObject part{
+          {"index", i},
+          {"function", QJsonObject{{"arguments", args.mid(k, step)}}}};
+      events << chunk({{"tool_calls", QJsonArray{part}}});
+    }
+  }
+  events << chunk({}, calls.isEmpty() ? "stop" : "tool_calls");
+  events << "data: [DONE]\n\n";
+
+  socket->write("HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/event-stream\r\n"
+                "Cache-Control: no-cache\r\n"
+                "Transfer-Encoding: chunked\r\n\r\n");
+
+  int dropAt = roll(m_config.dropRate) ? events.size() / 2 : -1;
+  auto *timer = new QTimer(socket);
+  timer->setInterval(m_config.chunkIntervalMs);
+  QPointer<QTcpSocket> guard(socket);
+  auto next = std::make_shared<int>(0);
+  connect(timer, &QTimer::timeout, this,
+          [this, guard, timer, events, next, dropAt]() {
+            if (!guard)
+              return;
+            if (*next == dropAt) {
+              timer->stop();
+              guard->abort();
+              return;
+            }
+            writeChunk(guard, events[(*next)++]);
+            if (*next < events.size())
+              return;
+            timer->stop();
+            timer->deleteLater();
+            guard->write("0\r\n\r\n");
+            auto it = m_connections.find(guard);
+            if (it != m_connections.end())
+              it->busy = false;
+            onReadyRead(guard);
+          });
+  timer->start();
+}
+
+QJsonObject MockOpenRouterServer::nextReply(const QJsonObject &payload) {
+  if (!m_config.replies.isEmpty()) {
+    const QJsonArray &replies = m_config.replies;
+    QJsonValue reply = replies[m_nextReply++ % replies.size()];
+    if (reply.isObject())
+      return reply.toObject();
+    return {{"role", "assistant"}, {"content", reply.toString()}};
+  }
+  QJsonArray messages = payload["messages"].toArray();
+  QString last = messages.isEmpty()
+                     ? QString()
+                     : messages.last().toObject()["content"].toString();
+  return {{"role", "assistant"}, {"content", "echo: " + last.right(200)}};
+}
+
+int MockOpenRouterServer::delayMs() {
+  if (m_config.jitterMs <= 0)
+    return m_config.latencyMs;
+  std::uniform_int_distribution<int> jitter(0, m_config.jitterMs);
+  return m_config.latencyMs + jitter(m_rng);
+}
+
+bool MockOpenRouterServer::roll(double rate) {
+  if (rate <= 0)
+    return false;
+  return std::uniform_real_distribution<double>(0, 1)(m_rng) < rate;
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,81 @@
+#ifndef MOCK_OPENROUTER_SERVER_HPP
+#define MOCK_OPENROUTER_SERVER_HPP
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <random>
+
+namespace DevPlanner {
+
+// Local stand-in for OpenRouter's /v1/chat/completions. Answers with a
+// JSON body, or with SSE deltas when the request has "stream": true, after
+// a configurable delay. Meant for benchmarks and tests; single-threaded and
+// HTTP/1.1 only.
+class MockOpenRouterServer : public QObject {
+  Q_OBJECT
+
+public:
+  struct Config {
+    int latencyMs = 200;     // before the response headers
+    int jitterMs = 0;        // uniform extra delay in [0, jitterMs]
+    int chunkChars = 64;     // characters per SSE delta
+    int chunkIntervalMs = 5; // between SSE deltas
+    double errorRate = 0;    // share of requests answered with errorStatus
+    int errorStatus = 500;
+    double dropRate = 0; // share of streams cut off halfway
+    // Assistant messages ({"content", "tool_calls"} or plain strings),
+    // used in turn; without them the last user message is echoed
+    QJsonArray replies;
+    quint32 seed = 1;
+  };
+
+  explicit MockOpenRouterServer(const Config &config,
+                                QObject *parent = nullptr);
+
+  bool listen(quint16 port = 0);
+  quint16 port() const { return m_server.serverPort(); }
+  QString baseUrl() const;
+
+  int requestCount() const { return m_requests; }
+
+  // {"content": "", "tool_calls": [...]} with n create/connect/status calls
+  static QJsonObject toolCallReply(int actions);
+  // The same actions as inline JSON in the content, the way models without
+  // tool support answer
+  static QJsonObject inlineReply(int actions);
+
+signals:
+  void requestReceived(const QJsonObject &payload);
+
+private:
+  struct Connection {
+    QByteArray buffer;
+    bool busy = false; // a response is being written
+  };
+
+  void onNewConnection();
+  void onReadyRead(QTcpSocket *socket);
+  void handleRequest(QTcpSocket *socket, const QByteArray &method,
+                     const QByteArray &path, const QByteArray &body);
+  void respondJson(QTcpSocket *socket, int status, const QJsonObject &body);
+  void respondStream(QTcpSocket *socket, const QJsonObject &message,
+                     const QString &model);
+  QJsonObject nextReply(const QJsonObject &payload);
+  int delayMs();
+  bool roll(double rate);
+
+  Config m_config;
+  QTcpServer m_server;
+  QHash<QTcpSocket *, Connection> m_connections;
+  std::mt19937 m_rng;
+  int m_requests = 0;
+  int m_nextReply = 0;
+};
+
+} // namespace DevPlanner
+
+#endif
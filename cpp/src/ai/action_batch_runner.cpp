@@ -0,0 +1,53 @@
+#include "action_batch_runner.hpp"
+#include "ai_action.hpp"
+#include <QElapsedTimer>
+
+namespace DevPlanner {
+
+ActionBatchRunner::ActionBatchRunner(const QList<QJsonObject> &actions,
+                                     Executor executor, QObject *parent)
+    : QObject(parent), m_actions(actions), m_executor(std::move(executor)) {
+  // A zero timer fires after pending input and paint events are handled
+  m_timer.setInterval(0);
+  connect(&m_timer, &QTimer::timeout, this, &ActionBatchRunner::runSlice);
+}
+
+void ActionBatchRunner::start() {
+  if (m_finished || m_timer.isActive())
+    return;
+  m_results.reserve(m_actions.size());
+  m_timer.start();
+}
+
+void ActionBatchRunner::cancel() {
+  if (m_finished)
+    return;
+  m_cancelled = true;
+  finish();
+}
+
+void ActionBatchRunner::runSlice() {
+  QElapsedTimer slice;
+  slice.start();
+  while (m_next < m_actions.size() && slice.elapsed() < SLICE_MS) {
+    QString result = m_executor(m_actions[m_next++]);
+    if (isActionFailure(result)) {
+      m_failure = result;
+      break;
+    }
+    m_results.append(result);
+  }
+  m_elapsed += slice.elapsed();
+
+  emit progress(m_next, m_actions.size());
+  if (!m_failure.isEmpty() || m_next >= m_actions.size())
+    finish();
+}
+
+void ActionBatchRunner::finish() {
+  m_timer.stop();
+  m_finished = true;
+  emit finished();
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,60 @@
+#ifndef ACTION_BATCH_RUNNER_HPP
+#define ACTION_BATCH_RUNNER_HPP
+
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <functional>
+
+namespace DevPlanner {
+
+// Executes a long action list in time slices so the event loop keeps
+// handling input and paints between them. Stops at the first failed action
+// ("⚠ ..."); the caller owns the surrounding transaction.
+class ActionBatchRunner : public QObject {
+  Q_OBJECT
+
+public:
+  using Executor = std::function<QString(const QJsonObject &)>;
+
+  ActionBatchRunner(const QList<QJsonObject> &actions, Executor executor,
+                    QObject *parent = nullptr);
+
+  void start();
+  // Stops before the next action; finished() is emitted synchronously
+  void cancel();
+
+  int done() const { return m_next; }
+  int total() const { return m_actions.size(); }
+  bool isFinished() const { return m_finished; }
+  bool isCancelled() const { return m_cancelled; }
+  QString failure() const { return m_failure; }
+  QStringList results() const { return m_results; }
+  qint64 elapsedMs() const { return m_elapsed; }
+
+  static constexpr int SLICE_MS = 8;
+
+signals:
+  void progress(int done, int total);
+  void finished();
+
+private:
+  void runSlice();
+  void finish();
+
+  QList<QJsonObject> m_actions;
+  Executor m_executor;
+  QStringList m_results;
+  QString m_failure;
+  QTimer m_timer;
+  int m_next = 0;
+  qint64 m_elapsed = 0;
+  bool m_cancelled = false;
+  bool m_finished = false;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -8,6 +8,20 @@ namespace DevPlanner {
 class ArrangeAction : public AIAction {
 public:
   QString name() const override { return "arrange"; }
+  QString description() const override {
+    return "Расставляет задачи на холсте";
+  }
+
+  QJsonObject parameters() const override {
+    return Schema::object(
+        {{"type", Schema::oneOf(
+                     {"tree", "grid", "horizontal", "vertical", "force",
+                      "pack"},
+                     "Способ расстановки; force — свободная силовая "
+                     "раскладка, pack — плотная упаковка заметок по "
+                     "статусам")}},
+        {"type"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     QString type = data["type"].toString("grid");
@@ -22,6 +36,10 @@ public:
       typeName = "горизонтально";
     else if (type == "vertical")
       typeName = "вертикально";
+    else if (type == "force")
+      typeName = "свободно";
+    else if (type == "pack")
+      typeName = "плотно по статусам";
     else
       typeName = type;
 
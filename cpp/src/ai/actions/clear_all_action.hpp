@@ -8,6 +8,13 @@ namespace DevPlanner {
 class ClearAllAction : public AIAction {
 public:
   QString name() const override { return "clear_all"; }
+  QString description() const override {
+    return "Удаляет все задачи и очищает холст";
+  }
+
+  QJsonObject parameters() const override {
+    return Schema::object({});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     Q_UNUSED(data);
@@ -8,6 +8,15 @@ namespace DevPlanner {
 class ConnectAction : public AIAction {
 public:
   QString name() const override { return "connect"; }
+  QString description() const override {
+    return "Соединяет две задачи стрелкой (from → to)";
+  }
+
+  QJsonObject parameters() const override {
+    return Schema::object({{"from", Schema::taskNumber()},
+                           {"to", Schema::taskNumber()}},
+                          {"from", "to"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     int from = data["from"].toInt() - 1;
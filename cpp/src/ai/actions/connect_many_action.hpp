@@ -9,6 +9,17 @@ namespace DevPlanner {
 class ConnectManyAction : public AIAction {
 public:
   QString name() const override { return "connect_many"; }
+  QString description() const override {
+    return "Создаёт несколько соединений за раз";
+  }
+
+  QJsonObject parameters() const override {
+    return Schema::object(
+        {{"connections",
+          Schema::arrayOf(Schema::arrayOf(Schema::taskNumber(), "[from, to]"),
+                          "Пары номеров задач")}},
+        {"connections"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     QJsonArray connections = data["connections"].toArray();
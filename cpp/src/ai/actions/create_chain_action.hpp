@@ -9,6 +9,21 @@ namespace DevPlanner {
 class CreateChainAction : public AIAction {
 public:
   QString name() const override { return "create_tasks_chain"; }
+  QString description() const override {
+    return "Создаёт цепочку задач, по умолчанию соединённых по порядку";
+  }
+
+  QJsonObject parameters() const override {
+    QJsonObject task = Schema::object({{"title", Schema::string("Название")},
+                                       {"description",
+                                        Schema::string("Описание")},
+                                       {"status", Schema::status()}},
+                                      {"title"});
+    return Schema::object(
+        {{"tasks", Schema::arrayOf(task, "Задачи по порядку")},
+         {"connect", Schema::boolean("Соединять задачи (по умолч. true)")}},
+        {"tasks"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     QJsonArray tasks = data["tasks"].toArray();
@@ -19,21 +34,16 @@ public:
     }
 
     int startIdx = ctx.getTaskCount();
-    int &counter = ctx.getPositionCounter();
 
-    for (const auto &taskVal : tasks) {
-      QJsonObject task = taskVal.toObject();
+    for (int i = 0; i < tasks.size(); ++i) {
+      QJsonObject task = tasks[i].toObject();
       QString title = task["title"].toString("Задача");
       QString desc = task["description"].toString();
       QString status = task["status"].toString("todo");
 
-      int col = counter % 3;
-      int row = counter / 3;
-      int x = 50 + col * 250;
-      int y = 50 + row * 180;
-      counter++;
-
-      ctx.createTask(title, desc, status, x, y);
+      // Each link goes next to its predecessor
+      QPoint pos = nextTaskPosition(ctx, i == 0 ? -1 : startIdx + i - 1);
+      ctx.createTask(title, desc, status, pos.x(), pos.y());
     }
 
     if (doConnect && tasks.size() > 1) {
@@ -8,20 +8,24 @@ namespace DevPlanner {
 class CreateTaskAction : public AIAction {
 public:
   QString name() const override { return "create_task"; }
+  QString description() const override {
+    return "Создаёт новую задачу на холсте";
+  }
+
+  QJsonObject parameters() const override {
+    return Schema::object({{"title", Schema::string("Название задачи")},
+                           {"description", Schema::string("Описание задачи")},
+                           {"status", Schema::status()}},
+                          {"title"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     QString title = data["title"].toString("Новая задача");
     QString desc = data["description"].toString();
     QString status = data["status"].toString("todo");
 
-    int &counter = ctx.getPositionCounter();
-    int col = counter % 3;
-    int row = counter / 3;
-    int x = 50 + col * 250;
-    int y = 50 + row * 180;
-    counter++;
-
-    ctx.createTask(title, desc, status, x, y);
+    QPoint pos = nextTaskPosition(ctx);
+    ctx.createTask(title, desc, status, pos.x(), pos.y());
     return QString("✓ %1").arg(title);
   }
 };
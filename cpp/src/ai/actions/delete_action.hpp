@@ -8,6 +8,11 @@ namespace DevPlanner {
 class DeleteAction : public AIAction {
 public:
   QString name() const override { return "delete"; }
+  QString description() const override { return "Удаляет задачу"; }
+
+  QJsonObject parameters() const override {
+    return Schema::object({{"task", Schema::taskNumber()}}, {"task"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     int taskIdx = data["task"].toInt() - 1;
@@ -11,6 +11,13 @@ namespace DevPlanner {
 class DeleteManyAction : public AIAction {
 public:
   QString name() const override { return "delete_many"; }
+  QString description() const override { return "Удаляет несколько задач"; }
+
+  QJsonObject parameters() const override {
+    return Schema::object(
+        {{"tasks", Schema::arrayOf(Schema::taskNumber(), "Номера задач")}},
+        {"tasks"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     QJsonArray tasks = data["tasks"].toArray();
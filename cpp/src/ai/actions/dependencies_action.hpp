@@ -0,0 +1,82 @@
+#ifndef DEPENDENCIES_ACTION_HPP
+#define DEPENDENCIES_ACTION_HPP
+
+#include "../ai_action.hpp"
+#include <QStringList>
+
+namespace DevPlanner {
+
+// Read-only: answers "what does this task block?" and "what must finish
+// before it?" over all transitive dependencies
+class DependenciesAction : public AIAction {
+public:
+  // Numbers listed per direction before the rest is only counted
+  static constexpr int MAX_LISTED = 50;
+
+  QString name() const override { return "dependencies"; }
+  QString description() const override {
+    return "Показывает все задачи, которые задача блокирует (downstream), "
+           "и все, что должны завершиться до неё (upstream), с учётом "
+           "транзитивных связей";
+  }
+
+  QJsonObject parameters() const override {
+    return Schema::object(
+        {{"task", Schema::taskNumber()},
+         {"direction",
+          Schema::oneOf({"upstream", "downstream", "both"},
+                        "upstream — что должно быть сделано раньше, "
+                        "downstream — что ждёт эту задачу")}},
+        {"task"});
+  }
+
+  QString execute(const QJsonObject &data, ActionContext &ctx) override {
+    int taskIdx = data["task"].toInt() - 1;
+    QString direction = data["direction"].toString("both");
+
+    if (taskIdx < 0) {
+      return "⚠ Неверный номер задачи";
+    }
+
+    if (taskIdx >= ctx.getTaskCount()) {
+      return QString("⚠ Задача %1 не существует").arg(taskIdx + 1);
+    }
+
+    if (!ctx.reachableTasks) {
+      return "⚠ Зависимости недоступны";
+    }
+
+    auto list = [](const QList<int> &tasks) {
+      if (tasks.isEmpty())
+        return QString("нет");
+      QStringList numbers;
+      for (int i = 0; i < tasks.size() && i < MAX_LISTED; ++i)
+        numbers.append(QString::number(tasks[i] + 1));
+      QString out = numbers.join(", ");
+      if (tasks.size() > MAX_LISTED)
+        out += QString(" и ещё %1").arg(tasks.size() - MAX_LISTED);
+      return out;
+    };
+
+    QStringList lines;
+    if (direction != "downstream") {
+      QList<int> before = ctx.reachableTasks(taskIdx, false);
+      lines.append(QString("До задачи %1 должны быть сделаны (%2): %3")
+                       .arg(taskIdx + 1)
+                       .arg(before.size())
+                       .arg(list(before)));
+    }
+    if (direction != "upstream") {
+      QList<int> after = ctx.reachableTasks(taskIdx, true);
+      lines.append(QString("Задача %1 блокирует (%2): %3")
+                       .arg(taskIdx + 1)
+                       .arg(after.size())
+                       .arg(list(after)));
+    }
+    return lines.join("\n");
+  }
+};
+
+} // namespace DevPlanner
+
+#endif
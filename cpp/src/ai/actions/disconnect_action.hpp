@@ -8,6 +8,15 @@ namespace DevPlanner {
 class DisconnectAction : public AIAction {
 public:
   QString name() const override { return "disconnect"; }
+  QString description() const override {
+    return "Удаляет соединение между двумя задачами";
+  }
+
+  QJsonObject parameters() const override {
+    return Schema::object({{"from", Schema::taskNumber()},
+                           {"to", Schema::taskNumber()}},
+                          {"from", "to"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     int from = data["from"].toInt() - 1;
@@ -8,6 +8,13 @@ namespace DevPlanner {
 class RenameAction : public AIAction {
 public:
   QString name() const override { return "rename"; }
+  QString description() const override { return "Переименовывает задачу"; }
+
+  QJsonObject parameters() const override {
+    return Schema::object({{"task", Schema::taskNumber()},
+                           {"title", Schema::string("Новое название")}},
+                          {"task", "title"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     int taskIdx = data["task"].toInt() - 1;
@@ -8,6 +8,14 @@ namespace DevPlanner {
 class SetDescriptionAction : public AIAction {
 public:
   QString name() const override { return "set_description"; }
+  QString description() const override { return "Меняет описание задачи"; }
+
+  QJsonObject parameters() const override {
+    return Schema::object(
+        {{"task", Schema::taskNumber()},
+         {"description", Schema::string("Новое описание")}},
+        {"task", "description"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     int taskIdx = data["task"].toInt() - 1;
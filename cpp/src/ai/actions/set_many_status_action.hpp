@@ -9,6 +9,16 @@ namespace DevPlanner {
 class SetManyStatusAction : public AIAction {
 public:
   QString name() const override { return "set_many_status"; }
+  QString description() const override {
+    return "Меняет статус нескольких задач";
+  }
+
+  QJsonObject parameters() const override {
+    return Schema::object(
+        {{"tasks", Schema::arrayOf(Schema::taskNumber(), "Номера задач")},
+         {"status", Schema::status()}},
+        {"tasks", "status"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     QJsonArray tasks = data["tasks"].toArray();
@@ -40,6 +50,10 @@ public:
       statusName = "в работе 🟡";
     else if (status == "todo")
       statusName = "к выполнению 🔴";
+    else if (status == "ready")
+      statusName = "можно начинать 🔵";
+    else if (status == "blocked")
+      statusName = "заблокировано 🟠";
     else
       statusName = status;
 
@@ -8,6 +8,13 @@ namespace DevPlanner {
 class SetStatusAction : public AIAction {
 public:
   QString name() const override { return "set_status"; }
+  QString description() const override { return "Меняет статус задачи"; }
+
+  QJsonObject parameters() const override {
+    return Schema::object(
+        {{"task", Schema::taskNumber()}, {"status", Schema::status()}},
+        {"task", "status"});
+  }
 
   QString execute(const QJsonObject &data, ActionContext &ctx) override {
     int taskIdx = data["task"].toInt() - 1;
@@ -34,6 +41,10 @@ public:
       statusName = "в работе 🟡";
     else if (status == "todo")
       statusName = "к выполнению 🔴";
+    else if (status == "ready")
+      statusName = "можно начинать 🔵";
+    else if (status == "blocked")
+      statusName = "заблокировано 🟠";
     else
       statusName = status;
 
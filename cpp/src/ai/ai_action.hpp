@@ -1,8 +1,13 @@
 #ifndef AI_ACTION_HPP
 #define AI_ACTION_HPP
 
+#include "../core/config.hpp"
+#include <QJsonArray>
 #include <QJsonObject>
+#include <QList>
+#include <QPoint>
 #include <QString>
+#include <QStringList>
 #include <functional>
 
 namespace DevPlanner {
@@ -19,14 +24,84 @@ struct ActionContext {
   std::function<void(int)> deleteTask;
   std::function<void()> clearAll;
   std::function<void(const QString &)> arrange;
+  // Tasks on the board, including those created by earlier actions
   std::function<int()> getTaskCount;
+  // Next cell of the fixed grid; not a task count, placeTask leaves it be
   std::function<int &()> getPositionCounter;
+  // Top-left corner of a free spot for a new task, next to task nearTask
+  // (0-based) or around the view centre for -1. Optional.
+  std::function<QPoint(int nearTask)> placeTask;
+  // Tasks (0-based, ascending) that task transitively blocks when
+  // downstream, or that must finish before it otherwise. Optional.
+  std::function<QList<int>(int task, bool downstream)> reachableTasks;
 };
 
+// Where the next created task goes: the board's placement service, or the
+// three-column grid driven by the position counter when there is none
+inline QPoint nextTaskPosition(ActionContext &ctx, int nearTask = -1) {
+  if (ctx.placeTask)
+    return ctx.placeTask(nearTask);
+  int &counter = ctx.getPositionCounter();
+  QPoint p(50 + (counter % 3) * 250, 50 + (counter / 3) * 180);
+  counter++;
+  return p;
+}
+
+// Actions report invalid input with a "⚠ ..." result
+inline bool isActionFailure(const QString &result) {
+  return result.startsWith("⚠");
+}
+
+// JSON Schema helpers for tool definitions
+namespace Schema {
+
+inline QJsonObject integer(const QString &description) {
+  return QJsonObject{{"type", "integer"}, {"description", description}};
+}
+
+inline QJsonObject string(const QString &description) {
+  return QJsonObject{{"type", "string"}, {"description", description}};
+}
+
+inline QJsonObject boolean(const QString &description) {
+  return QJsonObject{{"type", "boolean"}, {"description", description}};
+}
+
+inline QJsonObject oneOf(const QStringList &values,
+                         const QString &description) {
+  return QJsonObject{{"type", "string"},
+                     {"enum", QJsonArray::fromStringList(values)},
+                     {"description", description}};
+}
+
+inline QJsonObject arrayOf(const QJsonObject &items,
+                           const QString &description) {
+  return QJsonObject{
+      {"type", "array"}, {"items", items}, {"description", description}};
+}
+
+inline QJsonObject object(const QJsonObject &properties,
+                          const QStringList &required = {}) {
+  return QJsonObject{{"type", "object"},
+                     {"properties", properties},
+                     {"required", QJsonArray::fromStringList(required)}};
+}
+
+inline QJsonObject status() {
+  return oneOf(getStatuses().keys(), "Статус задачи");
+}
+
+inline QJsonObject taskNumber() { return integer("Номер задачи (с 1)"); }
+
+} // namespace Schema
+
 class AIAction {
 public:
   virtual ~AIAction() = default;
   virtual QString name() const = 0;
+  virtual QString description() const = 0;
+  // JSON Schema of the arguments, used for the tools protocol
+  virtual QJsonObject parameters() const = 0;
   virtual QString execute(const QJsonObject &data, ActionContext &ctx) = 0;
 };
 
@@ -5,6 +5,7 @@
 #include "actions/connect_many_action.hpp"
 #include "actions/create_chain_action.hpp"
 #include "actions/create_task_action.hpp"
+#include "actions/dependencies_action.hpp"
 #include "actions/delete_action.hpp"
 #include "actions/delete_many_action.hpp"
 #include "actions/disconnect_action.hpp"
@@ -12,6 +13,8 @@
 #include "actions/set_description_action.hpp"
 #include "actions/set_many_status_action.hpp"
 #include "actions/set_status_action.hpp"
+#include <algorithm>
+#include <vector>
 
 namespace DevPlanner {
 
@@ -49,6 +52,112 @@ bool AIActionRegistry::hasAction(const QString &name) const {
   return m_actions.count(name.toStdString()) > 0 || name.startsWith("arrange_");
 }
 
+namespace {
+
+bool matchesType(const QJsonValue &value, const QJsonObject &schema) {
+  QString type = schema["type"].toString();
+  if (type == "integer")
+    return value.isDouble() && value.toDouble() == value.toInt();
+  if (type == "string") {
+    if (!value.isString())
+      return false;
+    QJsonArray allowed = schema["enum"].toArray();
+    return allowed.isEmpty() || allowed.contains(value);
+  }
+  if (type == "boolean")
+    return value.isBool();
+  if (type == "array") {
+    if (!value.isArray())
+      return false;
+    QJsonObject items = schema["items"].toObject();
+    for (const auto &item : value.toArray()) {
+      if (!matchesType(item, items))
+        return false;
+    }
+    return true;
+  }
+  if (type == "object") {
+    if (!value.isObject())
+      return false;
+    QJsonObject obj = value.toObject();
+    for (const auto &req : schema["required"].toArray()) {
+      if (!obj.contains(req.toString()))
+        return false;
+    }
+    QJsonObject properties = schema["properties"].toObject();
+    for (auto prop = properties.begin(); prop != properties.end(); ++prop) {
+      if (obj.contains(prop.key()) &&
+          !matchesType(obj[prop.key()], prop.value().toObject()))
+        return false;
+    }
+    return true;
+  }
+  return true;
+}
+
+} // namespace
+
+bool AIActionRegistry::validate(const QJsonObject &data,
+                                QString *error) const {
+  QString name = data["action"].toString();
+  auto it = m_actions.find(name.toStdString());
+  if (it == m_actions.end() && name.startsWith("arrange_"))
+    it = m_actions.find("arrange");
+  if (it == m_actions.end()) {
+    if (error)
+      *error = QString("неизвестное действие: %1").arg(name);
+    return false;
+  }
+
+  QJsonObject schema = it->second->parameters();
+  QJsonObject properties = schema["properties"].toObject();
+  for (const auto &req : schema["required"].toArray()) {
+    QString key = req.toString();
+    // arrange_<type> carries the type in its name
+    if (key == "type" && name.startsWith("arrange_"))
+      continue;
+    if (!data.contains(key)) {
+      if (error)
+        *error = QString("%1: нет поля %2").arg(name, key);
+      return false;
+    }
+  }
+  for (auto prop = properties.begin(); prop != properties.end(); ++prop) {
+    if (data.contains(prop.key()) &&
+        !matchesType(data[prop.key()], prop.value().toObject())) {
+      if (error)
+        *error = QString("%1: неверное поле %2").arg(name, prop.key());
+      return false;
+    }
+  }
+  return true;
+}
+
+QJsonArray AIActionRegistry::toolSchemas() const {
+  // Sorted so the request body (and its cache key) is stable
+  std::vector<const AIAction *> actions;
+  actions.reserve(m_actions.size());
+  for (const auto &pair : m_actions)
+    actions.push_back(pair.second.get());
+  std::sort(actions.begin(), actions.end(),
+            [](const AIAction *a, const AIAction *b) {
+              return a->name() < b->name();
+            });
+
+  QJsonArray tools;
+  for (const auto *action : actions) {
+    QJsonObject function;
+    function["name"] = action->name();
+    function["description"] = action->description();
+    function["parameters"] = action->parameters();
+    QJsonObject tool;
+    tool["type"] = "function";
+    tool["function"] = function;
+    tools.append(tool);
+  }
+  return tools;
+}
+
 void registerAllActions() {
   auto &reg = AIActionRegistry::instance();
   reg.registerAction(std::make_unique<CreateTaskAction>());
@@ -64,6 +173,7 @@ void registerAllActions() {
   reg.registerAction(std::make_unique<DeleteManyAction>());
   reg.registerAction(std::make_unique<ClearAllAction>());
   reg.registerAction(std::make_unique<ArrangeAction>());
+  reg.registerAction(std::make_unique<DependenciesAction>());
 }
 
 } // namespace DevPlanner
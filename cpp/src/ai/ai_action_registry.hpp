@@ -2,6 +2,7 @@
 #define AI_ACTION_REGISTRY_HPP
 
 #include "ai_action.hpp"
+#include <QJsonArray>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -16,6 +17,11 @@ public:
   QString execute(const QString &actionName, const QJsonObject &data,
                   ActionContext &ctx);
   bool hasAction(const QString &name) const;
+  // Checks the action name and its arguments against parameters() without
+  // executing anything
+  bool validate(const QJsonObject &data, QString *error = nullptr) const;
+  // OpenAI-compatible "tools" array built from the registered actions
+  QJsonArray toolSchemas() const;
 
 private:
   AIActionRegistry() = default;
@@ -0,0 +1,78 @@
+#include "ai_response_parser.hpp"
+#include <QJsonDocument>
+
+namespace DevPlanner {
+
+QList<QJsonObject> AIResponseParser::extractAllJson(const QString &text) {
+  QList<QJsonObject> res;
+  for (int i = 0; i < text.length(); ++i) {
+    if (text[i] == '{') {
+      int d = 0, s = i;
+      for (int j = i; j < text.length(); ++j) {
+        if (text[j] == '{')
+          d++;
+        else if (text[j] == '}') {
+          d--;
+          if (d == 0) {
+            auto doc = QJsonDocument::fromJson(text.mid(s, j - s + 1).toUtf8());
+            if (doc.isObject())
+              res.append(doc.object());
+            i = j;
+            break;
+          }
+        }
+      }
+    }
+  }
+  return res;
+}
+
+QList<QJsonObject> AIResponseParser::inlineActions(const QString &content) {
+  QList<QJsonObject> actions;
+  for (const auto &obj : extractAllJson(content)) {
+    if (obj.contains("actions")) {
+      for (const auto &a : obj["actions"].toArray())
+        actions.append(a.toObject());
+    } else {
+      actions.append(obj);
+    }
+  }
+  return actions;
+}
+
+QList<QJsonObject>
+AIResponseParser::toolCallActions(const QJsonArray &toolCalls, bool *ok) {
+  if (ok)
+    *ok = true;
+  QList<QJsonObject> actions;
+  for (const auto &callVal : toolCalls) {
+    QJsonObject function = callVal.toObject()["function"].toObject();
+    QJsonDocument args =
+        QJsonDocument::fromJson(function["arguments"].toString().toUtf8());
+    if (!args.isObject() && ok)
+      *ok = false;
+    QJsonObject action = args.object();
+    action["action"] = function["name"].toString();
+    actions.append(action);
+  }
+  return actions;
+}
+
+QString AIResponseParser::cleanJsonFromText(const QString &text) {
+  QString result;
+  int depth = 0;
+  for (int i = 0; i < text.length(); ++i) {
+    QChar c = text[i];
+    if (c == '{') {
+      depth++;
+    } else if (c == '}') {
+      depth--;
+    } else if (depth == 0) {
+      result += c;
+    }
+  }
+  result = result.simplified();
+  return result.isEmpty() ? "" : result;
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,29 @@
+#ifndef AI_RESPONSE_PARSER_HPP
+#define AI_RESPONSE_PARSER_HPP
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+namespace DevPlanner {
+
+// Turns a model reply into action objects for AIActionRegistry. Kept free
+// of widgets so the replay benchmark runs the same code as the chat panel.
+class AIResponseParser {
+public:
+  // Every top-level {...} in the text that parses as a JSON object
+  static QList<QJsonObject> extractAllJson(const QString &text);
+  // Inline JSON actions, with {"actions": [...]} wrappers flattened
+  static QList<QJsonObject> inlineActions(const QString &content);
+  // Arguments of each tool call with "action" set to the function name;
+  // ok is false if some arguments are not a JSON object
+  static QList<QJsonObject> toolCallActions(const QJsonArray &toolCalls,
+                                            bool *ok = nullptr);
+  // Reply text with the JSON parts removed
+  static QString cleanJsonFromText(const QString &text);
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,301 @@
+#include "bpe_tokenizer.hpp"
+#include <QByteArray>
+#include <QChar>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <array>
+#include <climits>
+
+namespace DevPlanner {
+
+namespace {
+
+enum CharClass : unsigned char { Other, Letter, Digit, Space, Newline };
+
+constexpr std::array<unsigned char, 128> makeAsciiClasses() {
+  std::array<unsigned char, 128> table{};
+  for (int c = 0; c < 128; ++c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+      table[c] = Letter;
+    else if (c >= '0' && c <= '9')
+      table[c] = Digit;
+    else if (c == '\r' || c == '\n')
+      table[c] = Newline;
+    else if (c == ' ' || c == '\t' || c == '\v' || c == '\f')
+      table[c] = Space;
+    else
+      table[c] = Other;
+  }
+  return table;
+}
+
+constexpr std::array<unsigned char, 128> ASCII_CLASSES = makeAsciiClasses();
+
+// Class of the character starting at i; len receives its UTF-8 length.
+// ASCII is a table lookup, everything else is decoded once.
+inline CharClass classAt(std::string_view s, size_t i, int *len) {
+  auto b = static_cast<unsigned char>(s[i]);
+  if (b < 0x80) {
+    *len = 1;
+    return static_cast<CharClass>(ASCII_CLASSES[b]);
+  }
+
+  int n = b >= 0xF0 ? 4 : b >= 0xE0 ? 3 : b >= 0xC0 ? 2 : 1;
+  if (i + n > s.size())
+    n = 1;
+  char32_t cp = n == 1 ? 0xFFFD : (b & (0xFF >> (n + 1)));
+  for (int k = 1; k < n; ++k)
+    cp = (cp << 6) | (static_cast<unsigned char>(s[i + k]) & 0x3F);
+  *len = n;
+
+  if (QChar::isLetter(cp))
+    return Letter;
+  if (QChar::isNumber(cp))
+    return Digit;
+  if (QChar::isSpace(cp))
+    return Space;
+  return Other;
+}
+
+inline CharClass classAt(std::string_view s, size_t i) {
+  int len;
+  return classAt(s, i, &len);
+}
+
+// 's 't 'm 'd 're 've 'll, case-insensitive
+size_t contractionLength(std::string_view s, size_t i) {
+  auto lower = [&s](size_t j) {
+    return j < s.size() ? char(s[j] | 0x20) : '\0';
+  };
+  char a = lower(i + 1);
+  char b = lower(i + 2);
+  if ((a == 'r' && b == 'e') || (a == 'v' && b == 'e') ||
+      (a == 'l' && b == 'l'))
+    return 3;
+  if (a == 's' || a == 't' || a == 'm' || a == 'd')
+    return 2;
+  return 0;
+}
+
+} // namespace
+
+bool BpeTokenizer::load(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  struct Entry {
+    size_t offset;
+    size_t length;
+    int rank;
+  };
+  std::vector<Entry> entries;
+  std::string arena;
+  while (!file.atEnd()) {
+    QByteArray line = file.readLine().trimmed();
+    int space = line.indexOf(' ');
+    if (space <= 0)
+      continue;
+    QByteArray bytes = QByteArray::fromBase64(line.left(space));
+    bool ok;
+    int rank = line.mid(space + 1).toInt(&ok);
+    if (!ok || bytes.isEmpty())
+      continue;
+    entries.push_back({arena.size(), size_t(bytes.size()), rank});
+    arena.append(bytes.constData(), bytes.size());
+  }
+  if (entries.empty())
+    return false;
+
+  // Views are taken only once the arena stops growing
+  m_arena = std::move(arena);
+  m_ranks.clear();
+  m_ranks.reserve(entries.size());
+  for (const auto &e : entries)
+    m_ranks.emplace(std::string_view(m_arena).substr(e.offset, e.length),
+                    e.rank);
+  m_pieceCache.clear();
+  m_cacheKeys.clear();
+  m_name = QFileInfo(path).completeBaseName();
+  return true;
+}
+
+std::vector<std::string_view>
+BpeTokenizer::pretokenize(std::string_view text) {
+  std::vector<std::string_view> pieces;
+  pieces.reserve(text.size() / 4 + 1);
+  const size_t n = text.size();
+  size_t i = 0;
+  while (i < n) {
+    int len;
+    CharClass c = classAt(text, i, &len);
+    size_t j = i;
+
+    if (text[i] == '\'') {
+      size_t contraction = contractionLength(text, i);
+      if (contraction > 0) {
+        pieces.push_back(text.substr(i, contraction));
+        i += contraction;
+        continue;
+      }
+    }
+
+    // [^\r\n\p{L}\p{N}]?\p{L}+
+    if (c == Letter ||
+        ((c == Other || c == Space) && i + len < n &&
+         classAt(text, i + len) == Letter)) {
+      j = c == Letter ? i : i + len;
+      int l;
+      while (j < n && classAt(text, j, &l) == Letter)
+        j += l;
+    } else if (c == Digit) {
+      // \p{N}{1,3}
+      int l;
+      for (int k = 0; k < 3 && j < n && classAt(text, j, &l) == Digit; ++k)
+        j += l;
+    } else if (c == Other || (text[i] == ' ' && i + 1 < n &&
+                              classAt(text, i + 1) == Other)) {
+      // ' ?[^\s\p{L}\p{N}]+[\r\n]*'
+      j = c == Other ? i : i + 1;
+      int l;
+      while (j < n && classAt(text, j, &l) == Other)
+        j += l;
+      while (j < n && (text[j] == '\r' || text[j] == '\n'))
+        j++;
+    } else {
+      // Whitespace run: \s*[\r\n]+ | \s+(?!\S) | \s+
+      size_t afterNewline = 0;
+      int l = 1;
+      int lastLen = 1;
+      while (j < n) {
+        CharClass cc = classAt(text, j, &l);
+        if (cc != Space && cc != Newline)
+          break;
+        j += l;
+        lastLen = l;
+        if (cc == Newline)
+          afterNewline = j;
+      }
+      if (afterNewline > 0) {
+        j = afterNewline;
+      } else if (j < n && j - i > size_t(lastLen)) {
+        // Leave one space to prefix the next word
+        j -= lastLen;
+      }
+    }
+
+    if (j == i)
+      j = i + len;
+    pieces.push_back(text.substr(i, j - i));
+    i = j;
+  }
+  return pieces;
+}
+
+int BpeTokenizer::rankOf(std::string_view bytes) const {
+  auto it = m_ranks.find(bytes);
+  return it == m_ranks.end() ? INT_MAX : it->second;
+}
+
+int BpeTokenizer::mergeCount(std::string_view piece) const {
+  if (piece.size() <= 1 || rankOf(piece) != INT_MAX)
+    return 1;
+  if (piece.size() > MAX_PIECE) {
+    int total = 0;
+    for (size_t at = 0; at < piece.size(); at += MAX_PIECE)
+      total += mergeCount(piece.substr(at, MAX_PIECE));
+    return total;
+  }
+
+  // tiktoken's byte_pair_merge: parts[i] holds the start of a part and the
+  // rank of merging it with the next one
+  std::vector<std::pair<size_t, int>> parts;
+  parts.reserve(piece.size() + 1);
+  for (size_t i = 0; i + 1 < piece.size(); ++i)
+    parts.emplace_back(i, rankOf(piece.substr(i, 2)));
+  parts.emplace_back(piece.size() - 1, INT_MAX);
+  parts.emplace_back(piece.size(), INT_MAX);
+
+  auto rankAt = [&](size_t i) {
+    if (i + 3 >= parts.size())
+      return INT_MAX;
+    size_t from = parts[i].first;
+    return rankOf(piece.substr(from, parts[i + 3].first - from));
+  };
+
+  while (parts.size() > 2) {
+    size_t best = 0;
+    int bestRank = INT_MAX;
+    for (size_t i = 0; i + 1 < parts.size(); ++i) {
+      if (parts[i].second < bestRank) {
+        bestRank = parts[i].second;
+        best = i;
+      }
+    }
+    if (bestRank == INT_MAX)
+      break;
+    if (best > 0)
+      parts[best - 1].second = rankAt(best - 1);
+    parts[best].second = rankAt(best);
+    parts.erase(parts.begin() + best + 1);
+  }
+  return static_cast<int>(parts.size()) - 1;
+}
+
+int BpeTokenizer::countPiece(std::string_view piece) const {
+  auto it = m_pieceCache.find(piece);
+  if (it != m_pieceCache.end())
+    return it->second;
+
+  int tokens = mergeCount(piece);
+  if (m_pieceCache.size() >= MAX_CACHED_PIECES) {
+    m_pieceCache.clear();
+    m_cacheKeys.clear();
+  }
+  m_cacheKeys.emplace_back(piece);
+  m_pieceCache.emplace(m_cacheKeys.back(), tokens);
+  return tokens;
+}
+
+int BpeTokenizer::count(const QString &text) const {
+  if (!isLoaded())
+    return estimate(text);
+  QByteArray utf8 = text.toUtf8();
+  int tokens = 0;
+  for (std::string_view piece :
+       pretokenize(std::string_view(utf8.constData(), utf8.size())))
+    tokens += countPiece(piece);
+  return tokens;
+}
+
+int BpeTokenizer::countMessages(const QJsonArray &messages) const {
+  int tokens = 3; // reply priming
+  for (const auto &value : messages) {
+    QJsonObject m = value.toObject();
+    tokens += 3 + count(m["role"].toString()) + count(m["content"].toString());
+    if (m.contains("tool_calls")) {
+      tokens += count(QString::fromUtf8(
+          QJsonDocument(m["tool_calls"].toArray()).toJson(
+              QJsonDocument::Compact)));
+    }
+    if (m.contains("tool_call_id"))
+      tokens += count(m["tool_call_id"].toString());
+  }
+  return tokens;
+}
+
+int BpeTokenizer::estimate(const QString &text) {
+  // Roughly 4 characters per token for Latin text, 2.5 for Cyrillic
+  int ascii = 0;
+  for (QChar c : text) {
+    if (c.unicode() < 0x80)
+      ascii++;
+  }
+  int other = text.size() - ascii;
+  return (ascii + 3) / 4 + (other * 2 + 4) / 5;
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,54 @@
+#ifndef BPE_TOKENIZER_HPP
+#define BPE_TOKENIZER_HPP
+
+#include <QJsonArray>
+#include <QString>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DevPlanner {
+
+// Byte-level BPE token counter for tiktoken-format vocabularies
+// ("<base64 bytes> <rank>" per line, e.g. cl100k_base.tiktoken). Without a
+// vocabulary it falls back to a length-based estimate. The pre-tokenizer
+// follows cl100k_base, so other vocabularies count approximately.
+class BpeTokenizer {
+public:
+  bool load(const QString &path);
+  bool isLoaded() const { return !m_ranks.empty(); }
+  QString name() const { return m_name; }
+
+  int count(const QString &text) const;
+  // Chat formatting overhead included, as in OpenAI's accounting
+  int countMessages(const QJsonArray &messages) const;
+
+  // Splits UTF-8 text into pre-tokenization pieces (cl100k-style rules)
+  static std::vector<std::string_view> pretokenize(std::string_view text);
+
+  static int estimate(const QString &text);
+
+private:
+  int countPiece(std::string_view piece) const;
+  int mergeCount(std::string_view piece) const;
+  int rankOf(std::string_view bytes) const;
+
+  QString m_name;
+  std::string m_arena; // decoded token bytes, viewed by m_ranks
+  std::unordered_map<std::string_view, int> m_ranks;
+
+  // Token counts of recently seen pieces
+  mutable std::deque<std::string> m_cacheKeys;
+  mutable std::unordered_map<std::string_view, int> m_pieceCache;
+
+  static constexpr size_t MAX_CACHED_PIECES = 200000;
+  // Longer pieces (minified data, long digit-free runs) are merged in
+  // chunks to keep the quadratic merge loop bounded
+  static constexpr size_t MAX_PIECE = 256;
+};
+
+} // namespace DevPlanner
+
+#endif
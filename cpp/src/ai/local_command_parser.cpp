@@ -0,0 +1,290 @@
+#include "local_command_parser.hpp"
+#include <QHash>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QSet>
+#include <utility>
+
+namespace DevPlanner {
+
+namespace {
+
+const QString TASK_WORD = R"((?:tasks?|задач[аиуы]?|#)?\s*)";
+// "все" | "1-5" | "1..5" | "1, 3 и 7"
+const QString TASK_LIST = R"((все|all|#?\d+(?:\s*(?:-|\.\.)\s*#?\d+)?)"
+                          R"((?:\s*(?:,|&|и|and)?\s*)"
+                          R"(#?\d+(?:\s*(?:-|\.\.)\s*#?\d+)?)*))";
+
+const QHash<QString, QString> &statusSynonyms() {
+  static const QHash<QString, QString> SYNONYMS = {
+      {"done", "done"},
+      {"complete", "done"},
+      {"completed", "done"},
+      {"finished", "done"},
+      {"closed", "done"},
+      {"готово", "done"},
+      {"готовы", "done"},
+      {"готовой", "done"},
+      {"готовым", "done"},
+      {"готовыми", "done"},
+      {"выполнено", "done"},
+      {"выполнены", "done"},
+      {"выполненной", "done"},
+      {"выполненными", "done"},
+      {"сделано", "done"},
+      {"сделаны", "done"},
+      {"сделанной", "done"},
+      {"сделанными", "done"},
+      {"завершено", "done"},
+      {"завершены", "done"},
+      {"завершенными", "done"},
+      {"progress", "progress"},
+      {"in progress", "progress"},
+      {"wip", "progress"},
+      {"doing", "progress"},
+      {"started", "progress"},
+      {"в работе", "progress"},
+      {"в работу", "progress"},
+      {"в процессе", "progress"},
+      {"в процесс", "progress"},
+      {"начато", "progress"},
+      {"начаты", "progress"},
+      {"todo", "todo"},
+      {"to do", "todo"},
+      {"open", "todo"},
+      {"reopen", "todo"},
+      {"не сделано", "todo"},
+      {"не сделаны", "todo"},
+      {"несделанными", "todo"},
+      {"невыполненными", "todo"},
+      {"к выполнению", "todo"},
+      {"ready", "ready"},
+      {"unblocked", "ready"},
+      {"можно начинать", "ready"},
+      {"готово к работе", "ready"},
+      {"blocked", "blocked"},
+      {"заблокировано", "blocked"},
+      {"заблокированы", "blocked"},
+      {"заблокированной", "blocked"},
+      {"заблокированными", "blocked"},
+      {"none", "none"},
+      {"no status", "none"},
+      {"без статуса", "none"},
+      {"cancelled", "cancelled"},
+      {"canceled", "cancelled"},
+      {"cancel", "cancelled"},
+      {"отменено", "cancelled"},
+      {"отменены", "cancelled"},
+      {"отмененной", "cancelled"},
+      {"отмененными", "cancelled"}};
+  return SYNONYMS;
+}
+
+} // namespace
+
+QString LocalCommandParser::normalize(const QString &text) {
+  QString s = text.toLower().trimmed();
+  s.replace(QChar(0x0451), QChar(0x0435)); // ё -> е
+  s.replace(QChar(0x2013), '-');           // en dash
+  s.replace(QChar(0x2014), '-');           // em dash
+  s.replace(QString::fromUtf8("→"), "->");
+  while (!s.isEmpty() && QString(".!").contains(s.back()))
+    s.chop(1);
+  return s.simplified();
+}
+
+QString LocalCommandParser::statusFromWord(const QString &word) {
+  QString w = word.trimmed();
+  const auto &syn = statusSynonyms();
+  if (syn.contains(w))
+    return syn.value(w);
+
+  static const QRegularExpression taskWord(R"(^(?:tasks|задачи)\s+)");
+  static const QRegularExpression prefix(R"(^(?:as|to|в|как|на|:|=)\s+)");
+  QString stripped = w;
+  stripped.remove(taskWord);
+  if (syn.contains(stripped))
+    return syn.value(stripped);
+  stripped.remove(prefix);
+  return syn.value(stripped);
+}
+
+QString LocalCommandParser::arrangeTypeFromWord(const QString &word) {
+  static const QHash<QString, QString> TYPES = {
+      {"tree", "tree"},
+      {"дерево", "tree"},
+      {"деревом", "tree"},
+      {"grid", "grid"},
+      {"сетка", "grid"},
+      {"сеткой", "grid"},
+      {"horizontal", "horizontal"},
+      {"horizontally", "horizontal"},
+      {"горизонтально", "horizontal"},
+      {"vertical", "vertical"},
+      {"vertically", "vertical"},
+      {"вертикально", "vertical"},
+      {"force", "force"},
+      {"свободно", "force"},
+      {"pack", "pack"},
+      {"плотно", "pack"}};
+  return TYPES.value(word.trimmed());
+}
+
+QList<int> LocalCommandParser::parseTaskList(const QString &text,
+                                             int taskCount, bool *ok) {
+  QList<int> result;
+  *ok = false;
+
+  QString s = text.trimmed();
+  if (s == "все" || s == "all") {
+    for (int i = 1; i <= taskCount; ++i)
+      result.append(i);
+    *ok = !result.isEmpty();
+    return result;
+  }
+
+  static const QRegularExpression item(
+      R"(#?(\d+)(?:\s*(?:-|\.\.)\s*#?(\d+))?)");
+  QSet<int> seen;
+  auto it = item.globalMatch(s);
+  while (it.hasNext()) {
+    auto m = it.next();
+    int from = m.captured(1).toInt();
+    int to = m.captured(2).isEmpty() ? from : m.captured(2).toInt();
+    if (from > to)
+      std::swap(from, to);
+    // Guard against "1-100000" typos producing huge batches
+    if (to - from > 10000)
+      return QList<int>();
+    for (int i = from; i <= to; ++i) {
+      if (!seen.contains(i)) {
+        seen.insert(i);
+        result.append(i);
+      }
+    }
+  }
+  *ok = !result.isEmpty();
+  return result;
+}
+
+QJsonObject LocalCommandParser::parse(const QString &text, int taskCount) {
+  QString s = normalize(text);
+  if (s.isEmpty() || s.length() > 200)
+    return QJsonObject();
+
+  // Arrows: "1 -> 2 -> 3"
+  static const QRegularExpression arrowChain(
+      R"(^(?:connect\s+|соедини\s+)?#?\d+(?:\s*->\s*#?\d+)+$)");
+  if (arrowChain.match(s).hasMatch()) {
+    static const QRegularExpression num(R"(\d+)");
+    QList<int> ids;
+    auto it = num.globalMatch(s);
+    while (it.hasNext())
+      ids.append(it.next().captured(0).toInt());
+    QJsonObject obj;
+    if (ids.size() == 2) {
+      obj["action"] = "connect";
+      obj["from"] = ids[0];
+      obj["to"] = ids[1];
+    } else {
+      QJsonArray pairs;
+      for (int i = 0; i + 1 < ids.size(); ++i)
+        pairs.append(QJsonArray{ids[i], ids[i + 1]});
+      obj["action"] = "connect_many";
+      obj["connections"] = pairs;
+    }
+    return obj;
+  }
+
+  static const QRegularExpression connectRe(
+      "^(?:connect|link|соедини|свяжи)\\s+" + TASK_WORD +
+      R"(#?(\d+)\s*(?:to|with|and|с|со|и|к|-)\s*#?(\d+)$)");
+  auto m = connectRe.match(s);
+  if (m.hasMatch()) {
+    QJsonObject obj;
+    obj["action"] = "connect";
+    obj["from"] = m.captured(1).toInt();
+    obj["to"] = m.captured(2).toInt();
+    return obj;
+  }
+
+  static const QRegularExpression disconnectRe(
+      "^(?:disconnect|unlink|разъедини|отсоедини|отвяжи)\\s+" + TASK_WORD +
+      R"(#?(\d+)\s*(?:from|and|от|и|с|-)\s*#?(\d+)$)");
+  m = disconnectRe.match(s);
+  if (m.hasMatch()) {
+    QJsonObject obj;
+    obj["action"] = "disconnect";
+    obj["from"] = m.captured(1).toInt();
+    obj["to"] = m.captured(2).toInt();
+    return obj;
+  }
+
+  static const QRegularExpression deleteRe(
+      "^(?:delete|remove|удали|убери)\\s+" + TASK_WORD + TASK_LIST + "$");
+  m = deleteRe.match(s);
+  if (m.hasMatch()) {
+    bool ok;
+    QList<int> tasks = parseTaskList(m.captured(1), taskCount, &ok);
+    if (!ok)
+      return QJsonObject();
+    QJsonObject obj;
+    if (tasks.size() == 1) {
+      obj["action"] = "delete";
+      obj["task"] = tasks.first();
+    } else {
+      QJsonArray arr;
+      for (int t : tasks)
+        arr.append(t);
+      obj["action"] = "delete_many";
+      obj["tasks"] = arr;
+    }
+    return obj;
+  }
+
+  static const QRegularExpression arrangeRe(
+      R"(^(?:arrange|layout|расположи|упорядочи|выровняй|разложи)\s+)"
+      R"((?:tasks\s+|задачи\s+)?(?:as\s+|in\s+|a\s+|в виде\s+)?(\S+)$)");
+  m = arrangeRe.match(s);
+  if (m.hasMatch()) {
+    QString type = arrangeTypeFromWord(m.captured(1));
+    if (type.isEmpty())
+      return QJsonObject();
+    QJsonObject obj;
+    obj["action"] = "arrange";
+    obj["type"] = type;
+    return obj;
+  }
+
+  // Status: "[mark] 1-5 [as] done", "отметь 3, 4 готовыми"
+  static const QRegularExpression statusRe(
+      "^(?:(?:mark|set|make|отметь|пометь|сделай|переведи|поставь)\\s+)?" +
+      TASK_WORD + TASK_LIST + R"(\s+(.+)$)");
+  m = statusRe.match(s);
+  if (m.hasMatch()) {
+    QString status = statusFromWord(m.captured(2));
+    if (status.isEmpty())
+      return QJsonObject();
+    bool ok;
+    QList<int> tasks = parseTaskList(m.captured(1), taskCount, &ok);
+    if (!ok)
+      return QJsonObject();
+    QJsonObject obj;
+    obj["status"] = status;
+    if (tasks.size() == 1) {
+      obj["action"] = "set_status";
+      obj["task"] = tasks.first();
+    } else {
+      QJsonArray arr;
+      for (int t : tasks)
+        arr.append(t);
+      obj["action"] = "set_many_status";
+      obj["tasks"] = arr;
+    }
+    return obj;
+  }
+
+  return QJsonObject();
+}
+
+} // namespace DevPlanner
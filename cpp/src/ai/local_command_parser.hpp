@@ -0,0 +1,29 @@
+#ifndef LOCAL_COMMAND_PARSER_HPP
+#define LOCAL_COMMAND_PARSER_HPP
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+namespace DevPlanner {
+
+// Deterministic parser for mechanical chat commands ("mark 1-5 done",
+// "соедини 3 и 7", "delete 4", "arrange tree"). Produces the same action
+// objects the model would return, so they go through AIActionRegistry.
+class LocalCommandParser {
+public:
+  // Returns an empty object when the text should go to the model
+  static QJsonObject parse(const QString &text, int taskCount);
+
+  static QString statusFromWord(const QString &word);
+
+private:
+  static QString normalize(const QString &text);
+  static QList<int> parseTaskList(const QString &text, int taskCount,
+                                  bool *ok);
+  static QString arrangeTypeFromWord(const QString &word);
+};
+
+} // namespace DevPlanner
+
+#endif
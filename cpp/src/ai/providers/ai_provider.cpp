@@ -0,0 +1,127 @@
+#include "ai_provider.hpp"
+#include <QJsonArray>
+#include <QUrl>
+
+namespace DevPlanner {
+
+ProviderConfig ProviderConfig::fromJson(const QJsonObject &obj) {
+  ProviderConfig c;
+  c.id = obj["id"].toString();
+  c.name = obj["name"].toString(c.id);
+  c.type = obj["type"].toString("openai");
+  c.baseUrl = obj["base_url"].toString();
+  c.auth = obj["auth"].toString("bearer");
+  c.apiKey = obj["api_key"].toString();
+  c.maxConcurrent = qMax(1, obj["max_concurrent"].toInt(4));
+  for (const auto &m : obj["models"].toArray())
+    c.models.append(m.toString());
+  c.options = obj["options"].toObject();
+  return c;
+}
+
+QJsonObject ProviderConfig::toJson() const {
+  QJsonObject obj;
+  obj["id"] = id;
+  obj["name"] = name;
+  obj["type"] = type;
+  obj["base_url"] = baseUrl;
+  obj["auth"] = auth;
+  if (!apiKey.isEmpty())
+    obj["api_key"] = apiKey;
+  obj["max_concurrent"] = maxConcurrent;
+  obj["models"] = QJsonArray::fromStringList(models);
+  if (!options.isEmpty())
+    obj["options"] = options;
+  return obj;
+}
+
+CompletionRequest::CompletionRequest(const QJsonObject &payload,
+                                     QObject *parent)
+    : QObject(parent), m_payload(payload) {}
+
+void CompletionRequest::abort() {
+  if (m_finished || m_aborted)
+    return;
+  m_aborted = true;
+  std::function<void()> handler = std::move(m_abortHandler);
+  m_abortHandler = nullptr;
+  if (handler)
+    handler();
+}
+
+AIProvider::AIProvider(const ProviderConfig &config, QObject *parent)
+    : QObject(parent), m_config(config) {}
+
+bool AIProvider::isLocal() const {
+  if (m_config.type == "mock")
+    return true;
+  QString host = QUrl(m_config.baseUrl).host().toLower();
+  return host == "localhost" || host == "127.0.0.1" || host == "::1" ||
+         host.endsWith(".localhost");
+}
+
+CompletionRequest *AIProvider::complete(const QJsonObject &payload) {
+  auto *request = new CompletionRequest(payload);
+  request->m_providerId = m_config.id;
+  request->m_timer.start();
+  // Until started, aborting just drops it from the queue
+  request->m_abortHandler = [this, request]() {
+    m_queue.removeAll(QPointer<CompletionRequest>(request));
+    finish(request, QJsonObject(), "Запрос отменён");
+  };
+  m_queue.append(request);
+  pump();
+  emit statsChanged();
+  return request;
+}
+
+void AIProvider::pump() {
+  while (m_inFlight < m_config.maxConcurrent && !m_queue.isEmpty()) {
+    QPointer<CompletionRequest> request = m_queue.takeFirst();
+    if (!request || request->m_finished)
+      continue;
+    request->m_started = true;
+    request->m_abortHandler = nullptr;
+    m_inFlight++;
+    start(request);
+  }
+}
+
+void AIProvider::setAbortHandler(CompletionRequest *request,
+                                 std::function<void()> handler) {
+  request->m_abortHandler = std::move(handler);
+}
+
+void AIProvider::markFirstChunk(CompletionRequest *request) {
+  if (request->m_firstChunkMs >= 0)
+    return;
+  request->m_firstChunkMs = request->m_timer.elapsed();
+  emit request->firstChunk();
+}
+
+void AIProvider::finish(CompletionRequest *request, const QJsonObject &message,
+                        const QString &error) {
+  if (request->m_finished)
+    return;
+  request->m_finished = true;
+  request->m_message = message;
+  request->m_error =
+      request->m_aborted && error.isEmpty() ? "Запрос отменён" : error;
+  request->m_abortHandler = nullptr;
+  if (request->m_started)
+    m_inFlight--;
+  if (!request->hasError())
+    m_latency.add(static_cast<double>(request->m_timer.elapsed()));
+
+  emit request->finished();
+  emit statsChanged();
+  pump();
+}
+
+void AIProvider::releaseSlot() {
+  m_inFlight--;
+  emit statsChanged();
+  pump();
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,121 @@
+#ifndef AI_PROVIDER_HPP
+#define AI_PROVIDER_HPP
+
+#include "latency_stats.hpp"
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <functional>
+
+namespace DevPlanner {
+
+struct ProviderConfig {
+  QString id;
+  QString name;
+  QString type = "openai"; // "openai" | "mock"
+  QString baseUrl;         // e.g. https://openrouter.ai/api/v1
+  QString auth = "bearer"; // "bearer" | "header:<Name>" | "none"
+  QString apiKey;
+  int maxConcurrent = 4;
+  QStringList models;
+  QJsonObject options; // provider-specific settings
+
+  static ProviderConfig fromJson(const QJsonObject &obj);
+  QJsonObject toJson() const;
+  bool needsApiKey() const { return type != "mock" && auth != "none"; }
+};
+
+// One chat/completions call. Owned by the caller once finished() fires.
+class CompletionRequest : public QObject {
+  Q_OBJECT
+
+public:
+  explicit CompletionRequest(const QJsonObject &payload,
+                             QObject *parent = nullptr);
+
+  const QJsonObject &payload() const { return m_payload; }
+  QString model() const { return m_payload["model"].toString(); }
+  QString providerId() const { return m_providerId; }
+
+  bool isFinished() const { return m_finished; }
+  bool hasError() const { return !m_error.isEmpty(); }
+  QString errorString() const { return m_error; }
+  // choices[0].message of the reply
+  QJsonObject message() const { return m_message; }
+
+  bool wasAborted() const { return m_aborted; }
+  qint64 elapsedMs() const {
+    return m_timer.isValid() ? m_timer.elapsed() : 0;
+  }
+  qint64 firstChunkMs() const { return m_firstChunkMs; }
+
+  void abort();
+
+signals:
+  void firstChunk();
+  void finished();
+
+private:
+  friend class AIProvider;
+
+  QJsonObject m_payload;
+  QString m_providerId;
+  QJsonObject m_message;
+  QString m_error;
+  bool m_started = false;
+  bool m_finished = false;
+  bool m_aborted = false;
+  QElapsedTimer m_timer;
+  qint64 m_firstChunkMs = -1;
+  std::function<void()> m_abortHandler;
+};
+
+// Backend that speaks chat/completions. Requests beyond maxConcurrent wait
+// in a FIFO queue.
+class AIProvider : public QObject {
+  Q_OBJECT
+
+public:
+  explicit AIProvider(const ProviderConfig &config, QObject *parent = nullptr);
+
+  const ProviderConfig &config() const { return m_config; }
+  QString id() const { return m_config.id; }
+  void setApiKey(const QString &key) { m_config.apiKey = key; }
+  bool isLocal() const;
+
+  CompletionRequest *complete(const QJsonObject &payload);
+
+  const LatencyStats &latency() const { return m_latency; }
+  int inFlight() const { return m_inFlight; }
+  int queued() const { return m_queue.size(); }
+
+signals:
+  void statsChanged();
+
+protected:
+  virtual void start(CompletionRequest *request) = 0;
+
+  void setAbortHandler(CompletionRequest *request,
+                       std::function<void()> handler);
+  void markFirstChunk(CompletionRequest *request);
+  void finish(CompletionRequest *request, const QJsonObject &message,
+              const QString &error = QString());
+  // For started requests whose owner deleted them before completion
+  void releaseSlot();
+
+  ProviderConfig m_config;
+
+private:
+  void pump();
+
+  QList<QPointer<CompletionRequest>> m_queue;
+  int m_inFlight = 0;
+  LatencyStats m_latency;
+};
+
+} // namespace DevPlanner
+
+#endif
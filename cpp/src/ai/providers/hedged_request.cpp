@@ -0,0 +1,163 @@
+#include "hedged_request.hpp"
+
+namespace DevPlanner {
+
+void HedgePolicy::record(const QString &model, qint64 firstChunkMs,
+                         qint64 totalMs) {
+  if (firstChunkMs >= 0)
+    m_firstChunk[model].add(static_cast<double>(firstChunkMs));
+  m_total[model].add(static_cast<double>(totalMs));
+}
+
+int HedgePolicy::delayFor(const QString &model) const {
+  if (!m_autoTune)
+    return m_baseDelay;
+  auto it = m_firstChunk.constFind(model);
+  if (it == m_firstChunk.constEnd() || it->count() < MIN_SAMPLES)
+    return m_baseDelay;
+  return qBound(MIN_DELAY, qRound(it->percentile(0.95)), MAX_DELAY);
+}
+
+const LatencyStats *HedgePolicy::firstChunk(const QString &model) const {
+  auto it = m_firstChunk.constFind(model);
+  return it == m_firstChunk.constEnd() ? nullptr : &it.value();
+}
+
+const LatencyStats *HedgePolicy::total(const QString &model) const {
+  auto it = m_total.constFind(model);
+  return it == m_total.constEnd() ? nullptr : &it.value();
+}
+
+HedgedRequest::HedgedRequest(AIProvider *primary, const QString &primaryModel,
+                             AIProvider *secondary,
+                             const QString &secondaryModel,
+                             const QJsonObject &payload, int delayMs,
+                             Validator validator, HedgePolicy *policy,
+                             QObject *parent)
+    : QObject(parent), m_primaryProvider(primary),
+      m_secondaryProvider(secondary), m_primaryModel(primaryModel),
+      m_secondaryModel(secondaryModel), m_payload(payload),
+      m_validator(std::move(validator)), m_policy(policy) {
+  m_hedgeTimer.setSingleShot(true);
+  m_hedgeTimer.setInterval(delayMs);
+  connect(&m_hedgeTimer, &QTimer::timeout, this,
+          &HedgedRequest::launchSecondary);
+}
+
+HedgedRequest::~HedgedRequest() { abortPending(); }
+
+void HedgedRequest::start() {
+  QJsonObject payload = m_payload;
+  payload["model"] = m_primaryModel;
+  CompletionRequest *request = m_primaryProvider->complete(payload);
+  m_primary = request;
+  connect(request, &CompletionRequest::firstChunk, &m_hedgeTimer,
+          &QTimer::stop);
+  connect(request, &CompletionRequest::firstChunk, this,
+          &HedgedRequest::onFirstChunk);
+  connect(request, &CompletionRequest::finished, this,
+          [this, request]() { onAttemptFinished(request, true); });
+  if (m_secondaryProvider && !m_secondaryModel.isEmpty() && !m_done)
+    m_hedgeTimer.start();
+}
+
+void HedgedRequest::launchSecondary() {
+  if (m_done || m_hedged || !m_secondaryProvider ||
+      m_secondaryModel.isEmpty())
+    return;
+  m_hedged = true;
+  QJsonObject payload = m_payload;
+  payload["model"] = m_secondaryModel;
+  CompletionRequest *request = m_secondaryProvider->complete(payload);
+  m_secondary = request;
+  connect(request, &CompletionRequest::firstChunk, this,
+          &HedgedRequest::onFirstChunk);
+  connect(request, &CompletionRequest::finished, this,
+          [this, request]() { onAttemptFinished(request, false); });
+}
+
+void HedgedRequest::onFirstChunk() {
+  if (m_firstChunkSeen || m_done)
+    return;
+  m_firstChunkSeen = true;
+  emit firstChunk();
+}
+
+void HedgedRequest::onAttemptFinished(CompletionRequest *request,
+                                      bool isPrimary) {
+  if (m_done)
+    return;
+  if (!request->wasAborted())
+    m_policy->record(request->model(), request->firstChunkMs(),
+                     request->elapsedMs());
+
+  if (request->hasError()) {
+    m_lastError = request->errorString();
+  } else if (!m_validator || m_validator(request->message())) {
+    accept(request, isPrimary);
+    return;
+  } else if (m_fallback.isEmpty()) {
+    m_fallback = request->message();
+    m_fallbackModel = request->model();
+    m_fallbackProvider = request->providerId();
+  }
+
+  // A failed primary should not wait out the rest of the hedge delay
+  if (isPrimary)
+    launchSecondary();
+
+  bool otherPending = isPrimary ? (m_secondary && !m_secondary->isFinished())
+                                : (m_primary && !m_primary->isFinished());
+  if (otherPending)
+    return;
+
+  if (!m_fallback.isEmpty()) {
+    m_done = true;
+    m_message = m_fallback;
+    m_winnerModel = m_fallbackModel;
+    m_winnerProvider = m_fallbackProvider;
+    abortPending();
+    emit finished();
+  } else {
+    fail(m_lastError);
+  }
+}
+
+void HedgedRequest::accept(CompletionRequest *request, bool isPrimary) {
+  m_done = true;
+  m_hedgeTimer.stop();
+  m_message = request->message();
+  m_winnerModel = request->model();
+  m_winnerProvider = request->providerId();
+  m_secondaryWon = !isPrimary;
+  abortPending();
+  emit finished();
+}
+
+void HedgedRequest::fail(const QString &error) {
+  m_done = true;
+  m_hedgeTimer.stop();
+  m_error = error.isEmpty() ? "Нет ответа" : error;
+  abortPending();
+  emit finished();
+}
+
+void HedgedRequest::abort() {
+  if (m_done)
+    return;
+  fail("Запрос отменён");
+}
+
+void HedgedRequest::abortPending() {
+  for (CompletionRequest *request : {m_primary.data(), m_secondary.data()}) {
+    if (!request)
+      continue;
+    disconnect(request, nullptr, this, nullptr);
+    request->abort();
+    request->deleteLater();
+  }
+  m_primary.clear();
+  m_secondary.clear();
+}
+
+} // namespace DevPlanner
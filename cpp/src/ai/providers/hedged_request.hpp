@@ -0,0 +1,111 @@
+#ifndef HEDGED_REQUEST_HPP
+#define HEDGED_REQUEST_HPP
+
+#include "ai_provider.hpp"
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <functional>
+
+namespace DevPlanner {
+
+// Per-model latency history that picks the hedge delay. With enough samples
+// the delay follows the primary model's p95 time to first chunk, so only the
+// slowest ~5% of requests get a second copy.
+class HedgePolicy {
+public:
+  void record(const QString &model, qint64 firstChunkMs, qint64 totalMs);
+
+  int delayFor(const QString &model) const;
+  void setBaseDelay(int ms) { m_baseDelay = ms; }
+  int baseDelay() const { return m_baseDelay; }
+  void setAutoTune(bool enabled) { m_autoTune = enabled; }
+  bool autoTune() const { return m_autoTune; }
+
+  const LatencyStats *firstChunk(const QString &model) const;
+  const LatencyStats *total(const QString &model) const;
+  QStringList models() const { return m_total.keys(); }
+
+  static constexpr int MIN_SAMPLES = 10;
+  static constexpr int MIN_DELAY = 250;
+  static constexpr int MAX_DELAY = 20000;
+
+private:
+  QHash<QString, LatencyStats> m_firstChunk;
+  QHash<QString, LatencyStats> m_total;
+  int m_baseDelay = 4000;
+  bool m_autoTune = true;
+};
+
+// Sends the payload to the primary model and, if no first chunk arrives
+// within the delay (or the primary fails), to the secondary too. The first
+// reply accepted by the validator wins and the other request is aborted.
+class HedgedRequest : public QObject {
+  Q_OBJECT
+
+public:
+  using Validator = std::function<bool(const QJsonObject &message)>;
+
+  HedgedRequest(AIProvider *primary, const QString &primaryModel,
+                AIProvider *secondary, const QString &secondaryModel,
+                const QJsonObject &payload, int delayMs, Validator validator,
+                HedgePolicy *policy, QObject *parent = nullptr);
+  ~HedgedRequest() override;
+
+  void start();
+  void abort();
+
+  bool hasError() const { return !m_error.isEmpty(); }
+  QString errorString() const { return m_error; }
+  QJsonObject message() const { return m_message; }
+  QString model() const { return m_winnerModel; }
+  QString providerId() const { return m_winnerProvider; }
+  // True when the secondary request was actually sent
+  bool hedged() const { return m_hedged; }
+  bool secondaryWon() const { return m_secondaryWon; }
+
+signals:
+  // First streamed data from either attempt
+  void firstChunk();
+  void finished();
+
+private:
+  void launchSecondary();
+  void onFirstChunk();
+  void onAttemptFinished(CompletionRequest *request, bool isPrimary);
+  void accept(CompletionRequest *request, bool isPrimary);
+  void fail(const QString &error);
+  void abortPending();
+
+  AIProvider *m_primaryProvider;
+  AIProvider *m_secondaryProvider;
+  QString m_primaryModel;
+  QString m_secondaryModel;
+  QJsonObject m_payload;
+  Validator m_validator;
+  HedgePolicy *m_policy;
+  QTimer m_hedgeTimer;
+
+  QPointer<CompletionRequest> m_primary;
+  QPointer<CompletionRequest> m_secondary;
+  // Reply that arrived but failed validation, used if nothing better comes
+  QJsonObject m_fallback;
+  QString m_fallbackModel;
+  QString m_fallbackProvider;
+  QString m_lastError;
+
+  QJsonObject m_message;
+  QString m_error;
+  QString m_winnerModel;
+  QString m_winnerProvider;
+  bool m_hedged = false;
+  bool m_secondaryWon = false;
+  bool m_firstChunkSeen = false;
+  bool m_done = false;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef LATENCY_STATS_HPP
+#define LATENCY_STATS_HPP
+
+#include <QVector>
+#include <algorithm>
+
+namespace DevPlanner {
+
+// Fixed-size ring buffer of latency samples (ms) with percentile queries
+class LatencyStats {
+public:
+  explicit LatencyStats(int capacity = 200) : m_capacity(capacity) {
+    m_samples.reserve(capacity);
+  }
+
+  void add(double ms) {
+    if (m_samples.size() < m_capacity) {
+      m_samples.append(ms);
+    } else {
+      m_samples[m_next] = ms;
+    }
+    m_next = (m_next + 1) % m_capacity;
+    m_total++;
+  }
+
+  int count() const { return m_samples.size(); }
+  int total() const { return m_total; }
+  bool isEmpty() const { return m_samples.isEmpty(); }
+
+  // p in [0, 1]; returns 0 without samples
+  double percentile(double p) const {
+    if (m_samples.isEmpty())
+      return 0;
+    QVector<double> sorted = m_samples;
+    int idx = qBound(0, static_cast<int>(p * (sorted.size() - 1) + 0.5),
+                     static_cast<int>(sorted.size()) - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+    return sorted[idx];
+  }
+
+  double mean() const {
+    if (m_samples.isEmpty())
+      return 0;
+    double sum = 0;
+    for (double s : m_samples)
+      sum += s;
+    return sum / m_samples.size();
+  }
+
+private:
+  QVector<double> m_samples;
+  int m_capacity;
+  int m_next = 0;
+  int m_total = 0;
+};
+
+} // namespace DevPlanner
+
+#endif
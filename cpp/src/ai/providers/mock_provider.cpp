@@ -0,0 +1,58 @@
+#include "mock_provider.hpp"
+#include <QJsonArray>
+#include <QPointer>
+#include <QTimer>
+
+namespace DevPlanner {
+
+MockProvider::MockProvider(const ProviderConfig &config, QObject *parent)
+    : AIProvider(config, parent) {}
+
+void MockProvider::start(CompletionRequest *request) {
+  auto *timer = new QTimer(this);
+  timer->setSingleShot(true);
+  QPointer<CompletionRequest> guard(request);
+
+  setAbortHandler(request, [this, timer, request]() {
+    timer->stop();
+    timer->deleteLater();
+    finish(request, QJsonObject(), "Запрос отменён");
+  });
+  connect(timer, &QTimer::timeout, this, [this, timer, guard]() {
+    timer->deleteLater();
+    if (!guard) {
+      releaseSlot();
+      return;
+    }
+    markFirstChunk(guard);
+    QString error = m_config.options["error"].toString();
+    if (!error.isEmpty())
+      finish(guard, QJsonObject(), error);
+    else
+      finish(guard, nextReply(guard));
+  });
+  timer->start(m_config.options["latency_ms"].toInt(300));
+}
+
+QJsonObject MockProvider::nextReply(const CompletionRequest *request) {
+  QJsonArray replies = m_config.options["replies"].toArray();
+  QJsonObject message;
+  message["role"] = "assistant";
+
+  if (replies.isEmpty()) {
+    QJsonArray messages = request->payload()["messages"].toArray();
+    QString last = messages.isEmpty()
+                       ? QString()
+                       : messages.last().toObject()["content"].toString();
+    message["content"] = "🧪 mock: " + last.right(200);
+    return message;
+  }
+
+  QJsonValue reply = replies[m_nextReply++ % replies.size()];
+  if (reply.isObject())
+    return reply.toObject();
+  message["content"] = reply.toString();
+  return message;
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,30 @@
+#ifndef MOCK_PROVIDER_HPP
+#define MOCK_PROVIDER_HPP
+
+#include "ai_provider.hpp"
+
+namespace DevPlanner {
+
+// Offline provider with canned replies. Options:
+//   latency_ms - delay before the reply (default 300)
+//   replies    - array of reply messages (or plain strings), used in turn
+//   error      - if set, every request fails with this message
+class MockProvider : public AIProvider {
+  Q_OBJECT
+
+public:
+  explicit MockProvider(const ProviderConfig &config,
+                        QObject *parent = nullptr);
+
+protected:
+  void start(CompletionRequest *request) override;
+
+private:
+  QJsonObject nextReply(const CompletionRequest *request);
+
+  int m_nextReply = 0;
+};
+
+} // namespace DevPlanner
+
+#endif
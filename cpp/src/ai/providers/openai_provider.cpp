@@ -0,0 +1,202 @@
+#include "openai_provider.hpp"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkProxy>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSslError>
+#include <memory>
+
+namespace DevPlanner {
+
+namespace {
+
+bool isEventStream(QNetworkReply *reply) {
+  return reply->header(QNetworkRequest::ContentTypeHeader)
+      .toString()
+      .startsWith("text/event-stream");
+}
+
+} // namespace
+
+struct OpenAIProvider::StreamState {
+  struct ToolCall {
+    QString id;
+    QString name;
+    QString arguments;
+  };
+
+  QByteArray buffer; // bytes after the last complete line
+  QString content;
+  QList<ToolCall> toolCalls;
+  QString error;
+  bool sawData = false;
+  bool done = false;
+};
+
+OpenAIProvider::OpenAIProvider(const ProviderConfig &config, QObject *parent)
+    : AIProvider(config, parent) {
+  m_network = new QNetworkAccessManager(this);
+
+  if (isLocal()) {
+    // Same-box servers: no proxy lookup, plain HTTP
+    m_network->setProxy(QNetworkProxy::NoProxy);
+  } else {
+#ifdef Q_OS_WIN
+    connect(m_network, &QNetworkAccessManager::sslErrors, this,
+            [](QNetworkReply *reply, const QList<QSslError> &errors) {
+              reply->ignoreSslErrors();
+            });
+#endif
+  }
+}
+
+void OpenAIProvider::start(CompletionRequest *request) {
+  QString base = m_config.baseUrl;
+  while (base.endsWith('/'))
+    base.chop(1);
+  QNetworkRequest req{QUrl(base + "/chat/completions")};
+  req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+  if (m_config.auth == "bearer") {
+    req.setRawHeader("Authorization", ("Bearer " + m_config.apiKey).toUtf8());
+  } else if (m_config.auth.startsWith("header:")) {
+    req.setRawHeader(m_config.auth.mid(7).toUtf8(), m_config.apiKey.toUtf8());
+  }
+  if (isLocal())
+    req.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+
+  bool stream = m_config.options["stream"].toBool(false);
+  QJsonObject payload = request->payload();
+  if (stream)
+    payload["stream"] = true;
+
+  QNetworkReply *reply = m_network->post(
+      req, QJsonDocument(payload).toJson(QJsonDocument::Compact));
+
+  QPointer<CompletionRequest> guard(request);
+  auto state = std::make_shared<StreamState>();
+  setAbortHandler(request, [reply]() { reply->abort(); });
+  connect(reply, &QNetworkReply::readyRead, request,
+          [this, request, reply, state, stream]() {
+            // Servers may ignore "stream" and answer with a plain JSON body
+            if (!stream || !isEventStream(reply)) {
+              markFirstChunk(request);
+              return;
+            }
+            state->buffer += reply->readAll();
+            consumeEvents(request, *state);
+          });
+  connect(reply, &QNetworkReply::finished, this,
+          [this, guard, reply, state, stream]() {
+    reply->deleteLater();
+    CompletionRequest *request = guard.data();
+    if (!request) {
+      releaseSlot();
+      return;
+    }
+    if (reply->error() != QNetworkReply::NoError) {
+      QJsonObject body = QJsonDocument::fromJson(reply->readAll()).object();
+      QJsonObject err = body["error"].toObject();
+      finish(request, QJsonObject(),
+             err.contains("message") ? "API Error: " + err["message"].toString()
+                                     : "Ошибка сети: " + reply->errorString());
+      return;
+    }
+
+    if (stream && isEventStream(reply)) {
+      state->buffer += reply->readAll() + "\n";
+      consumeEvents(request, *state);
+      if (!state->error.isEmpty())
+        finish(request, QJsonObject(), "API Error: " + state->error);
+      else if (!state->sawData)
+        finish(request, QJsonObject(), "Неверный ответ от API");
+      else
+        finish(request, assembleMessage(*state));
+      return;
+    }
+
+    QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+    if (obj.contains("choices")) {
+      finish(request,
+             obj["choices"].toArray()[0].toObject()["message"].toObject());
+    } else if (obj.contains("error")) {
+      finish(request, QJsonObject(),
+             "API Error: " + obj["error"].toObject()["message"].toString());
+    } else {
+      finish(request, QJsonObject(), "Неверный ответ от API");
+    }
+  });
+}
+
+void OpenAIProvider::consumeEvents(CompletionRequest *request,
+                                   StreamState &state) {
+  int lineStart = 0;
+  int newline;
+  while ((newline = state.buffer.indexOf('\n', lineStart)) >= 0) {
+    QByteArray line = state.buffer.mid(lineStart, newline - lineStart)
+                          .trimmed();
+    lineStart = newline + 1;
+    // Blank separators and ": keep-alive" comments carry no data
+    if (!line.startsWith("data:") || state.done)
+      continue;
+    QByteArray data = line.mid(5).trimmed();
+    if (data == "[DONE]") {
+      state.done = true;
+      continue;
+    }
+
+    QJsonObject event = QJsonDocument::fromJson(data).object();
+    if (event.contains("error")) {
+      state.error = event["error"].toObject()["message"].toString();
+      continue;
+    }
+    state.sawData = true;
+    QJsonObject delta =
+        event["choices"].toArray()[0].toObject()["delta"].toObject();
+    bool hasPayload = false;
+    // The opening delta usually carries only the role and an empty string
+    QString content = delta["content"].toString();
+    if (!content.isEmpty()) {
+      state.content += content;
+      hasPayload = true;
+    }
+    for (const auto &v : delta["tool_calls"].toArray()) {
+      QJsonObject call = v.toObject();
+      int index = call["index"].toInt(state.toolCalls.size());
+      if (index < 0 || index > 1024)
+        continue;
+      while (state.toolCalls.size() <= index)
+        state.toolCalls.append(StreamState::ToolCall());
+      auto &target = state.toolCalls[index];
+      if (call.contains("id"))
+        target.id = call["id"].toString();
+      QJsonObject function = call["function"].toObject();
+      target.name += function["name"].toString();
+      target.arguments += function["arguments"].toString();
+      hasPayload = true;
+    }
+    if (hasPayload)
+      markFirstChunk(request);
+  }
+  state.buffer.remove(0, lineStart);
+}
+
+QJsonObject OpenAIProvider::assembleMessage(const StreamState &state) {
+  QJsonObject message;
+  message["role"] = "assistant";
+  message["content"] = state.content;
+  if (!state.toolCalls.isEmpty()) {
+    QJsonArray calls;
+    for (const auto &c : state.toolCalls) {
+      calls.append(QJsonObject{
+          {"id", c.id},
+          {"type", "function"},
+          {"function",
+           QJsonObject{{"name", c.name}, {"arguments", c.arguments}}}});
+    }
+    message["tool_calls"] = calls;
+  }
+  return message;
+}
+
+} // namespace DevPlanner
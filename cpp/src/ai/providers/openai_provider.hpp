@@ -0,0 +1,34 @@
+#ifndef OPENAI_PROVIDER_HPP
+#define OPENAI_PROVIDER_HPP
+
+#include "ai_provider.hpp"
+#include <QNetworkAccessManager>
+
+namespace DevPlanner {
+
+// Any OpenAI-compatible chat/completions endpoint: OpenRouter, llama.cpp
+// server, vLLM, ... Options:
+//   stream - request SSE ("stream": true); the first chunk is then the first
+//            content or tool-call delta instead of the whole body
+class OpenAIProvider : public AIProvider {
+  Q_OBJECT
+
+public:
+  explicit OpenAIProvider(const ProviderConfig &config,
+                          QObject *parent = nullptr);
+
+protected:
+  void start(CompletionRequest *request) override;
+
+private:
+  struct StreamState;
+  // Consumes the complete "data:" lines in the buffer
+  void consumeEvents(CompletionRequest *request, StreamState &state);
+  static QJsonObject assembleMessage(const StreamState &state);
+
+  QNetworkAccessManager *m_network;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,116 @@
+#include "provider_registry.hpp"
+#include "../../core/config.hpp"
+#include "../../core/storage.hpp"
+#include "mock_provider.hpp"
+#include "openai_provider.hpp"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace DevPlanner {
+
+ProviderRegistry::ProviderRegistry(QObject *parent) : QObject(parent) {}
+
+QList<ProviderConfig> ProviderRegistry::defaultConfigs() {
+  ProviderConfig openRouter;
+  openRouter.id = "openrouter";
+  openRouter.name = "OpenRouter";
+  openRouter.baseUrl = "https://openrouter.ai/api/v1";
+  openRouter.auth = "bearer";
+  openRouter.maxConcurrent = 4;
+
+  ProviderConfig local;
+  local.id = "local";
+  local.name = "Local";
+  local.baseUrl = "http://127.0.0.1:8080/v1";
+  local.auth = "none";
+  local.maxConcurrent = 1;
+  local.models = {"local-model"};
+
+  ProviderConfig mock;
+  mock.id = "mock";
+  mock.name = "Mock";
+  mock.type = "mock";
+  mock.auth = "none";
+  mock.maxConcurrent = 8;
+  mock.models = {"mock"};
+
+  return {openRouter, local, mock};
+}
+
+void ProviderRegistry::load() {
+  qDeleteAll(m_providers);
+  m_providers.clear();
+
+  QList<ProviderConfig> configs;
+  QFile file(getProvidersFile());
+  if (file.open(QIODevice::ReadOnly)) {
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+    for (const auto &v : doc.object()["providers"].toArray()) {
+      ProviderConfig c = ProviderConfig::fromJson(v.toObject());
+      if (!c.id.isEmpty())
+        configs.append(c);
+    }
+  }
+  bool writeDefaults = configs.isEmpty();
+  if (writeDefaults)
+    configs = defaultConfigs();
+
+  for (auto &c : configs) {
+    // OpenRouter key and model list keep living in their own files
+    if (c.id == "openrouter") {
+      if (c.apiKey.isEmpty())
+        c.apiKey = Storage::loadApiKey();
+      if (c.models.isEmpty()) {
+        QString selected;
+        c.models = Storage::loadModels(selected);
+      }
+    }
+    addProvider(c);
+  }
+
+  if (writeDefaults)
+    save();
+}
+
+void ProviderRegistry::save() const {
+  QJsonArray arr;
+  for (const auto *p : m_providers) {
+    ProviderConfig c = p->config();
+    if (c.id == "openrouter") {
+      c.apiKey.clear();
+      c.models.clear();
+    }
+    arr.append(c.toJson());
+  }
+  QJsonObject obj;
+  obj["providers"] = arr;
+
+  Storage::ensureDataDir();
+  QFile file(getProvidersFile());
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Indented));
+    file.close();
+  }
+}
+
+AIProvider *ProviderRegistry::provider(const QString &id) const {
+  for (auto *p : m_providers) {
+    if (p->id() == id)
+      return p;
+  }
+  return nullptr;
+}
+
+AIProvider *ProviderRegistry::addProvider(const ProviderConfig &config) {
+  AIProvider *p = nullptr;
+  if (config.type == "mock")
+    p = new MockProvider(config, this);
+  else
+    p = new OpenAIProvider(config, this);
+  m_providers.append(p);
+  return p;
+}
+
+} // namespace DevPlanner
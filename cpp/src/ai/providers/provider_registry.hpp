@@ -0,0 +1,33 @@
+#ifndef PROVIDER_REGISTRY_HPP
+#define PROVIDER_REGISTRY_HPP
+
+#include "ai_provider.hpp"
+#include <QList>
+#include <QObject>
+
+namespace DevPlanner {
+
+// Providers configured in providers.json. Written with defaults (OpenRouter,
+// a local OpenAI-compatible server and the mock) on first run.
+class ProviderRegistry : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ProviderRegistry(QObject *parent = nullptr);
+
+  void load();
+  void save() const;
+
+  AIProvider *provider(const QString &id) const;
+  const QList<AIProvider *> &providers() const { return m_providers; }
+  AIProvider *addProvider(const ProviderConfig &config);
+
+  static QList<ProviderConfig> defaultConfigs();
+
+private:
+  QList<AIProvider *> m_providers;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,114 @@
+#include "request_queue.hpp"
+
+namespace DevPlanner {
+
+int RequestQueue::enqueue(const QString &text, bool mergeable) {
+  if (mergeable && !m_entries.isEmpty()) {
+    Entry &last = m_entries.last();
+    if (!last.local && last.state == State::Waiting) {
+      last.texts.append(text);
+      m_merged++;
+      return last.seq;
+    }
+  }
+
+  Entry entry;
+  entry.seq = m_nextSeq++;
+  entry.texts.append(text);
+  entry.enqueuedAt = QDateTime::currentMSecsSinceEpoch();
+  m_entries.append(entry);
+  return entry.seq;
+}
+
+int RequestQueue::enqueueLocal(const QString &text, const QJsonObject &action,
+                               const QString &badge) {
+  Entry entry;
+  entry.seq = m_nextSeq++;
+  entry.texts.append(text);
+  entry.local = true;
+  entry.state = State::Ready;
+  entry.reply = action;
+  entry.badge = badge;
+  entry.enqueuedAt = QDateTime::currentMSecsSinceEpoch();
+  m_entries.append(entry);
+  return entry.seq;
+}
+
+RequestQueue::Entry *RequestQueue::nextToDispatch(int maxInFlight) {
+  if (inFlight() >= maxInFlight)
+    return nullptr;
+  for (auto &entry : m_entries) {
+    if (entry.state == State::Waiting)
+      return &entry;
+  }
+  return nullptr;
+}
+
+void RequestQueue::markInFlight(int seq) {
+  if (Entry *entry = find(seq))
+    entry->state = State::InFlight;
+}
+
+void RequestQueue::resolve(int seq, const QJsonObject &reply,
+                           const QString &badge, const QString &error) {
+  Entry *entry = find(seq);
+  if (!entry)
+    return;
+  entry->state = State::Ready;
+  entry->reply = reply;
+  entry->badge = badge;
+  entry->error = error;
+  if (!entry->local) {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    m_completions.append(now);
+    pruneCompletions(now);
+  }
+}
+
+bool RequestQueue::takeNextReady(Entry *entry) {
+  if (m_entries.isEmpty() || m_entries.first().state != State::Ready)
+    return false;
+  *entry = m_entries.takeFirst();
+  return true;
+}
+
+RequestQueue::Entry *RequestQueue::find(int seq) {
+  for (auto &entry : m_entries) {
+    if (entry.seq == seq)
+      return &entry;
+  }
+  return nullptr;
+}
+
+QStringList RequestQueue::pendingTextsBefore(int seq) const {
+  QStringList texts;
+  for (const auto &entry : m_entries) {
+    if (entry.seq >= seq)
+      break;
+    texts.append(entry.text());
+  }
+  return texts;
+}
+
+void RequestQueue::clear() { m_entries.clear(); }
+
+int RequestQueue::completedLastMinute() const {
+  pruneCompletions(QDateTime::currentMSecsSinceEpoch());
+  return m_completions.size();
+}
+
+int RequestQueue::countState(State state) const {
+  int n = 0;
+  for (const auto &entry : m_entries) {
+    if (entry.state == state)
+      n++;
+  }
+  return n;
+}
+
+void RequestQueue::pruneCompletions(qint64 now) const {
+  while (!m_completions.isEmpty() && now - m_completions.first() > 60000)
+    m_completions.removeFirst();
+}
+
+} // namespace DevPlanner
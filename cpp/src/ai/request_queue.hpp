@@ -0,0 +1,75 @@
+#ifndef REQUEST_QUEUE_HPP
+#define REQUEST_QUEUE_HPP
+
+#include <QDateTime>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+namespace DevPlanner {
+
+// Ordered chat requests. Entries may be answered out of order but are
+// released strictly by sequence number, so the canvas sees their actions in
+// the order the user typed them.
+class RequestQueue {
+public:
+  enum class State { Waiting, InFlight, Ready };
+
+  struct Entry {
+    int seq = 0;
+    QStringList texts; // more than one when follow-ups were merged
+    bool local = false;
+    State state = State::Waiting;
+    QJsonObject reply; // assistant message, or the action for local entries
+    QString badge;
+    QString error;
+    QString sentContent; // user message as sent, with the tasks context
+    qint64 enqueuedAt = 0;
+
+    QString text() const { return texts.join("\n"); }
+  };
+
+  // Merges into the last entry when it is a waiting model request, so
+  // follow-ups typed while the pipeline is full share one round trip.
+  // Returns the sequence number the text ended up in.
+  int enqueue(const QString &text, bool mergeable = true);
+  int enqueueLocal(const QString &text, const QJsonObject &action,
+                   const QString &badge);
+
+  // First waiting entry, or nullptr when none is allowed to start
+  Entry *nextToDispatch(int maxInFlight);
+  void markInFlight(int seq);
+  void resolve(int seq, const QJsonObject &reply, const QString &badge,
+               const QString &error = QString());
+
+  // Removes the head entry if it is ready
+  bool takeNextReady(Entry *entry);
+
+  Entry *find(int seq);
+  // Texts of entries before seq that are still unanswered
+  QStringList pendingTextsBefore(int seq) const;
+
+  void clear();
+  bool isEmpty() const { return m_entries.isEmpty(); }
+  int waiting() const { return countState(State::Waiting); }
+  int inFlight() const { return countState(State::InFlight); }
+  int size() const { return m_entries.size(); }
+
+  // Requests completed during the last minute
+  int completedLastMinute() const;
+  int mergedCount() const { return m_merged; }
+
+private:
+  int countState(State state) const;
+  void pruneCompletions(qint64 now) const;
+
+  QList<Entry> m_entries;
+  int m_nextSeq = 1;
+  int m_merged = 0;
+  mutable QList<qint64> m_completions;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,172 @@
+#include "task_context.hpp"
+#include <QRegularExpression>
+#include <QStringList>
+
+namespace DevPlanner {
+
+void TaskContext::setTasks(const QList<TaskSnapshot> &tasks,
+                           const QList<QPair<int, int>> &connections) {
+  m_tasks = tasks;
+
+  QHash<quint64, QVector<int>> positions;
+  positions.reserve(tasks.size());
+  for (int i = 0; i < tasks.size(); ++i) {
+    QString text = tasks[i].title + "\n" + tasks[i].description;
+    quint64 key = qHash(text, 0x7a5c);
+    if (!m_index.contains(key)) {
+      // Title words count twice
+      m_index.setDocument(key, tasks[i].title + "\n" + text);
+    }
+    positions[key].append(i);
+  }
+  for (auto it = m_positions.constBegin(); it != m_positions.constEnd(); ++it) {
+    if (!positions.contains(it.key()))
+      m_index.removeDocument(it.key());
+  }
+  m_positions = positions;
+
+  m_successors = QVector<QVector<int>>(tasks.size());
+  m_predecessors = QVector<QVector<int>>(tasks.size());
+  for (const auto &c : connections) {
+    if (c.first < 0 || c.second < 0 || c.first >= tasks.size() ||
+        c.second >= tasks.size())
+      continue;
+    m_successors[c.first].append(c.second);
+    m_predecessors[c.second].append(c.first);
+  }
+
+  m_graph.clear();
+  m_reach.clear();
+  m_graph.beginBulk();
+  for (const auto &t : m_tasks)
+    m_graph.addNode(t.status == "done" || t.status == "cancelled" ? 0 : 1);
+  for (int i = 0; i < m_successors.size(); ++i) {
+    for (int s : m_successors[i])
+      m_graph.addEdge(i, s);
+  }
+  m_graph.endBulk();
+  m_dependencySummary = summarizeDependencies();
+}
+
+QString TaskContext::summarizeDependencies() {
+  TaskGraph &graph = m_graph;
+
+  auto numbers = [](const std::vector<int> &ids) {
+    // Long chains keep their ends; the middle is what the model needs least
+    constexpr int KEEP = 12;
+    QStringList out;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      if (ids.size() > 2 * KEEP && i == KEEP)
+        out.append("…");
+      if (ids.size() > 2 * KEEP && i >= KEEP && i < ids.size() - KEEP)
+        continue;
+      out.append(QString::number(ids[i] + 1));
+    }
+    return out.join(" → ");
+  };
+  QStringList lines;
+  std::vector<int> path = graph.criticalPath();
+  if (path.size() > 1) {
+    lines.append(QString("Критический путь (%1 незавершённых задач): %2")
+                     .arg(graph.criticalLength())
+                     .arg(numbers(path)));
+  }
+  if (graph.hasCycles()) {
+    constexpr int MAX_CYCLES = 20;
+    QStringList cycles;
+    for (const auto &e : graph.cycleEdges()) {
+      if (cycles.size() == MAX_CYCLES) {
+        cycles.append("…");
+        break;
+      }
+      cycles.append(QString("%1 → %2").arg(e.first + 1).arg(e.second + 1));
+    }
+    lines.append("Связи, замыкающие цикл: " + cycles.join(", "));
+  }
+  return lines.join("\n");
+}
+
+QString TaskContext::describeTask(int idx) const {
+  const TaskSnapshot &t = m_tasks[idx];
+  QString line = QString("%1. [%2] %3").arg(idx + 1).arg(t.status, t.title);
+  if (!t.description.isEmpty()) {
+    QString desc = t.description.simplified();
+    if (desc.size() > 120)
+      desc = desc.left(117) + "...";
+    line += " — " + desc;
+  }
+  auto numbers = [](const QVector<int> &list) {
+    QStringList out;
+    for (int n : list)
+      out.append(QString::number(n + 1));
+    return out.join(", ");
+  };
+  if (!m_predecessors[idx].isEmpty())
+    line += " | после: " + numbers(m_predecessors[idx]);
+  if (!m_successors[idx].isEmpty())
+    line += " | перед: " + numbers(m_successors[idx]);
+  return line;
+}
+
+QString TaskContext::build(const QString &query) const {
+  if (m_tasks.isEmpty())
+    return m_info;
+
+  QStringList lines;
+  if (!m_dependencySummary.isEmpty())
+    lines.append(m_dependencySummary);
+  if (m_tasks.size() <= FULL_CONTEXT_TASKS) {
+    for (int i = 0; i < m_tasks.size(); ++i)
+      lines.append(describeTask(i));
+    return lines.join("\n");
+  }
+
+  QVector<bool> picked(m_tasks.size(), false);
+  QVector<int> seeds;
+  auto pick = [&picked](int idx, QVector<int> *into) {
+    if (picked[idx])
+      return;
+    picked[idx] = true;
+    if (into)
+      into->append(idx);
+  };
+
+  // Numbers in the query ("move 12 after 40") are always relevant
+  static const QRegularExpression number(R"(\b(\d{1,6})\b)");
+  auto it = number.globalMatch(query);
+  while (it.hasNext()) {
+    int idx = it.next().captured(1).toInt() - 1;
+    if (idx >= 0 && idx < m_tasks.size())
+      pick(idx, &seeds);
+  }
+  for (const auto &hit : m_index.search(query, RETRIEVAL_TOP_K)) {
+    for (int idx : m_positions.value(hit.key))
+      pick(idx, &seeds);
+  }
+  for (int idx : seeds) {
+    for (const auto *list : {&m_predecessors[idx], &m_successors[idx]}) {
+      for (int i = 0; i < list->size() && i < MAX_NEIGHBOURS; ++i)
+        pick(list->at(i), nullptr);
+    }
+  }
+
+  lines.append(QString("Всего задач: %1, ниже только связанные с запросом")
+                   .arg(m_tasks.size()));
+  for (int i = 0; i < m_tasks.size(); ++i) {
+    if (picked[i])
+      lines.append(describeTask(i));
+  }
+  return lines.join("\n");
+}
+
+QList<int> TaskContext::reachable(int idx, bool downstream) {
+  QList<int> tasks;
+  if (idx < 0 || idx >= m_graph.nodeCount())
+    return tasks;
+  const SparseBitset &cone =
+      downstream ? m_reach.descendants(idx) : m_reach.ancestors(idx);
+  cone.forEach([&tasks](int id) { tasks.append(id); });
+  return tasks;
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,65 @@
+#ifndef TASK_CONTEXT_HPP
+#define TASK_CONTEXT_HPP
+
+#include "graph/reachability_index.hpp"
+#include "graph/task_graph.hpp"
+#include "task_index.hpp"
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+namespace DevPlanner {
+
+struct TaskSnapshot {
+  QString title;
+  QString description;
+  QString status;
+};
+
+// Board state as the model sees it: the text sent with each request and
+// the dependency graph behind it. Widget-free, so the replay bench builds
+// the same context as the chat panel.
+class TaskContext {
+public:
+  // Boards up to this size are sent whole
+  static constexpr int FULL_CONTEXT_TASKS = 50;
+  static constexpr int RETRIEVAL_TOP_K = 12;
+  static constexpr int MAX_NEIGHBOURS = 4;
+
+  // Free text used while no snapshot was given
+  void setInfo(const QString &info) { m_info = info; }
+  // Connections are 0-based task indices
+  void setTasks(const QList<TaskSnapshot> &tasks,
+                const QList<QPair<int, int>> &connections);
+  int size() const { return m_tasks.size(); }
+
+  // Only tasks relevant to the query (and their neighbours) are described
+  // once the board outgrows FULL_CONTEXT_TASKS
+  QString build(const QString &query) const;
+  // Critical path and cycles of the board, one line each
+  const QString &dependencySummary() const { return m_dependencySummary; }
+  // Tasks depending on idx (downstream) or that it depends on
+  QList<int> reachable(int idx, bool downstream);
+
+private:
+  QString summarizeDependencies();
+  QString describeTask(int idx) const;
+
+  QString m_info;
+  QList<TaskSnapshot> m_tasks;
+  QVector<QVector<int>> m_successors;
+  QVector<QVector<int>> m_predecessors;
+  TaskGraph m_graph;
+  ReachabilityIndex m_reach{m_graph};
+  QString m_dependencySummary;
+  // Documents are keyed by content, so renumbering after a delete does not
+  // touch the index
+  TaskIndex m_index;
+  QHash<quint64, QVector<int>> m_positions;
+};
+
+} // namespace DevPlanner
+
+#endif
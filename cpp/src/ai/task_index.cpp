@@ -0,0 +1,174 @@
+#include "task_index.hpp"
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+namespace DevPlanner {
+
+namespace {
+
+constexpr float K1 = 1.2f;
+constexpr float B = 0.75f;
+constexpr int STEM_LENGTH = 6;
+
+const QSet<QString> &stopWords() {
+  static const QSet<QString> WORDS = {
+      "the", "and", "for", "with", "to", "of", "in", "on", "a", "an", "is",
+      "it", "be", "и", "в", "на", "с", "по", "для", "не", "к", "из", "что",
+      "как", "это", "все", "от", "до", "за", "у", "о", "а", "или"};
+  return WORDS;
+}
+
+} // namespace
+
+QStringList TaskIndex::tokenize(const QString &text) {
+  QStringList tokens;
+  QString word;
+  auto flush = [&tokens, &word]() {
+    if (!word.isEmpty() && !stopWords().contains(word)) {
+      bool digits = word.at(0).isDigit();
+      if (digits || word.size() > 1)
+        tokens.append(digits ? word : word.left(STEM_LENGTH));
+    }
+    word.clear();
+  };
+  for (QChar c : text) {
+    if (c.isLetterOrNumber()) {
+      c = c.toLower();
+      word.append(c == QChar(0x0451) ? QChar(0x0435) : c); // ё -> е
+    } else {
+      flush();
+    }
+  }
+  flush();
+  return tokens;
+}
+
+void TaskIndex::setDocument(quint64 key, const QString &text) {
+  removeDocument(key);
+
+  QHash<QString, int> tf;
+  int length = 0;
+  for (const auto &token : tokenize(text)) {
+    tf[token]++;
+    length++;
+  }
+
+  int slot = m_docs.size();
+  Doc doc;
+  doc.key = key;
+  doc.length = length;
+  doc.live = true;
+  m_docs.append(doc);
+  m_slotOf.insert(key, slot);
+  m_totalLength += length;
+  for (auto it = tf.constBegin(); it != tf.constEnd(); ++it)
+    m_postings[it.key()].append({slot, it.value()});
+}
+
+void TaskIndex::removeDocument(quint64 key) {
+  auto it = m_slotOf.find(key);
+  if (it == m_slotOf.end())
+    return;
+  Doc &doc = m_docs[it.value()];
+  doc.live = false;
+  m_totalLength -= doc.length;
+  m_slotOf.erase(it);
+  m_dead++;
+  if (m_dead > 64 && m_dead > m_slotOf.size())
+    compact();
+}
+
+void TaskIndex::clear() {
+  m_postings.clear();
+  m_docs.clear();
+  m_slotOf.clear();
+  m_totalLength = 0;
+  m_dead = 0;
+}
+
+void TaskIndex::compact() {
+  QVector<int> remap(m_docs.size(), -1);
+  QVector<Doc> docs;
+  docs.reserve(m_slotOf.size());
+  for (int i = 0; i < m_docs.size(); ++i) {
+    if (!m_docs[i].live)
+      continue;
+    remap[i] = docs.size();
+    m_slotOf[m_docs[i].key] = docs.size();
+    docs.append(m_docs[i]);
+  }
+  m_docs = docs;
+
+  for (auto it = m_postings.begin(); it != m_postings.end();) {
+    QVector<Posting> &list = it.value();
+    int out = 0;
+    for (const auto &p : list) {
+      if (remap[p.slot] >= 0)
+        list[out++] = {remap[p.slot], p.tf};
+    }
+    list.resize(out);
+    if (list.isEmpty())
+      it = m_postings.erase(it);
+    else
+      ++it;
+  }
+  m_dead = 0;
+}
+
+QVector<TaskIndex::Hit> TaskIndex::search(const QString &query, int k) const {
+  QVector<Hit> hits;
+  int live = m_slotOf.size();
+  if (live == 0 || k <= 0)
+    return hits;
+
+  QStringList terms = tokenize(query);
+  terms.removeDuplicates();
+  if (terms.isEmpty())
+    return hits;
+
+  if (m_scores.size() < m_docs.size())
+    m_scores.resize(m_docs.size());
+  m_touched.clear();
+  float avgLength = float(m_totalLength) / live;
+  if (avgLength <= 0)
+    avgLength = 1;
+
+  for (const auto &term : terms) {
+    auto it = m_postings.constFind(term);
+    if (it == m_postings.constEnd())
+      continue;
+    const QVector<Posting> &list = it.value();
+    // Tombstoned postings inflate df slightly until the next compaction
+    float df = float(list.size());
+    float idf = std::log(1.0f + (live - df + 0.5f) / (df + 0.5f));
+    if (idf <= 0)
+      idf = 0.01f;
+    for (const auto &p : list) {
+      const Doc &doc = m_docs[p.slot];
+      if (!doc.live)
+        continue;
+      float norm = K1 * (1 - B + B * doc.length / avgLength);
+      float score = idf * (p.tf * (K1 + 1)) / (p.tf + norm);
+      if (m_scores[p.slot] == 0)
+        m_touched.append(p.slot);
+      m_scores[p.slot] += score;
+    }
+  }
+
+  hits.reserve(m_touched.size());
+  for (int slot : m_touched) {
+    hits.append({m_docs[slot].key, m_scores[slot]});
+    m_scores[slot] = 0;
+  }
+  auto byScore = [](const Hit &a, const Hit &b) { return a.score > b.score; };
+  if (hits.size() > k) {
+    std::partial_sort(hits.begin(), hits.begin() + k, hits.end(), byScore);
+    hits.resize(k);
+  } else {
+    std::sort(hits.begin(), hits.end(), byScore);
+  }
+  return hits;
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,60 @@
+#ifndef TASK_INDEX_HPP
+#define TASK_INDEX_HPP
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace DevPlanner {
+
+// Incremental BM25 index over task texts. Documents are identified by a
+// caller-chosen key; replacing or removing one leaves a tombstone that is
+// compacted away once tombstones outnumber live documents.
+class TaskIndex {
+public:
+  struct Hit {
+    quint64 key;
+    float score;
+  };
+
+  void setDocument(quint64 key, const QString &text);
+  void removeDocument(quint64 key);
+  bool contains(quint64 key) const { return m_slotOf.contains(key); }
+  void clear();
+  int size() const { return m_slotOf.size(); }
+
+  // Best k documents for the query, highest score first
+  QVector<Hit> search(const QString &query, int k) const;
+
+  // Lowercased words with a crude truncation stem, shared by queries and
+  // documents so "задачи"/"задачу" and "tests"/"testing" meet
+  static QStringList tokenize(const QString &text);
+
+private:
+  struct Posting {
+    int slot;
+    int tf;
+  };
+  struct Doc {
+    quint64 key = 0;
+    int length = 0;
+    bool live = false;
+  };
+
+  void compact();
+
+  QHash<QString, QVector<Posting>> m_postings;
+  QVector<Doc> m_docs;
+  QHash<quint64, int> m_slotOf;
+  qint64 m_totalLength = 0;
+  int m_dead = 0;
+
+  // Scratch buffers reused across searches
+  mutable QVector<float> m_scores;
+  mutable QVector<int> m_touched;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -20,6 +20,8 @@ inline const QMap<QString, TaskStatus> &getStatuses() {
       {"done", {"#00ff9d", "Готово"}},
       {"progress", {"#ffcc00", "В процессе"}},
       {"todo", {"#ff0055", "Не сделано"}},
+      {"ready", {"#00c8ff", "Можно начинать"}},
+      {"blocked", {"#ff7a00", "Заблокировано"}},
       {"cancelled", {"#555555", "Отменено"}}};
   return STATUSES;
 }
@@ -38,6 +40,15 @@ inline QString getModelsFile() { return getDataDir() + "/models.json"; }
 
 inline QString getContextDir() { return getDataDir() + "/contexts"; }
 
+inline QString getProvidersFile() { return getDataDir() + "/providers.json"; }
+
+inline QString getSettingsFile() { return getDataDir() + "/settings.json"; }
+
+inline QString getCacheDir() { return getDataDir() + "/cache"; }
+
+// *.tiktoken vocabularies for BpeTokenizer
+inline QString getTokenizerDir() { return getDataDir() + "/tokenizers"; }
+
 // App version
 constexpr const char *APP_VERSION = "v2.0.0-cpp";
 
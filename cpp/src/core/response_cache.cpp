@@ -0,0 +1,230 @@
+#include "response_cache.hpp"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <algorithm>
+
+namespace DevPlanner {
+
+ResponseCache::ResponseCache(const QString &dir) : m_dir(dir) {
+  QDir d(m_dir);
+  if (!d.exists()) {
+    d.mkpath(".");
+  }
+  loadIndex();
+}
+
+ResponseCache::~ResponseCache() {
+  if (m_indexDirty) {
+    saveIndex();
+  }
+}
+
+QString ResponseCache::makeKey(const QString &model,
+                               const QJsonArray &messages) {
+  // Whitespace differences must not produce different keys
+  QJsonArray normalized;
+  for (const auto &m : messages) {
+    QJsonObject src = m.toObject();
+    QJsonObject msg;
+    msg["role"] = src["role"].toString();
+    msg["content"] = src["content"].toString().simplified();
+    if (src.contains("tool_calls"))
+      msg["tool_calls"] = src["tool_calls"];
+    if (src.contains("tool_call_id"))
+      msg["tool_call_id"] = src["tool_call_id"];
+    normalized.append(msg);
+  }
+
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  hash.addData(model.trimmed().toUtf8());
+  hash.addData(QByteArray("\n"));
+  hash.addData(QJsonDocument(normalized).toJson(QJsonDocument::Compact));
+  return QString::fromLatin1(hash.result().toHex());
+}
+
+bool ResponseCache::lookup(const QString &key, QJsonObject &reply) {
+  if (!m_enabled) {
+    return false;
+  }
+
+  auto it = m_entries.find(key);
+  qint64 now = QDateTime::currentSecsSinceEpoch();
+  if (it == m_entries.end() || isExpired(it.value(), now)) {
+    if (it != m_entries.end()) {
+      remove(key);
+      saveIndex();
+    }
+    m_misses++;
+    return false;
+  }
+
+  QFile file(entryPath(key));
+  if (!file.open(QIODevice::ReadOnly)) {
+    remove(key);
+    saveIndex();
+    m_misses++;
+    return false;
+  }
+  QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+  file.close();
+  if (!doc.isObject() || !doc.object()["reply"].isObject()) {
+    remove(key);
+    saveIndex();
+    m_misses++;
+    return false;
+  }
+
+  reply = doc.object()["reply"].toObject();
+  it.value().lastUsed = now;
+  m_indexDirty = true;
+  m_hits++;
+  return true;
+}
+
+void ResponseCache::store(const QString &key, const QJsonObject &reply) {
+  if (!m_enabled || key.isEmpty()) {
+    return;
+  }
+
+  qint64 now = QDateTime::currentSecsSinceEpoch();
+  QJsonObject obj;
+  obj["created"] = now;
+  obj["reply"] = reply;
+  QByteArray data = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+
+  QFile file(entryPath(key));
+  if (!file.open(QIODevice::WriteOnly)) {
+    return;
+  }
+  file.write(data);
+  file.close();
+
+  if (m_entries.contains(key)) {
+    m_totalBytes -= m_entries[key].size;
+  }
+  Entry entry;
+  entry.size = data.size();
+  entry.created = now;
+  entry.lastUsed = now;
+  m_entries[key] = entry;
+  m_totalBytes += entry.size;
+
+  evict();
+  saveIndex();
+}
+
+void ResponseCache::clear() {
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+    QFile::remove(entryPath(it.key()));
+  }
+  m_entries.clear();
+  m_totalBytes = 0;
+  saveIndex();
+}
+
+void ResponseCache::setMaxBytes(qint64 bytes) {
+  m_maxBytes = bytes;
+  evict();
+  if (m_indexDirty) {
+    saveIndex();
+  }
+}
+
+QString ResponseCache::entryPath(const QString &key) const {
+  return m_dir + "/" + key + ".json";
+}
+
+bool ResponseCache::isExpired(const Entry &entry, qint64 now) const {
+  return m_ttlSeconds > 0 && now - entry.created > m_ttlSeconds;
+}
+
+void ResponseCache::remove(const QString &key) {
+  auto it = m_entries.find(key);
+  if (it == m_entries.end()) {
+    return;
+  }
+  m_totalBytes -= it.value().size;
+  m_entries.erase(it);
+  QFile::remove(entryPath(key));
+  m_indexDirty = true;
+}
+
+void ResponseCache::evict() {
+  qint64 now = QDateTime::currentSecsSinceEpoch();
+  QStringList expired;
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+    if (isExpired(it.value(), now)) {
+      expired.append(it.key());
+    }
+  }
+  for (const auto &key : expired) {
+    remove(key);
+  }
+
+  if (m_totalBytes <= m_maxBytes) {
+    return;
+  }
+
+  // Least recently used first
+  QList<QPair<qint64, QString>> byAge;
+  byAge.reserve(m_entries.size());
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+    byAge.append(qMakePair(it.value().lastUsed, it.key()));
+  }
+  std::sort(byAge.begin(), byAge.end());
+  for (const auto &p : byAge) {
+    if (m_totalBytes <= m_maxBytes) {
+      break;
+    }
+    remove(p.second);
+  }
+}
+
+void ResponseCache::loadIndex() {
+  QFile file(m_dir + "/index.json");
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+  QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+  file.close();
+  if (!doc.isObject()) {
+    return;
+  }
+
+  QJsonObject index = doc.object();
+  for (auto it = index.begin(); it != index.end(); ++it) {
+    if (!QFile::exists(entryPath(it.key()))) {
+      m_indexDirty = true;
+      continue;
+    }
+    QJsonObject o = it.value().toObject();
+    Entry entry;
+    entry.size = static_cast<qint64>(o["size"].toDouble());
+    entry.created = static_cast<qint64>(o["created"].toDouble());
+    entry.lastUsed = static_cast<qint64>(o["used"].toDouble());
+    m_entries[it.key()] = entry;
+    m_totalBytes += entry.size;
+  }
+}
+
+void ResponseCache::saveIndex() {
+  QJsonObject index;
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+    QJsonObject o;
+    o["size"] = it.value().size;
+    o["created"] = it.value().created;
+    o["used"] = it.value().lastUsed;
+    index[it.key()] = o;
+  }
+  QFile file(m_dir + "/index.json");
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+    file.close();
+  }
+  m_indexDirty = false;
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,66 @@
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+
+namespace DevPlanner {
+
+// Content-addressed on-disk cache of AI replies.
+// Key = sha256(model + normalized messages), one file per entry plus an
+// index.json with sizes and access times for LRU eviction.
+class ResponseCache {
+public:
+  explicit ResponseCache(const QString &dir);
+  ~ResponseCache();
+
+  static QString makeKey(const QString &model, const QJsonArray &messages);
+
+  bool lookup(const QString &key, QJsonObject &reply);
+  void store(const QString &key, const QJsonObject &reply);
+  void clear();
+
+  // Settings
+  void setEnabled(bool enabled) { m_enabled = enabled; }
+  bool isEnabled() const { return m_enabled; }
+  void setMaxBytes(qint64 bytes);
+  qint64 maxBytes() const { return m_maxBytes; }
+  void setTtlSeconds(qint64 seconds) { m_ttlSeconds = seconds; }
+  qint64 ttlSeconds() const { return m_ttlSeconds; }
+
+  // Stats (current session)
+  int hits() const { return m_hits; }
+  int misses() const { return m_misses; }
+  int entryCount() const { return m_entries.size(); }
+  qint64 totalBytes() const { return m_totalBytes; }
+
+private:
+  struct Entry {
+    qint64 size = 0;
+    qint64 created = 0;
+    qint64 lastUsed = 0;
+  };
+
+  QString entryPath(const QString &key) const;
+  bool isExpired(const Entry &entry, qint64 now) const;
+  void remove(const QString &key);
+  void evict();
+  void loadIndex();
+  void saveIndex();
+
+  QString m_dir;
+  QHash<QString, Entry> m_entries;
+  qint64 m_totalBytes = 0;
+  qint64 m_maxBytes = 20 * 1024 * 1024;
+  qint64 m_ttlSeconds = 7 * 24 * 3600;
+  bool m_enabled = true;
+  bool m_indexDirty = false;
+  int m_hits = 0;
+  int m_misses = 0;
+};
+
+} // namespace DevPlanner
+
+#endif // RESPONSE_CACHE_HPP
@@ -2,7 +2,9 @@
 #include "config.hpp"
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
+#include <QtEndian>
 
 namespace DevPlanner {
 
@@ -109,36 +111,158 @@ void Storage::saveModels(const QStringList &models, const QString &selected) {
   }
 }
 
-QJsonArray Storage::loadContext(const QString &projectName) {
-  ensureDataDir();
-  QString path = getContextDir() + "/" + projectName + ".json";
-  QFile file(path);
+QJsonObject Storage::loadSettings() {
+  QFile file(getSettingsFile());
   if (file.open(QIODevice::ReadOnly)) {
-    QByteArray data = file.readAll();
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
     file.close();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isArray()) {
-      return doc.array();
+    if (doc.isObject()) {
+      return doc.object();
     }
   }
-  return QJsonArray();
+  return QJsonObject();
 }
 
-void Storage::saveContext(const QString &projectName,
-                          const QJsonArray &messages) {
+void Storage::saveSettings(const QJsonObject &settings) {
   ensureDataDir();
-  QString path = getContextDir() + "/" + projectName + ".json";
-  QFile file(path);
+  QFile file(getSettingsFile());
   if (file.open(QIODevice::WriteOnly)) {
-    // Keep only last 100 messages
-    QJsonArray toSave = messages;
-    while (toSave.size() > 100) {
-      toSave.removeFirst();
-    }
-    QJsonDocument doc(toSave);
-    file.write(doc.toJson(QJsonDocument::Indented));
+    file.write(QJsonDocument(settings).toJson(QJsonDocument::Indented));
     file.close();
   }
 }
 
+QString Storage::contextLogPath(const QString &projectName) {
+  return getContextDir() + "/" + projectName + ".jsonl";
+}
+
+QString Storage::contextIndexPath(const QString &projectName) {
+  return getContextDir() + "/" + projectName + ".idx";
+}
+
+namespace {
+
+QByteArray encodeOffset(qint64 offset) {
+  QByteArray bytes(sizeof(qint64), Qt::Uninitialized);
+  qToLittleEndian(offset, bytes.data());
+  return bytes;
+}
+
+} // namespace
+
+void Storage::prepareContext(const QString &projectName) {
+  ensureDataDir();
+  QString logPath = contextLogPath(projectName);
+  QString indexPath = contextIndexPath(projectName);
+
+  QString legacyPath = getContextDir() + "/" + projectName + ".json";
+  if (!QFile::exists(logPath) && QFile::exists(legacyPath)) {
+    QFile legacy(legacyPath);
+    if (legacy.open(QIODevice::ReadOnly)) {
+      QJsonArray messages = QJsonDocument::fromJson(legacy.readAll()).array();
+      legacy.close();
+      QFile log(logPath);
+      QFile index(indexPath);
+      if (log.open(QIODevice::WriteOnly) && index.open(QIODevice::WriteOnly)) {
+        for (const auto &m : messages) {
+          index.write(encodeOffset(log.pos()));
+          log.write(QJsonDocument(m.toObject()).toJson(QJsonDocument::Compact));
+          log.write("\n");
+        }
+        log.close();
+        index.close();
+        QFile::remove(legacyPath);
+      }
+    }
+  }
+
+  // A crash between the two appends leaves the index behind the log
+  QFileInfo logInfo(logPath);
+  QFileInfo indexInfo(indexPath);
+  if (!logInfo.exists())
+    return;
+  bool stale = !indexInfo.exists() || indexInfo.size() % sizeof(qint64) != 0;
+  if (!stale && indexInfo.size() > 0) {
+    QFile index(indexPath);
+    if (index.open(QIODevice::ReadOnly)) {
+      index.seek(indexInfo.size() - sizeof(qint64));
+      QByteArray bytes = index.read(sizeof(qint64));
+      qint64 last = qFromLittleEndian<qint64>(bytes.constData());
+      QFile log(logPath);
+      if (log.open(QIODevice::ReadOnly)) {
+        log.seek(last);
+        log.readLine();
+        stale = last >= logInfo.size() || !log.atEnd();
+      }
+    }
+  } else if (!stale) {
+    stale = logInfo.size() > 0;
+  }
+  if (!stale)
+    return;
+
+  QFile log(logPath);
+  QFile index(indexPath);
+  if (!log.open(QIODevice::ReadOnly) || !index.open(QIODevice::WriteOnly))
+    return;
+  while (!log.atEnd()) {
+    qint64 offset = log.pos();
+    if (!log.readLine().trimmed().isEmpty())
+      index.write(encodeOffset(offset));
+  }
+}
+
+void Storage::appendContext(const QString &projectName,
+                            const QJsonObject &message) {
+  prepareContext(projectName);
+  QFile log(contextLogPath(projectName));
+  QFile index(contextIndexPath(projectName));
+  if (!log.open(QIODevice::Append) || !index.open(QIODevice::Append))
+    return;
+  index.write(encodeOffset(log.size()));
+  log.write(QJsonDocument(message).toJson(QJsonDocument::Compact));
+  log.write("\n");
+}
+
+int Storage::contextSize(const QString &projectName) {
+  prepareContext(projectName);
+  QFileInfo indexInfo(contextIndexPath(projectName));
+  return indexInfo.exists() ? int(indexInfo.size() / sizeof(qint64)) : 0;
+}
+
+QJsonArray Storage::loadContextRange(const QString &projectName, int from,
+                                     int count) {
+  QJsonArray result;
+  int size = contextSize(projectName);
+  from = qMax(0, from);
+  count = qMin(count, size - from);
+  if (count <= 0)
+    return result;
+
+  QFile index(contextIndexPath(projectName));
+  QFile log(contextLogPath(projectName));
+  if (!index.open(QIODevice::ReadOnly) || !log.open(QIODevice::ReadOnly))
+    return result;
+  index.seek(qint64(from) * sizeof(qint64));
+  QByteArray offsets = index.read(qint64(count) * sizeof(qint64));
+  if (offsets.size() < int(sizeof(qint64)))
+    return result;
+
+  // Lines of a range are contiguous, so one seek is enough
+  log.seek(qFromLittleEndian<qint64>(offsets.constData()));
+  for (int i = 0; i < count && !log.atEnd(); ++i) {
+    QJsonDocument doc = QJsonDocument::fromJson(log.readLine());
+    if (doc.isObject())
+      result.append(doc.object());
+  }
+  return result;
+}
+
+void Storage::clearContext(const QString &projectName) {
+  ensureDataDir();
+  QFile::remove(contextLogPath(projectName));
+  QFile::remove(contextIndexPath(projectName));
+  QFile::remove(getContextDir() + "/" + projectName + ".json");
+}
+
 } // namespace DevPlanner
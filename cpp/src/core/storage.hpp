@@ -24,10 +24,24 @@ public:
   static QStringList loadModels(QString &selectedModel);
   static void saveModels(const QStringList &models, const QString &selected);
 
-  // Chat contexts
-  static QJsonArray loadContext(const QString &projectName);
-  static void saveContext(const QString &projectName,
-                          const QJsonArray &messages);
+  // App settings (settings.json)
+  static QJsonObject loadSettings();
+  static void saveSettings(const QJsonObject &settings);
+
+  // Chat contexts: append-only <project>.jsonl with a <project>.idx of
+  // 8-byte line offsets, so appends are O(1) and any range is one seek
+  static void appendContext(const QString &projectName,
+                            const QJsonObject &message);
+  static int contextSize(const QString &projectName);
+  static QJsonArray loadContextRange(const QString &projectName, int from,
+                                     int count);
+  static void clearContext(const QString &projectName);
+
+private:
+  static QString contextLogPath(const QString &projectName);
+  static QString contextIndexPath(const QString &projectName);
+  // Converts a legacy <project>.json and repairs a stale index
+  static void prepareContext(const QString &projectName);
 };
 
 } // namespace DevPlanner
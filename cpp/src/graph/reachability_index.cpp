@@ -0,0 +1,257 @@
+#include "reachability_index.hpp"
+#include <algorithm>
+#include <bitset>
+
+namespace DevPlanner {
+
+SparseBitset::SparseBitset(const std::vector<int> &ids) {
+  for (int id : ids) {
+    auto block = static_cast<std::uint32_t>(id / 64);
+    if (m_blocks.empty() || m_blocks.back() != block) {
+      m_blocks.push_back(block);
+      m_words.push_back(0);
+    }
+    m_words.back() |= std::uint64_t(1) << (id % 64);
+  }
+}
+
+bool SparseBitset::contains(int id) const {
+  auto block = static_cast<std::uint32_t>(id / 64);
+  auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), block);
+  if (it == m_blocks.end() || *it != block)
+    return false;
+  return (m_words[it - m_blocks.begin()] >> (id % 64)) & 1;
+}
+
+size_t SparseBitset::count() const {
+  size_t n = 0;
+  for (std::uint64_t w : m_words)
+    n += std::bitset<64>(w).count();
+  return n;
+}
+
+const SparseBitset &ReachabilityIndex::descendants(int id) {
+  return cone(id, true);
+}
+
+const SparseBitset &ReachabilityIndex::ancestors(int id) {
+  return cone(id, false);
+}
+
+void ReachabilityIndex::flatten() {
+  const int n = m_graph.nodeCount();
+  const auto &cycles = m_graph.cycleEdges();
+  Adjacency &down = m_downAdj, &up = m_upAdj;
+
+  // Successors with the cycle-closing edges after them: counts, offsets,
+  // then the ids, with m_stack as the fill position per node
+  down.first.assign(n + 1, 0);
+  for (const auto &e : cycles)
+    ++down.first[e.first + 1];
+  for (int v = 0; v < n; ++v) {
+    down.first[v + 1] +=
+        down.first[v] + static_cast<int>(m_graph.successors(v).size());
+  }
+  down.next.resize(down.first[n]);
+  m_stack.resize(n);
+  for (int v = 0; v < n; ++v) {
+    const auto &out = m_graph.successors(v);
+    std::copy(out.begin(), out.end(), down.next.begin() + down.first[v]);
+    m_stack[v] = down.first[v] + static_cast<int>(out.size());
+  }
+  for (const auto &e : cycles)
+    down.next[m_stack[e.first]++] = e.second;
+
+  // Predecessors as its transpose, without going back to the graph
+  up.first.assign(n + 1, 0);
+  for (int w : down.next)
+    ++up.first[w + 1];
+  for (int v = 0; v < n; ++v)
+    up.first[v + 1] += up.first[v];
+  up.next.resize(down.next.size());
+  std::copy(up.first.begin(), up.first.end() - 1, m_stack.begin());
+  for (int v = 0; v < n; ++v) {
+    for (int e = down.first[v]; e < down.first[v + 1]; ++e)
+      up.next[m_stack[down.next[e]]++] = v;
+  }
+  m_flat = true;
+}
+
+void ReachabilityIndex::collectCycleEdges() {
+  m_cycleSucc.clear();
+  m_cyclePred.clear();
+  for (const auto &e : m_graph.cycleEdges()) {
+    m_cycleSucc.emplace(e.first, e.second);
+    m_cyclePred.emplace(e.second, e.first);
+  }
+}
+
+const SparseBitset &ReachabilityIndex::cone(int id, bool down) {
+  Cache &cache = down ? m_down : m_up;
+  auto cached = cache.find(id);
+  if (cached != cache.end())
+    return cached->second;
+
+  const auto n = static_cast<size_t>(m_graph.nodeCount());
+  if (m_bits.size() < (n + 63) / 64)
+    m_bits.resize((n + 63) / 64, 0);
+  std::vector<char> &inCache = down ? m_downCached : m_upCached;
+  if (inCache.size() < n)
+    inCache.resize(n, 0);
+  // Nodes can be added without an edit being reported
+  if (!m_flat || m_downAdj.first.size() != n + 1)
+    flatten();
+  const Adjacency &adj = down ? m_downAdj : m_upAdj;
+
+  // The search marks straight into a dense bitset, which is also the
+  // result: a known cone is merged a word at a time, and the words are
+  // handed over without sorting the ids
+  m_touched.clear();
+  auto mark = [this](size_t word, std::uint64_t bits) {
+    if (m_bits[word] == 0)
+      m_touched.push_back(static_cast<std::uint32_t>(word));
+    m_bits[word] |= bits;
+  };
+  m_stack.assign(1, id);
+  mark(id / 64, std::uint64_t(1) << (id % 64));
+  auto reach = [&](int w) {
+    const std::uint64_t bit = std::uint64_t(1) << (w % 64);
+    if (m_bits[w / 64] & bit)
+      return;
+    mark(w / 64, bit);
+    if (!inCache[w]) {
+      m_stack.push_back(w);
+      return;
+    }
+    // A node whose cone is already known contributes it whole instead of
+    // being searched through again
+    const SparseBitset &known = cache.find(w)->second;
+    for (size_t i = 0; i < known.m_words.size(); ++i)
+      mark(known.m_blocks[i], known.m_words[i]);
+  };
+  while (!m_stack.empty()) {
+    int v = m_stack.back();
+    m_stack.pop_back();
+    for (int e = adj.first[v]; e < adj.first[v + 1]; ++e)
+      reach(adj.next[e]);
+  }
+
+  std::sort(m_touched.begin(), m_touched.end());
+  SparseBitset result;
+  result.m_blocks.reserve(m_touched.size());
+  result.m_words.reserve(m_touched.size());
+  m_bits[id / 64] &= ~(std::uint64_t(1) << (id % 64));
+  for (std::uint32_t word : m_touched) {
+    if (m_bits[word]) {
+      result.m_blocks.push_back(word);
+      result.m_words.push_back(m_bits[word]);
+    }
+    m_bits[word] = 0;
+  }
+
+  size_t &words = down ? m_downWords : m_upWords;
+  if (words + result.words() > MAX_CACHED_WORDS) {
+    cache.clear();
+    std::fill(inCache.begin(), inCache.end(), 0);
+    words = 0;
+  }
+  words += result.words();
+  inCache[id] = 1;
+  return cache.emplace(id, std::move(result)).first->second;
+}
+
+bool ReachabilityIndex::reaches(int from, int to) {
+  auto down = m_down.find(from);
+  if (down != m_down.end())
+    return down->second.contains(to);
+  auto up = m_up.find(to);
+  if (up != m_up.end())
+    return up->second.contains(from);
+
+  // Without cycles, nothing placed after to in the topological order can
+  // lead to it, so the search never leaves the part of the order before it
+  bool pruned = !m_graph.hasCycles();
+  collectCycleEdges();
+  if (m_mark.size() < static_cast<size_t>(m_graph.nodeCount()))
+    m_mark.resize(m_graph.nodeCount(), 0);
+  ++m_markValue;
+  m_stack.assign(1, from);
+  m_mark[from] = m_markValue;
+  auto reach = [&](int w) {
+    if (m_mark[w] == m_markValue || (pruned && !m_graph.precedes(w, to) &&
+                                      w != to))
+      return false;
+    m_mark[w] = m_markValue;
+    m_stack.push_back(w);
+    return w == to;
+  };
+  while (!m_stack.empty()) {
+    int n = m_stack.back();
+    m_stack.pop_back();
+    for (int w : m_graph.successors(n)) {
+      if (reach(w))
+        return true;
+    }
+    auto range = m_cycleSucc.equal_range(n);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (reach(it->second))
+        return true;
+    }
+  }
+  return false;
+}
+
+void ReachabilityIndex::invalidate(int from, int to) {
+  m_flat = false;
+  // Only cones that reach from (downwards) or are reached from to
+  // (upwards) can see the edge
+  for (auto it = m_down.begin(); it != m_down.end();) {
+    if (it->first == from || it->second.contains(from)) {
+      m_downWords -= it->second.words();
+      m_downCached[it->first] = 0;
+      it = m_down.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = m_up.begin(); it != m_up.end();) {
+    if (it->first == to || it->second.contains(to)) {
+      m_upWords -= it->second.words();
+      m_upCached[it->first] = 0;
+      it = m_up.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ReachabilityIndex::nodeRemoved(int id) {
+  m_flat = false;
+  for (auto *cache : {&m_down, &m_up}) {
+    size_t &words = cache == &m_down ? m_downWords : m_upWords;
+    auto &inCache = cache == &m_down ? m_downCached : m_upCached;
+    for (auto it = cache->begin(); it != cache->end();) {
+      if (it->first == id || it->second.contains(id)) {
+        words -= it->second.words();
+        inCache[it->first] = 0;
+        it = cache->erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+void ReachabilityIndex::clear() {
+  m_down.clear();
+  m_up.clear();
+  m_downCached.clear();
+  m_upCached.clear();
+  m_flat = false;
+  m_downWords = 0;
+  m_upWords = 0;
+  m_mark.clear();
+  m_markValue = 0;
+}
+
+} // namespace DevPlanner
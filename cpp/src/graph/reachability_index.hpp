@@ -0,0 +1,105 @@
+#ifndef REACHABILITY_INDEX_HPP
+#define REACHABILITY_INDEX_HPP
+
+#include "task_graph.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace DevPlanner {
+
+// Set of node ids stored as the non-zero 64-bit words of a bitset, each
+// with its word number. Cones are usually small and clustered, so this
+// costs a fraction of a dense bitset on large boards.
+class SparseBitset {
+public:
+  SparseBitset() = default;
+  // ids must be sorted and unique
+  explicit SparseBitset(const std::vector<int> &ids);
+
+  bool contains(int id) const;
+  bool isEmpty() const { return m_words.empty(); }
+  size_t count() const;
+  size_t words() const { return m_words.size(); }
+
+  template <typename F> void forEach(F f) const {
+    for (size_t i = 0; i < m_words.size(); ++i) {
+      int base = static_cast<int>(m_blocks[i]) * 64;
+      for (std::uint64_t w = m_words[i]; w; w >>= 1, ++base) {
+        if (w & 1)
+          f(base);
+      }
+    }
+  }
+
+private:
+  friend class ReachabilityIndex;
+
+  std::vector<std::uint32_t> m_blocks;
+  std::vector<std::uint64_t> m_words;
+};
+
+// Transitive "blocks" / "blocked by" queries over a TaskGraph, including
+// the connections it keeps aside as cycle-closing. Cones are computed on
+// demand by a search that reuses every cone already cached below (or
+// above) it, and cached until an edit can change them: an edge u -> v
+// only affects the descendant cones that contain u and the ancestor cones
+// that contain v, so every other entry survives the edit.
+class ReachabilityIndex {
+public:
+  explicit ReachabilityIndex(const TaskGraph &graph) : m_graph(graph) {}
+
+  // Everything id transitively blocks / is blocked by, without id itself.
+  // The reference stays valid until the next edit or the next query in the
+  // same direction.
+  const SparseBitset &descendants(int id);
+  const SparseBitset &ancestors(int id);
+  bool reaches(int from, int to);
+
+  // Call after the graph changed
+  void edgeAdded(int from, int to) { invalidate(from, to); }
+  void edgeRemoved(int from, int to) { invalidate(from, to); }
+  void nodeRemoved(int id);
+  void clear();
+
+private:
+  using Cache = std::unordered_map<int, SparseBitset>;
+
+  // Edges of one direction, cycle-closing ones included, as one array
+  // with offsets per node; the searches touch far fewer cache lines than
+  // through the graph's per-node vectors
+  struct Adjacency {
+    std::vector<int> first; // node -> start in next, plus an end mark
+    std::vector<int> next;
+  };
+
+  const SparseBitset &cone(int id, bool down);
+  // Builds both adjacencies; done on the first search after an edit
+  void flatten();
+  void collectCycleEdges();
+  void invalidate(int from, int to);
+
+  // Cached words per direction before the cache starts over
+  static constexpr size_t MAX_CACHED_WORDS = 1 << 20;
+
+  const TaskGraph &m_graph;
+  Cache m_down, m_up;
+  size_t m_downWords = 0, m_upWords = 0;
+  // Ids with a cached cone, so the search skips the lookup for the rest
+  std::vector<char> m_downCached, m_upCached;
+  Adjacency m_downAdj, m_upAdj;
+  bool m_flat = false;
+
+  // Scratch state reused across queries; m_bits is all zero in between
+  std::vector<int> m_mark;
+  int m_markValue = 0;
+  std::vector<int> m_stack;
+  std::vector<std::uint64_t> m_bits;
+  std::vector<std::uint32_t> m_touched;
+  std::unordered_multimap<int, int> m_cycleSucc, m_cyclePred;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,266 @@
+#include "schedule_simulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace DevPlanner {
+
+namespace {
+
+// Runs handed to a thread at a time; small enough to balance the threads,
+// large enough that taking one is rare
+constexpr int BLOCKS_PER_CHUNK = 16;
+
+// 24 random bits to [0, 1)
+constexpr float UNIT = 1.0f / 16777216.0f;
+
+std::uint64_t splitMix(std::uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// Scratch rows of one thread
+struct Lanes {
+  explicit Lanes(int tasks)
+      : start(static_cast<size_t>(tasks) * ScheduleSimulator::LANES),
+        finish(start.size()), critical(tasks, 0) {}
+
+  std::vector<float> start, finish; // position * LANES + lane
+  std::vector<int> critical;        // runs on the critical path, by position
+};
+
+void runBlock(const SchedulePlan &plan, std::uint64_t seed, int block,
+              int lanes, Lanes &rows, std::vector<float> &completions) {
+  constexpr int L = ScheduleSimulator::LANES;
+  const int n = static_cast<int>(plan.nodes.size());
+  std::uint32_t state[L];
+  for (int k = 0; k < L; ++k) {
+    auto s = static_cast<std::uint32_t>(
+        splitMix(seed ^ (static_cast<std::uint64_t>(block) * L + k)));
+    state[k] = s ? s : 1;
+  }
+
+  float end[L];
+  int last[L];
+  for (int k = 0; k < L; ++k) {
+    end[k] = 0;
+    last[k] = -1;
+  }
+  for (int i = 0; i < n; ++i) {
+    // Only the start is kept, not the predecessor it comes from: that one
+    // is found again when walking back the critical path, which keeps this
+    // loop a plain maximum. Rows are built in locals, which the compiler
+    // knows cannot overlap the rows they are read from.
+    float start[L] = {};
+    float finish[L];
+    for (int e = plan.first[i]; e < plan.first[i + 1]; ++e) {
+      const size_t p = static_cast<size_t>(plan.preds[e]);
+      const float *before = &rows.finish[p * L];
+      for (int k = 0; k < L; ++k)
+        start[k] = std::max(start[k], before[k]);
+    }
+
+    // Triangular sample without a square root: on the rising side the
+    // larger of two uniforms has the right shape, on the falling side the
+    // smaller one. The uniform choosing the side, rescaled, is the first
+    // of the two, so a sample takes two draws.
+    const float low = plan.low[i], span = plan.span[i], cut = plan.cut[i];
+    const float toRising = plan.toRising[i], toFalling = plan.toFalling[i];
+    for (int k = 0; k < L; ++k) {
+      std::uint32_t x = state[k];
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      float u = static_cast<float>(static_cast<std::int32_t>(x >> 8)) * UNIT;
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      float w = static_cast<float>(static_cast<std::int32_t>(x >> 8)) * UNIT;
+      state[k] = x;
+      bool rising = u < cut;
+      float v = rising ? u * toRising : (u - cut) * toFalling;
+      float t = rising ? cut * std::max(v, w)
+                       : cut + (1 - cut) * std::min(v, w);
+      finish[k] = start[k] + low + span * t;
+    }
+
+    for (int k = 0; k < L; ++k) {
+      int later = -static_cast<int>(finish[k] > end[k]);
+      end[k] = std::max(end[k], finish[k]);
+      last[k] = (i & later) | (last[k] & ~later);
+    }
+    const size_t row = static_cast<size_t>(i) * L;
+    std::copy(start, start + L, &rows.start[row]);
+    std::copy(finish, finish + L, &rows.finish[row]);
+  }
+
+  for (int k = 0; k < lanes; ++k) {
+    completions[static_cast<size_t>(block) * L + k] = end[k];
+    // Ties go to the first predecessor, as a strict maximum would
+    for (int v = last[k]; v >= 0;) {
+      ++rows.critical[v];
+      const float from = rows.start[static_cast<size_t>(v) * L + k];
+      int next = -1;
+      for (int e = plan.first[v]; e < plan.first[v + 1] && from > 0; ++e) {
+        int p = plan.preds[e];
+        if (rows.finish[static_cast<size_t>(p) * L + k] == from) {
+          next = p;
+          break;
+        }
+      }
+      v = next;
+    }
+  }
+}
+
+} // namespace
+
+double SimulationResult::percentile(double p) const {
+  if (completions.empty())
+    return 0;
+  double rank = std::clamp(p, 0.0, 100.0) / 100.0 * (completions.size() - 1);
+  return completions[static_cast<size_t>(std::lround(rank))];
+}
+
+SchedulePlan
+ScheduleSimulator::plan(const TaskGraph &graph,
+                        const std::vector<TaskEstimate> &estimates) {
+  SchedulePlan plan;
+  plan.idCount = graph.nodeCount();
+  plan.nodes = graph.topologicalOrder();
+  const size_t n = plan.nodes.size();
+  std::vector<int> position(plan.idCount, -1);
+  for (size_t i = 0; i < n; ++i)
+    position[plan.nodes[i]] = static_cast<int>(i);
+
+  plan.first.reserve(n + 1);
+  for (int id : plan.nodes) {
+    plan.first.push_back(static_cast<int>(plan.preds.size()));
+    for (int p : graph.predecessors(id))
+      plan.preds.push_back(position[p]);
+  }
+  plan.first.push_back(static_cast<int>(plan.preds.size()));
+
+  for (auto *row : {&plan.low, &plan.span, &plan.cut, &plan.toRising,
+                    &plan.toFalling})
+    row->resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    const int id = plan.nodes[i];
+    TaskEstimate e;
+    if (static_cast<size_t>(id) < estimates.size() && estimates[id].isSet()) {
+      e = estimates[id];
+    } else {
+      auto w = static_cast<float>(graph.weight(id));
+      e = {w, w, w, true};
+    }
+    // Out-of-order values are taken as the range they span
+    float low = std::min({e.optimistic, e.likely, e.pessimistic});
+    float high = std::max({e.optimistic, e.likely, e.pessimistic});
+    float span = high - low;
+    float cut = span > 0 ? (std::clamp(e.likely, low, high) - low) / span : 1;
+    plan.low[i] = low;
+    plan.span[i] = span;
+    plan.cut[i] = cut;
+    plan.toRising[i] = cut > 0 ? 1 / cut : 0;
+    plan.toFalling[i] = cut < 1 ? 1 / (1 - cut) : 0;
+  }
+  return plan;
+}
+
+SimulationResult ScheduleSimulator::run(const SchedulePlan &plan,
+                                        const Options &options,
+                                        const std::atomic<bool> *cancel) {
+  SimulationResult result;
+  const int n = static_cast<int>(plan.nodes.size());
+  result.criticality.assign(plan.idCount, 0.0f);
+  if (n == 0 || options.iterations <= 0)
+    return result;
+
+  const int blocks = (options.iterations + LANES - 1) / LANES;
+  const int chunks = (blocks + BLOCKS_PER_CHUNK - 1) / BLOCKS_PER_CHUNK;
+  int threads = options.threads > 0
+                    ? options.threads
+                    : static_cast<int>(std::thread::hardware_concurrency());
+  threads = std::clamp(threads, 1, chunks);
+
+  result.completions.resize(static_cast<size_t>(blocks) * LANES);
+  std::atomic<int> nextChunk{0};
+  std::vector<Lanes> rows(threads, Lanes(n));
+  auto work = [&](Lanes &lanes) {
+    for (int c = nextChunk++; c < chunks; c = nextChunk++) {
+      if (cancel && *cancel)
+        return;
+      const int endBlock = std::min(blocks, (c + 1) * BLOCKS_PER_CHUNK);
+      for (int b = c * BLOCKS_PER_CHUNK; b < endBlock; ++b) {
+        int used = std::min(LANES, options.iterations - b * LANES);
+        runBlock(plan, options.seed, b, used, lanes, result.completions);
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(work, std::ref(rows[t]));
+  work(rows[0]);
+  for (auto &t : pool)
+    t.join();
+  if (cancel && *cancel)
+    return SimulationResult();
+
+  result.iterations = options.iterations;
+  result.completions.resize(options.iterations);
+  std::sort(result.completions.begin(), result.completions.end());
+  const float share = 1.0f / static_cast<float>(options.iterations);
+  for (int i = 0; i < n; ++i) {
+    int runs = 0;
+    for (const Lanes &lanes : rows)
+      runs += lanes.critical[i];
+    result.criticality[plan.nodes[i]] = runs * share;
+  }
+  return result;
+}
+
+ScheduleSimulationRunner::~ScheduleSimulationRunner() { stop(); }
+
+void ScheduleSimulationRunner::start(
+    SchedulePlan plan, const ScheduleSimulator::Options &options) {
+  stop();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = false;
+  }
+  m_cancel = false;
+  m_thread = std::thread([this, plan = std::move(plan), options]() {
+    SimulationResult result = ScheduleSimulator::run(plan, options, &m_cancel);
+    if (m_cancel)
+      return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_result = std::move(result);
+    m_done = true;
+  });
+}
+
+void ScheduleSimulationRunner::stop() {
+  m_cancel = true;
+  if (m_thread.joinable())
+    m_thread.join();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_done = false;
+}
+
+bool ScheduleSimulationRunner::takeResult(SimulationResult *result) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_done)
+      return false;
+    *result = std::move(m_result);
+    m_result = SimulationResult();
+    m_done = false;
+  }
+  if (m_thread.joinable())
+    m_thread.join();
+  return true;
+}
+
+} // namespace DevPlanner
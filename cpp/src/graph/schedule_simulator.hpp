@@ -0,0 +1,99 @@
+#ifndef SCHEDULE_SIMULATOR_HPP
+#define SCHEDULE_SIMULATOR_HPP
+
+#include "task_graph.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DevPlanner {
+
+// Three-point estimate of a task in days; durations are drawn from the
+// triangular distribution over it. Zero days is a valid estimate, so
+// whether one was given is kept apart from the values.
+struct TaskEstimate {
+  float optimistic = 0;
+  float likely = 0;
+  float pessimistic = 0;
+  bool set = false;
+
+  bool isSet() const { return set; }
+};
+
+// Snapshot of a TaskGraph for simulation, flattened into arrays in
+// topological order so a run needs no access to the graph
+struct SchedulePlan {
+  int idCount = 0;          // graph ids, for results by id
+  std::vector<int> nodes;   // position -> graph id
+  std::vector<int> first;   // position -> start in preds, plus an end mark
+  std::vector<int> preds;   // predecessor positions
+  // Sampling, by position: the range, the share of it below the likely
+  // value, and the factors rescaling a uniform on either side of that
+  std::vector<float> low, span, cut, toRising, toFalling;
+};
+
+struct SimulationResult {
+  int iterations = 0;
+  std::vector<float> completions; // project duration of every run, sorted
+  std::vector<float> criticality; // by graph id, share of runs critical
+
+  // Duration not exceeded in p percent of the runs
+  double percentile(double p) const;
+};
+
+// Monte Carlo schedule simulation. Every run draws a duration for every
+// task and takes the longest path through the dependencies; the runs give
+// the spread of the completion time and how often each task ends up on
+// the critical path.
+//
+// Runs are computed LANES at a time with every per-task value stored as a
+// row of LANES floats, so sampling and the longest-path pass are plain
+// loops over a row. Blocks of runs are spread over threads; each block is
+// seeded from its own index, so results do not depend on the thread count.
+class ScheduleSimulator {
+public:
+  static constexpr int LANES = 16;
+
+  struct Options {
+    int iterations = 100000;
+    int threads = 0; // 0: one per core
+    std::uint64_t seed = 0x5eed;
+  };
+
+  // Estimates are by graph id. Tasks left out or without an estimate take
+  // their graph weight as a fixed duration.
+  static SchedulePlan plan(const TaskGraph &graph,
+                           const std::vector<TaskEstimate> &estimates);
+  static SimulationResult run(const SchedulePlan &plan, const Options &options,
+                              const std::atomic<bool> *cancel = nullptr);
+};
+
+// Runs simulations on a worker thread. A new request cancels the one in
+// flight.
+class ScheduleSimulationRunner {
+public:
+  ScheduleSimulationRunner() = default;
+  ~ScheduleSimulationRunner();
+  ScheduleSimulationRunner(const ScheduleSimulationRunner &) = delete;
+  ScheduleSimulationRunner &
+  operator=(const ScheduleSimulationRunner &) = delete;
+
+  void start(SchedulePlan plan, const ScheduleSimulator::Options &options);
+  void stop();
+  bool isRunning() const { return m_thread.joinable(); }
+
+  bool takeResult(SimulationResult *result);
+
+private:
+  std::thread m_thread;
+  std::atomic<bool> m_cancel{false};
+  std::mutex m_mutex;
+  SimulationResult m_result;
+  bool m_done = false;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,355 @@
+#include "task_graph.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace DevPlanner {
+
+int TaskGraph::addNode(double weight) {
+  int id;
+  if (!m_free.empty()) {
+    // A dead id keeps its slot in the order; it has no edges to violate it
+    id = m_free.back();
+    m_free.pop_back();
+    m_alive[id] = 1;
+  } else {
+    id = static_cast<int>(m_alive.size());
+    m_succ.emplace_back();
+    m_pred.emplace_back();
+    m_weight.push_back(0);
+    m_finish.push_back(0);
+    m_via.push_back(-1);
+    m_alive.push_back(1);
+    m_mark.push_back(0);
+    m_done.push_back(0);
+    m_open.push_back(0);
+    m_ord.push_back(static_cast<int>(m_node.size()));
+    m_node.push_back(id);
+  }
+  m_weight[id] = weight;
+  m_finish[id] = weight;
+  m_via[id] = -1;
+  m_done[id] = 0;
+  m_open[id] = 0;
+  if (!m_bulk)
+    pushBest(id);
+  return id;
+}
+
+void TaskGraph::removeNode(int id) {
+  if (id < 0 || id >= nodeCount() || !m_alive[id])
+    return;
+  for (int s : m_succ[id]) {
+    auto &list = m_pred[s];
+    list.erase(std::remove(list.begin(), list.end(), id), list.end());
+    if (!m_done[id])
+      --m_open[s];
+    m_touched.push_back(s);
+  }
+  for (int p : m_pred[id]) {
+    auto &list = m_succ[p];
+    list.erase(std::remove(list.begin(), list.end(), id), list.end());
+  }
+  std::vector<int> downstream;
+  downstream.swap(m_succ[id]);
+  m_pred[id].clear();
+  m_cycleEdges.erase(std::remove_if(m_cycleEdges.begin(), m_cycleEdges.end(),
+                                    [id](const Edge &e) {
+                                      return e.first == id || e.second == id;
+                                    }),
+                     m_cycleEdges.end());
+  m_alive[id] = 0;
+  m_weight[id] = 0;
+  m_finish[id] = 0;
+  m_via[id] = -1;
+  m_free.push_back(id);
+  for (int s : downstream)
+    propagate(s);
+  retryCycleEdges();
+}
+
+bool TaskGraph::addEdge(int from, int to) {
+  if (insertEdge(from, to))
+    return true;
+  m_cycleEdges.push_back({from, to});
+  return false;
+}
+
+bool TaskGraph::insertEdge(int from, int to) {
+  if (from == to || !reorder(from, to))
+    return false;
+  m_succ[from].push_back(to);
+  m_pred[to].push_back(from);
+  if (!m_done[from])
+    ++m_open[to];
+  m_touched.push_back(to);
+  propagate(to);
+  return true;
+}
+
+void TaskGraph::removeEdge(int from, int to) {
+  auto cyclic = std::find(m_cycleEdges.begin(), m_cycleEdges.end(),
+                          Edge(from, to));
+  if (cyclic != m_cycleEdges.end()) {
+    m_cycleEdges.erase(cyclic);
+    return;
+  }
+  auto &succ = m_succ[from];
+  auto it = std::find(succ.begin(), succ.end(), to);
+  if (it == succ.end())
+    return;
+  succ.erase(it);
+  auto &pred = m_pred[to];
+  pred.erase(std::find(pred.begin(), pred.end(), from));
+  if (!m_done[from])
+    --m_open[to];
+  m_touched.push_back(to);
+  propagate(to);
+  retryCycleEdges();
+}
+
+void TaskGraph::setWeight(int id, double weight) {
+  if (m_weight[id] == weight)
+    return;
+  m_weight[id] = weight;
+  propagate(id);
+}
+
+void TaskGraph::setDone(int id, bool done) {
+  if (static_cast<bool>(m_done[id]) == done)
+    return;
+  m_done[id] = done;
+  for (int s : m_succ[id]) {
+    m_open[s] += done ? -1 : 1;
+    m_touched.push_back(s);
+  }
+}
+
+std::vector<int> TaskGraph::takeTouched() {
+  std::vector<int> touched;
+  touched.swap(m_touched);
+  return touched;
+}
+
+void TaskGraph::clear() {
+  m_succ.clear();
+  m_pred.clear();
+  m_weight.clear();
+  m_finish.clear();
+  m_via.clear();
+  m_alive.clear();
+  m_free.clear();
+  m_ord.clear();
+  m_node.clear();
+  m_cycleEdges.clear();
+  m_done.clear();
+  m_open.clear();
+  m_touched.clear();
+  m_best.clear();
+  m_mark.clear();
+  m_markValue = 0;
+}
+
+void TaskGraph::endBulk() {
+  m_bulk = false;
+  recomputeAll();
+}
+
+std::vector<int> TaskGraph::topologicalOrder() const {
+  std::vector<int> order;
+  order.reserve(m_node.size());
+  for (int id : m_node) {
+    if (m_alive[id])
+      order.push_back(id);
+  }
+  return order;
+}
+
+bool TaskGraph::reorder(int from, int to) {
+  const int lb = m_ord[to];
+  const int ub = m_ord[from];
+  if (lb > ub)
+    return true;
+
+  // Forward from to, among nodes placed before from. Reaching from means
+  // the new edge closes a cycle.
+  ++m_markValue;
+  m_forward.clear();
+  m_stack.assign(1, to);
+  m_mark[to] = m_markValue;
+  while (!m_stack.empty()) {
+    int n = m_stack.back();
+    m_stack.pop_back();
+    m_forward.push_back(n);
+    for (int w : m_succ[n]) {
+      if (m_ord[w] == ub)
+        return false;
+      if (m_mark[w] != m_markValue && m_ord[w] < ub) {
+        m_mark[w] = m_markValue;
+        m_stack.push_back(w);
+      }
+    }
+  }
+
+  // Backward from from, among nodes placed after to
+  m_backward.clear();
+  m_stack.assign(1, from);
+  m_mark[from] = m_markValue;
+  while (!m_stack.empty()) {
+    int n = m_stack.back();
+    m_stack.pop_back();
+    m_backward.push_back(n);
+    for (int w : m_pred[n]) {
+      if (m_mark[w] != m_markValue && m_ord[w] > lb) {
+        m_mark[w] = m_markValue;
+        m_stack.push_back(w);
+      }
+    }
+  }
+
+  // The affected nodes swap into the same set of positions: everything
+  // upstream of from first, then everything downstream of to, each group
+  // keeping its relative order
+  auto byOrd = [this](int a, int b) { return m_ord[a] < m_ord[b]; };
+  std::sort(m_backward.begin(), m_backward.end(), byOrd);
+  std::sort(m_forward.begin(), m_forward.end(), byOrd);
+  m_pool.clear();
+  for (int n : m_backward)
+    m_pool.push_back(m_ord[n]);
+  for (int n : m_forward)
+    m_pool.push_back(m_ord[n]);
+  std::sort(m_pool.begin(), m_pool.end());
+  size_t i = 0;
+  for (const auto *group : {&m_backward, &m_forward}) {
+    for (int n : *group) {
+      m_ord[n] = m_pool[i];
+      m_node[m_pool[i]] = n;
+      ++i;
+    }
+  }
+  return true;
+}
+
+void TaskGraph::propagate(int seed) {
+  if (m_bulk)
+    return;
+  // Min-heap on position: a node is recomputed only after every queued
+  // predecessor, so each is visited at most once
+  using Entry = std::pair<int, int>;
+  std::greater<Entry> later;
+  ++m_markValue;
+  m_queue.assign(1, {m_ord[seed], seed});
+  m_mark[seed] = m_markValue;
+  while (!m_queue.empty()) {
+    std::pop_heap(m_queue.begin(), m_queue.end(), later);
+    int v = m_queue.back().second;
+    m_queue.pop_back();
+
+    double best = 0;
+    int via = -1;
+    for (int u : m_pred[v]) {
+      if (via < 0 || m_finish[u] > best || (m_finish[u] == best && u < via)) {
+        best = m_finish[u];
+        via = u;
+      }
+    }
+    double f = best + m_weight[v];
+    bool changed = f != m_finish[v];
+    if (!changed && via == m_via[v])
+      continue;
+    m_via[v] = via;
+    if (!changed)
+      continue;
+    m_finish[v] = f;
+    pushBest(v);
+    for (int w : m_succ[v]) {
+      if (m_mark[w] != m_markValue) {
+        m_mark[w] = m_markValue;
+        m_queue.push_back({m_ord[w], w});
+        std::push_heap(m_queue.begin(), m_queue.end(), later);
+      }
+    }
+  }
+}
+
+void TaskGraph::recomputeAll() {
+  for (int v : m_node) {
+    if (!m_alive[v])
+      continue;
+    double best = 0;
+    int via = -1;
+    for (int u : m_pred[v]) {
+      if (via < 0 || m_finish[u] > best || (m_finish[u] == best && u < via)) {
+        best = m_finish[u];
+        via = u;
+      }
+    }
+    m_finish[v] = best + m_weight[v];
+    m_via[v] = via;
+  }
+  m_best.clear();
+  for (int id = 0; id < nodeCount(); ++id) {
+    if (m_alive[id])
+      m_best.push_back({m_finish[id], -id});
+  }
+  std::make_heap(m_best.begin(), m_best.end());
+}
+
+void TaskGraph::pushBest(int id) {
+  // Stale entries pile up as finish times change; rebuild before they
+  // outnumber the live ones
+  if (m_best.size() > 2 * m_alive.size() + 64) {
+    m_best.clear();
+    for (int i = 0; i < nodeCount(); ++i) {
+      if (m_alive[i] && i != id)
+        m_best.push_back({m_finish[i], -i});
+    }
+    std::make_heap(m_best.begin(), m_best.end());
+  }
+  m_best.push_back({m_finish[id], -id});
+  std::push_heap(m_best.begin(), m_best.end());
+}
+
+int TaskGraph::bestNode() {
+  while (!m_best.empty()) {
+    int id = -m_best.front().second;
+    if (m_alive[id] && m_finish[id] == m_best.front().first)
+      return id;
+    std::pop_heap(m_best.begin(), m_best.end());
+    m_best.pop_back();
+  }
+  return -1;
+}
+
+double TaskGraph::criticalLength() {
+  int id = bestNode();
+  return id < 0 ? 0 : m_finish[id];
+}
+
+std::vector<int> TaskGraph::criticalPath() {
+  std::vector<int> path;
+  int id = bestNode();
+  if (id < 0 || m_finish[id] <= 0)
+    return path;
+  for (int v = id; v >= 0; v = m_via[v])
+    path.push_back(v);
+  std::reverse(path.begin(), path.end());
+  // Finished work at either end adds nothing to the length
+  auto open = [this](int v) { return m_weight[v] > 0; };
+  path.erase(path.begin(), std::find_if(path.begin(), path.end(), open));
+  path.erase(std::find_if(path.rbegin(), path.rend(), open).base(),
+             path.end());
+  return path;
+}
+
+void TaskGraph::retryCycleEdges() {
+  if (m_cycleEdges.empty())
+    return;
+  std::vector<Edge> pending;
+  pending.swap(m_cycleEdges);
+  for (const Edge &e : pending) {
+    if (!insertEdge(e.first, e.second))
+      m_cycleEdges.push_back(e);
+  }
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,101 @@
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include <utility>
+#include <vector>
+
+namespace DevPlanner {
+
+// Dependency graph of the board with analysis kept up to date per edit:
+//
+// - a topological order, maintained with the Pearce-Kelly dynamic
+//   algorithm: adding an edge only reorders the nodes between its two ends
+// - cycle detection: an edge that would close a cycle is kept aside instead
+//   of entering the order, and retried whenever an edge or node goes away
+// - earliest finish of every node (longest weighted path ending in it),
+//   re-propagated only downstream of what changed, in topological order,
+//   and only as far as values actually change
+// - the number of unfinished predecessors of every node, adjusted only on
+//   the direct successors of whatever changed
+//
+// Node ids are dense and reused after removal.
+class TaskGraph {
+public:
+  using Edge = std::pair<int, int>;
+
+  int addNode(double weight = 1);
+  void removeNode(int id);
+  // False when the edge closes a cycle; it is then listed by cycleEdges()
+  bool addEdge(int from, int to);
+  void removeEdge(int from, int to);
+  // Remaining work of a node, e.g. 0 once it is done
+  void setWeight(int id, double weight);
+  void setDone(int id, bool done);
+  void clear();
+
+  // Edges added between beginBulk() and endBulk() only update the order;
+  // finish times are recomputed once at the end
+  void beginBulk() { m_bulk = true; }
+  void endBulk();
+  bool inBulk() const { return m_bulk; }
+
+  int nodeCount() const { return static_cast<int>(m_alive.size()); }
+  bool isAlive(int id) const { return m_alive[id]; }
+  // Edges in the order, without the cycle-closing ones
+  const std::vector<int> &successors(int id) const { return m_succ[id]; }
+  const std::vector<int> &predecessors(int id) const { return m_pred[id]; }
+  bool hasCycles() const { return !m_cycleEdges.empty(); }
+  const std::vector<Edge> &cycleEdges() const { return m_cycleEdges; }
+  // True when a comes before b in the current topological order
+  bool precedes(int a, int b) const { return m_ord[a] < m_ord[b]; }
+  std::vector<int> topologicalOrder() const;
+
+  bool isDone(int id) const { return m_done[id]; }
+  // Predecessors (through edges in the order) that are not done
+  int openPredecessors(int id) const { return m_open[id]; }
+  // Nodes whose predecessors or their done state changed since the last
+  // call; may repeat ids and include removed ones
+  std::vector<int> takeTouched();
+
+  double weight(int id) const { return m_weight[id]; }
+  double finish(int id) const { return m_finish[id]; }
+  double criticalLength();
+  // Longest weighted chain, first node first; ties go to the lower id
+  std::vector<int> criticalPath();
+
+private:
+  bool insertEdge(int from, int to);
+  // Pearce-Kelly reordering for an edge against the order; false on cycle
+  bool reorder(int from, int to);
+  void propagate(int seed);
+  void recomputeAll();
+  void pushBest(int id);
+  int bestNode();
+  void retryCycleEdges();
+
+  std::vector<std::vector<int>> m_succ, m_pred;
+  std::vector<double> m_weight, m_finish;
+  std::vector<int> m_via; // predecessor the finish time comes through
+  std::vector<char> m_alive;
+  std::vector<int> m_free;
+  std::vector<int> m_ord;  // id -> position
+  std::vector<int> m_node; // position -> id
+  std::vector<Edge> m_cycleEdges;
+  std::vector<char> m_done;
+  std::vector<int> m_open;
+  std::vector<int> m_touched;
+  bool m_bulk = false;
+
+  // Max-heap of (finish, id) with stale entries dropped lazily
+  std::vector<std::pair<double, int>> m_best;
+
+  // Scratch state reused across edits
+  std::vector<int> m_mark;
+  int m_markValue = 0;
+  std::vector<int> m_stack, m_forward, m_backward, m_pool;
+  std::vector<std::pair<int, int>> m_queue; // (position, id) min-heap
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,184 @@
+#include "edge_bundler.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace DevPlanner {
+
+namespace {
+
+struct Cell {
+  double x0, y0, x1, y1;
+  int begin, end; // range in the permuted node order
+  int depth;
+  int parent;
+};
+
+} // namespace
+
+EdgeBundles EdgeBundler::bundle(const std::vector<LayoutPoint> &centres,
+                                const std::vector<LayoutEdge> &edges,
+                                const Options &options) {
+  const int n = static_cast<int>(centres.size());
+  EdgeBundles out;
+  out.nodeCount = n;
+  if (n == 0)
+    return out;
+
+  std::vector<int> order(n);
+  for (int i = 0; i < n; ++i)
+    order[i] = i;
+  double x0 = centres[0].x, y0 = centres[0].y, x1 = x0, y1 = y0;
+  for (const auto &p : centres) {
+    x0 = std::min(x0, p.x);
+    y0 = std::min(y0, p.y);
+    x1 = std::max(x1, p.x);
+    y1 = std::max(y1, p.y);
+  }
+
+  // Top-down split. A cell whose nodes all fall into one quadrant shrinks
+  // to it instead of getting a child, so chains of single-child cells (and
+  // the collinear strokes they would draw) never appear.
+  std::vector<Cell> cells{{x0, y0, x1, y1, 0, n, 0, -1}};
+  std::vector<int> leaf(n, 0);
+  std::vector<int> stack{0};
+  while (!stack.empty()) {
+    int id = stack.back();
+    stack.pop_back();
+    while (true) {
+      Cell c = cells[id];
+      if (c.end - c.begin <= options.leafSize || c.depth >= options.maxDepth) {
+        for (int i = c.begin; i < c.end; ++i)
+          leaf[order[i]] = id;
+        break;
+      }
+      double mx = (c.x0 + c.x1) / 2, my = (c.y0 + c.y1) / 2;
+      auto first = order.begin() + c.begin;
+      auto last = order.begin() + c.end;
+      auto top = [&](int i) { return centres[i].y < my; };
+      auto left = [&](int i) { return centres[i].x < mx; };
+      auto midY = std::partition(first, last, top);
+      auto midTop = std::partition(first, midY, left);
+      auto midBottom = std::partition(midY, last, left);
+      int cut[5] = {c.begin, static_cast<int>(midTop - order.begin()),
+                    static_cast<int>(midY - order.begin()),
+                    static_cast<int>(midBottom - order.begin()), c.end};
+      const double bx[4][2] = {
+          {c.x0, mx}, {mx, c.x1}, {c.x0, mx}, {mx, c.x1}};
+      const double by[4][2] = {
+          {c.y0, my}, {c.y0, my}, {my, c.y1}, {my, c.y1}};
+      int filled = 0, only = 0;
+      for (int q = 0; q < 4; ++q) {
+        if (cut[q + 1] > cut[q]) {
+          ++filled;
+          only = q;
+        }
+      }
+      if (filled == 1) {
+        cells[id].x0 = bx[only][0];
+        cells[id].x1 = bx[only][1];
+        cells[id].y0 = by[only][0];
+        cells[id].y1 = by[only][1];
+        ++cells[id].depth;
+        continue;
+      }
+      for (int q = 0; q < 4; ++q) {
+        if (cut[q + 1] == cut[q])
+          continue;
+        stack.push_back(static_cast<int>(cells.size()));
+        cells.push_back({bx[q][0], by[q][0], bx[q][1], by[q][1], cut[q],
+                         cut[q + 1], c.depth + 1, id});
+      }
+      break;
+    }
+  }
+
+  // Hubs sit at the centroid of their nodes, not the cell centre, so the
+  // bundles follow where the nodes actually are
+  const int m = static_cast<int>(cells.size());
+  out.hubs.resize(m);
+  for (int id = 0; id < m; ++id) {
+    const Cell &c = cells[id];
+    double sx = 0, sy = 0;
+    for (int i = c.begin; i < c.end; ++i) {
+      sx += centres[order[i]].x;
+      sy += centres[order[i]].y;
+    }
+    double count = c.end - c.begin;
+    out.hubs[id] = {sx / count, sy / count};
+  }
+
+  // Each edge climbs from both leaves to their lowest common cell; every
+  // cell below it gets its stroke to the parent counted once
+  std::vector<int> nodeWeight(n, 0);
+  std::vector<int> cellWeight(m, 0);
+  for (const auto &e : edges) {
+    if (e.from == e.to || e.from < 0 || e.to < 0 || e.from >= n || e.to >= n)
+      continue;
+    ++nodeWeight[e.from];
+    ++nodeWeight[e.to];
+    int u = leaf[e.from], v = leaf[e.to];
+    while (u != v) {
+      if (cells[u].depth >= cells[v].depth) {
+        ++cellWeight[u];
+        u = cells[u].parent;
+      } else {
+        ++cellWeight[v];
+        v = cells[v].parent;
+      }
+    }
+  }
+
+  for (int i = 0; i < n; ++i) {
+    if (nodeWeight[i] > 0)
+      out.segments.push_back({i, n + leaf[i], nodeWeight[i]});
+  }
+  for (int id = 1; id < m; ++id) {
+    if (cellWeight[id] > 0)
+      out.segments.push_back({n + id, n + cells[id].parent, cellWeight[id]});
+  }
+  return out;
+}
+
+EdgeBundlingRunner::~EdgeBundlingRunner() { stop(); }
+
+void EdgeBundlingRunner::start(std::vector<LayoutPoint> centres,
+                               std::vector<LayoutEdge> edges,
+                               const EdgeBundler::Options &options) {
+  stop();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = false;
+  }
+  m_thread = std::thread([this, centres = std::move(centres),
+                          edges = std::move(edges), options]() {
+    EdgeBundles bundles = EdgeBundler::bundle(centres, edges, options);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_result = std::move(bundles);
+    m_done = true;
+  });
+}
+
+void EdgeBundlingRunner::stop() {
+  // A single pass with no iterations to break out of; waiting is bounded
+  // by one bundle() call
+  if (m_thread.joinable())
+    m_thread.join();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_done = false;
+}
+
+bool EdgeBundlingRunner::takeResult(EdgeBundles *bundles) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_done)
+      return false;
+    *bundles = std::move(m_result);
+    m_result = EdgeBundles();
+    m_done = false;
+  }
+  if (m_thread.joinable())
+    m_thread.join();
+  return true;
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,68 @@
+#ifndef EDGE_BUNDLER_HPP
+#define EDGE_BUNDLER_HPP
+
+#include "layered_layout.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DevPlanner {
+
+// One drawn stroke of a bundle. Endpoints below the node count are nodes,
+// the rest are hubs (hub index + node count).
+struct BundleSegment {
+  int from;
+  int to;
+  int weight; // edges running through it
+};
+
+struct EdgeBundles {
+  int nodeCount = 0;
+  std::vector<LayoutPoint> hubs;
+  std::vector<BundleSegment> segments;
+};
+
+// Hierarchical edge bundling over a quadtree of the node centres. Every
+// edge runs from its node up the tree to the lowest common cell of its two
+// endpoints and back down, through the centroids of the cells on the way.
+// Edges sharing cells share those strokes, so a board is drawn with at most
+// one segment per node plus one per cell, whatever the edge count.
+class EdgeBundler {
+public:
+  struct Options {
+    int leafSize = 8;  // nodes per leaf cell
+    int maxDepth = 16; // stops splitting stacks of coincident nodes
+  };
+
+  static EdgeBundles bundle(const std::vector<LayoutPoint> &centres,
+                            const std::vector<LayoutEdge> &edges,
+                            const Options &options);
+};
+
+// Computes bundles on a worker thread. A new request replaces the result of
+// the one in flight.
+class EdgeBundlingRunner {
+public:
+  EdgeBundlingRunner() = default;
+  ~EdgeBundlingRunner();
+  EdgeBundlingRunner(const EdgeBundlingRunner &) = delete;
+  EdgeBundlingRunner &operator=(const EdgeBundlingRunner &) = delete;
+
+  void start(std::vector<LayoutPoint> centres, std::vector<LayoutEdge> edges,
+             const EdgeBundler::Options &options);
+  void stop();
+  bool isRunning() const { return m_thread.joinable(); }
+
+  bool takeResult(EdgeBundles *bundles);
+
+private:
+  std::thread m_thread;
+  std::mutex m_mutex;
+  EdgeBundles m_result;
+  bool m_done = false;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,402 @@
+#include "edge_router.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <utility>
+
+namespace DevPlanner {
+
+namespace {
+
+enum Direction { East, West, South, North };
+
+bool horizontal(int d) { return d == East || d == West; }
+
+// Drops points in the middle of straight runs
+void simplify(std::vector<LayoutPoint> *points) {
+  std::vector<LayoutPoint> &p = *points;
+  if (p.size() < 3)
+    return;
+  size_t out = 1;
+  for (size_t i = 1; i + 1 < p.size(); ++i) {
+    const LayoutPoint &a = p[out - 1];
+    const LayoutPoint &b = p[i];
+    const LayoutPoint &c = p[i + 1];
+    bool straight = (a.x == b.x && b.x == c.x) || (a.y == b.y && b.y == c.y);
+    if (!straight)
+      p[out++] = b;
+  }
+  p[out++] = p.back();
+  p.resize(out);
+}
+
+} // namespace
+
+EdgeRouter::EdgeRouter(std::vector<LayoutRect> obstacles,
+                       const Options &options)
+    : m_options(options), m_obstacles(std::move(obstacles)),
+      m_stamp(m_obstacles.size(), 0) {
+  const double m = options.margin;
+  for (size_t i = 0; i < m_obstacles.size(); ++i) {
+    LayoutRect &r = m_obstacles[i];
+    r = {r.x - m, r.y - m, r.width + 2 * m, r.height + 2 * m};
+    for (auto cx = cell(r.x); cx <= cell(r.x + r.width); ++cx) {
+      for (auto cy = cell(r.y); cy <= cell(r.y + r.height); ++cy)
+        m_cells[key(cx, cy)].push_back(static_cast<int>(i));
+    }
+  }
+}
+
+EdgeRouter::Key EdgeRouter::key(std::int64_t cx, std::int64_t cy) const {
+  return (static_cast<Key>(static_cast<std::uint32_t>(cx)) << 32) |
+         static_cast<std::uint32_t>(cy);
+}
+
+std::int64_t EdgeRouter::cell(double v) const {
+  return static_cast<std::int64_t>(std::floor(v / m_cellSize));
+}
+
+void EdgeRouter::collect(const LayoutRect &area, std::vector<int> *out) {
+  ++m_stampValue;
+  out->clear();
+  for (auto cx = cell(area.x); cx <= cell(area.x + area.width); ++cx) {
+    for (auto cy = cell(area.y); cy <= cell(area.y + area.height); ++cy) {
+      auto it = m_cells.find(key(cx, cy));
+      if (it == m_cells.end())
+        continue;
+      for (int id : it->second) {
+        if (m_stamp[id] == m_stampValue)
+          continue;
+        m_stamp[id] = m_stampValue;
+        const LayoutRect &r = m_obstacles[id];
+        if (r.x < area.x + area.width && area.x < r.x + r.width &&
+            r.y < area.y + area.height && area.y < r.y + r.height)
+          out->push_back(id);
+      }
+      // One past the limit is enough for the caller to fall back
+      if (static_cast<int>(out->size()) > m_options.maxObstacles)
+        return;
+    }
+  }
+}
+
+std::vector<LayoutPoint> EdgeRouter::route(int from, int to) {
+  const LayoutRect &a = m_obstacles[from];
+  const LayoutRect &b = m_obstacles[to];
+  const double m = m_options.margin;
+  LayoutPoint ca{a.x + a.width / 2, a.y + a.height / 2};
+  LayoutPoint cb{b.x + b.width / 2, b.y + b.height / 2};
+  double dx = cb.x - ca.x;
+  double dy = cb.y - ca.y;
+
+  // Leave and enter through the sides facing each other. The port sits on
+  // the node border, the stub end on the clearance border.
+  bool flat = std::abs(dx) >= std::abs(dy);
+  LayoutPoint portA, stubA, portB, stubB;
+  if (flat) {
+    double ax = dx >= 0 ? a.x + a.width : a.x;
+    double bx = dx >= 0 ? b.x : b.x + b.width;
+    stubA = {ax, ca.y};
+    portA = {dx >= 0 ? ax - m : ax + m, ca.y};
+    stubB = {bx, cb.y};
+    portB = {dx >= 0 ? bx + m : bx - m, cb.y};
+  } else {
+    double ay = dy >= 0 ? a.y + a.height : a.y;
+    double by = dy >= 0 ? b.y : b.y + b.height;
+    stubA = {ca.x, ay};
+    portA = {ca.x, dy >= 0 ? ay - m : ay + m};
+    stubB = {cb.x, by};
+    portB = {cb.x, dy >= 0 ? by + m : by - m};
+  }
+
+  std::vector<LayoutPoint> points{portA};
+  bool overlapping = a.x < b.x + b.width && b.x < a.x + a.width &&
+                     a.y < b.y + b.height && b.y < a.y + a.height;
+  bool routed = false;
+  if (!overlapping) {
+    // Obstacles around the pair, then once more with the area grown to
+    // cover them, so detours around them fit in the grid
+    LayoutRect area{std::min(stubA.x, stubB.x) - 2 * m,
+                    std::min(stubA.y, stubB.y) - 2 * m,
+                    std::abs(stubA.x - stubB.x) + 4 * m,
+                    std::abs(stubA.y - stubB.y) + 4 * m};
+    std::vector<int> near;
+    collect(area, &near);
+    if (static_cast<int>(near.size()) <= m_options.maxObstacles) {
+      double left = area.x, top = area.y;
+      double right = area.x + area.width, bottom = area.y + area.height;
+      for (int id : near) {
+        const LayoutRect &r = m_obstacles[id];
+        left = std::min(left, r.x - m);
+        top = std::min(top, r.y - m);
+        right = std::max(right, r.x + r.width + m);
+        bottom = std::max(bottom, r.y + r.height + m);
+      }
+      area = {left, top, right - left, bottom - top};
+      collect(area, &near);
+    }
+    if (static_cast<int>(near.size()) <= m_options.maxObstacles) {
+      std::vector<LayoutPoint> path;
+      routed = gridRoute(stubA, stubB, flat, flat, near, &path) &&
+               !path.empty();
+      if (routed)
+        points.insert(points.end(), path.begin(), path.end());
+    }
+  }
+  if (!routed) {
+    points.push_back(stubA);
+    if (flat) {
+      double mid = (stubA.x + stubB.x) / 2;
+      points.push_back({mid, stubA.y});
+      points.push_back({mid, stubB.y});
+    } else {
+      double mid = (stubA.y + stubB.y) / 2;
+      points.push_back({stubA.x, mid});
+      points.push_back({stubB.x, mid});
+    }
+    points.push_back(stubB);
+  }
+  points.push_back(portB);
+  simplify(&points);
+  return points;
+}
+
+bool EdgeRouter::gridRoute(const LayoutPoint &start, const LayoutPoint &goal,
+                           bool startHorizontal, bool goalHorizontal,
+                           const std::vector<int> &near,
+                           std::vector<LayoutPoint> *out) {
+  // Grid lines: obstacle borders, the two stub ends and a frame around them
+  m_xs.assign({start.x, goal.x});
+  m_ys.assign({start.y, goal.y});
+  double frame = 2 * m_options.margin;
+  m_xs.push_back(std::min(start.x, goal.x) - frame);
+  m_xs.push_back(std::max(start.x, goal.x) + frame);
+  m_ys.push_back(std::min(start.y, goal.y) - frame);
+  m_ys.push_back(std::max(start.y, goal.y) + frame);
+  for (int id : near) {
+    const LayoutRect &r = m_obstacles[id];
+    m_xs.push_back(r.x);
+    m_xs.push_back(r.x + r.width);
+    m_ys.push_back(r.y);
+    m_ys.push_back(r.y + r.height);
+  }
+  std::sort(m_xs.begin(), m_xs.end());
+  m_xs.erase(std::unique(m_xs.begin(), m_xs.end()), m_xs.end());
+  std::sort(m_ys.begin(), m_ys.end());
+  m_ys.erase(std::unique(m_ys.begin(), m_ys.end()), m_ys.end());
+  const int nx = static_cast<int>(m_xs.size());
+  const int ny = static_cast<int>(m_ys.size());
+
+  // Scratch state is stamped with the route it belongs to instead of
+  // being cleared, so a route costs what it marks and searches, not the
+  // size of its grid
+  const size_t cells = static_cast<size_t>(nx) * ny;
+  if (++m_gridStamp == std::numeric_limits<int>::max()) {
+    for (auto *v : {&m_blockedNode, &m_blockedH, &m_blockedV, &m_seen})
+      std::fill(v->begin(), v->end(), 0);
+    m_gridStamp = 1;
+  }
+  const int stamp = m_gridStamp;
+  if (m_blockedNode.size() < cells) {
+    for (auto *v : {&m_blockedNode, &m_blockedH, &m_blockedV})
+      v->resize(cells, 0);
+  }
+  if (m_seen.size() < cells * 4) {
+    m_seen.resize(cells * 4, 0);
+    m_cost.resize(cells * 4);
+    m_parent.resize(cells * 4);
+  }
+
+  // Nodes strictly inside an obstacle and segments running through one.
+  // Borders are grid lines, so a segment is either fully in or out.
+  auto first = [](const std::vector<double> &v, double value) {
+    return static_cast<int>(std::lower_bound(v.begin(), v.end(), value) -
+                            v.begin());
+  };
+  auto after = [](const std::vector<double> &v, double value) {
+    return static_cast<int>(std::upper_bound(v.begin(), v.end(), value) -
+                            v.begin());
+  };
+  for (int id : near) {
+    const LayoutRect &r = m_obstacles[id];
+    int i0 = after(m_xs, r.x), i1 = first(m_xs, r.x + r.width);
+    int j0 = after(m_ys, r.y), j1 = first(m_ys, r.y + r.height);
+    int iEdge0 = first(m_xs, r.x), iEdge1 = after(m_xs, r.x + r.width) - 1;
+    int jEdge0 = first(m_ys, r.y), jEdge1 = after(m_ys, r.y + r.height) - 1;
+    for (int j = j0; j < j1; ++j) {
+      for (int i = i0; i < i1; ++i)
+        m_blockedNode[j * nx + i] = stamp;
+      for (int i = iEdge0; i < iEdge1; ++i)
+        m_blockedH[j * nx + i] = stamp; // segment i -> i + 1 on row j
+    }
+    for (int i = i0; i < i1; ++i) {
+      for (int j = jEdge0; j < jEdge1; ++j)
+        m_blockedV[j * nx + i] = stamp; // segment j -> j + 1 on column i
+    }
+  }
+
+  int si = first(m_xs, start.x), sj = first(m_ys, start.y);
+  int gi = first(m_xs, goal.x), gj = first(m_ys, goal.y);
+  int startNode = sj * nx + si;
+  int goalNode = gj * nx + gi;
+  if (m_blockedNode[startNode] == stamp || m_blockedNode[goalNode] == stamp)
+    return false;
+
+  const double inf = std::numeric_limits<double>::infinity();
+  const double bend = m_options.bendPenalty;
+  auto costOf = [&](int state) {
+    return m_seen[state] == stamp ? m_cost[state] : inf;
+  };
+  // Among equal estimates the deeper state goes first, which keeps the
+  // search from fanning out over the many routes of equal cost
+  using Entry = std::tuple<double, double, int>; // f, -g, state
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+  // Distance plus the bends no route from the state avoids: one with the
+  // goal off the heading, two with it behind (no U-turns), and one more
+  // when the last leg would enter the port along the wrong axis
+  auto heuristic = [&](int node, int dir) {
+    double dx = goal.x - m_xs[node % nx];
+    double dy = goal.y - m_ys[node / nx];
+    if (dx == 0 && dy == 0)
+      return 0.0;
+    double ahead = horizontal(dir) ? dx : dy;
+    double side = horizontal(dir) ? dy : dx;
+    if (dir == West || dir == North)
+      ahead = -ahead;
+    int bends = ahead > 0 && side == 0 ? 0 : ahead >= 0 ? 1 : 2;
+    if ((bends == 1) != (horizontal(dir) != goalHorizontal))
+      ++bends;
+    return std::abs(dx) + std::abs(dy) + bends * bend;
+  };
+
+  int startDir;
+  if (startHorizontal)
+    startDir = goal.x >= start.x ? East : West;
+  else
+    startDir = goal.y >= start.y ? South : North;
+  int startState = startNode * 4 + startDir;
+  m_seen[startState] = stamp;
+  m_cost[startState] = 0;
+  m_parent[startState] = -1;
+  open.emplace(heuristic(startNode, startDir), 0.0, startState);
+
+  int found = -1;
+  while (!open.empty()) {
+    auto [f, depth, state] = open.top();
+    open.pop();
+    int node = state / 4;
+    int dir = state % 4;
+    double g = m_cost[state];
+    if (-depth > g + 1e-9)
+      continue; // stale entry
+    if (node == goalNode) {
+      found = state;
+      break;
+    }
+    int i = node % nx;
+    int j = node / nx;
+    for (int nd = 0; nd < 4; ++nd) {
+      if ((dir ^ 1) == nd)
+        continue; // no U-turns
+      int ni = i, nj = j;
+      bool blocked;
+      switch (nd) {
+      case East:
+        ni = i + 1;
+        blocked = ni >= nx || m_blockedH[j * nx + i] == stamp;
+        break;
+      case West:
+        ni = i - 1;
+        blocked = ni < 0 || m_blockedH[j * nx + ni] == stamp;
+        break;
+      case South:
+        nj = j + 1;
+        blocked = nj >= ny || m_blockedV[j * nx + i] == stamp;
+        break;
+      default:
+        nj = j - 1;
+        blocked = nj < 0 || m_blockedV[nj * nx + i] == stamp;
+        break;
+      }
+      if (blocked)
+        continue;
+      int next = nj * nx + ni;
+      if (m_blockedNode[next] == stamp)
+        continue;
+      double step = std::abs(m_xs[ni] - m_xs[i]) + std::abs(m_ys[nj] - m_ys[j]);
+      double cost = g + step + (nd != dir ? bend : 0);
+      // Arriving along the wrong axis costs one more bend into the port
+      if (next == goalNode && horizontal(nd) != goalHorizontal)
+        cost += bend;
+      int nextState = next * 4 + nd;
+      if (cost < costOf(nextState)) {
+        m_seen[nextState] = stamp;
+        m_cost[nextState] = cost;
+        m_parent[nextState] = state;
+        open.emplace(cost + heuristic(next, nd), -cost, nextState);
+      }
+    }
+  }
+  if (found < 0)
+    return false;
+
+  out->clear();
+  for (int s = found; s >= 0; s = m_parent[s]) {
+    int node = s / 4;
+    out->push_back({m_xs[node % nx], m_ys[node / nx]});
+  }
+  std::reverse(out->begin(), out->end());
+  return true;
+}
+
+EdgeRoutingRunner::~EdgeRoutingRunner() { stop(); }
+
+void EdgeRoutingRunner::start(std::vector<LayoutRect> obstacles,
+                              std::vector<RouteRequest> requests,
+                              const EdgeRouter::Options &options) {
+  stop();
+  m_cancel = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = false;
+    m_result.clear();
+  }
+  m_thread = std::thread([this, obstacles = std::move(obstacles),
+                          requests = std::move(requests), options]() mutable {
+    EdgeRouter router(std::move(obstacles), options);
+    std::vector<std::vector<LayoutPoint>> routes;
+    routes.reserve(requests.size());
+    for (const auto &r : requests) {
+      if (m_cancel)
+        return;
+      routes.push_back(router.route(r.from, r.to));
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_result = std::move(routes);
+    m_done = true;
+  });
+}
+
+void EdgeRoutingRunner::stop() {
+  m_cancel = true;
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+bool EdgeRoutingRunner::takeResult(
+    std::vector<std::vector<LayoutPoint>> *routes) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_done)
+      return false;
+    routes->swap(m_result);
+    m_done = false;
+  }
+  if (m_thread.joinable())
+    m_thread.join();
+  return true;
+}
+
+} // namespace DevPlanner
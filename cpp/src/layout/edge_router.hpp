@@ -0,0 +1,91 @@
+#ifndef EDGE_ROUTER_HPP
+#define EDGE_ROUTER_HPP
+
+#include "placement_index.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace DevPlanner {
+
+struct RouteRequest {
+  int from; // obstacle indices of the two endpoints
+  int to;
+};
+
+// Orthogonal edge routes around node rectangles. Each edge is routed with
+// A* over a sparse grid built from the borders of the obstacles near it,
+// with a penalty per bend, so routes hug nodes and stay straight where they
+// can. Edges whose surroundings are too crowded for the local grid fall
+// back to a plain three-segment route.
+class EdgeRouter {
+public:
+  struct Options {
+    double margin = 16;       // clearance around nodes
+    double bendPenalty = 60;  // in canvas pixels of extra length
+    int maxObstacles = 160;   // per edge, before falling back
+  };
+
+  EdgeRouter(std::vector<LayoutRect> obstacles, const Options &options);
+
+  // Polyline from the border of obstacle from to the border of obstacle to
+  std::vector<LayoutPoint> route(int from, int to);
+
+private:
+  using Key = std::uint64_t;
+  Key key(std::int64_t cx, std::int64_t cy) const;
+  std::int64_t cell(double v) const;
+  void collect(const LayoutRect &area, std::vector<int> *out);
+  bool gridRoute(const LayoutPoint &start, const LayoutPoint &goal,
+                 bool startHorizontal, bool goalHorizontal,
+                 const std::vector<int> &near, std::vector<LayoutPoint> *out);
+
+  Options m_options;
+  double m_cellSize = 256;
+  std::vector<LayoutRect> m_obstacles; // already grown by the margin
+  std::unordered_map<Key, std::vector<int>> m_cells;
+  std::vector<int> m_stamp; // de-duplicates collect() results
+  int m_stampValue = 0;
+
+  // Scratch buffers reused across routes. Grid entries count only where
+  // they hold the current m_gridStamp.
+  std::vector<double> m_xs, m_ys;
+  std::vector<int> m_blockedNode, m_blockedH, m_blockedV;
+  std::vector<int> m_seen; // cost and parent of a search state are set
+  std::vector<double> m_cost;
+  std::vector<int> m_parent;
+  int m_gridStamp = 0;
+};
+
+// Routes a batch of edges on a worker thread against a snapshot of the
+// node rectangles. A new batch cancels the one in flight.
+class EdgeRoutingRunner {
+public:
+  EdgeRoutingRunner() = default;
+  ~EdgeRoutingRunner();
+  EdgeRoutingRunner(const EdgeRoutingRunner &) = delete;
+  EdgeRoutingRunner &operator=(const EdgeRoutingRunner &) = delete;
+
+  void start(std::vector<LayoutRect> obstacles,
+             std::vector<RouteRequest> requests,
+             const EdgeRouter::Options &options);
+  void stop();
+  bool isRunning() const { return m_thread.joinable(); }
+
+  // Routes aligned with the requests, once the whole batch is done
+  bool takeResult(std::vector<std::vector<LayoutPoint>> *routes);
+
+private:
+  std::thread m_thread;
+  std::atomic<bool> m_cancel{false};
+  std::mutex m_mutex;
+  std::vector<std::vector<LayoutPoint>> m_result;
+  bool m_done = false;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,295 @@
+#include "force_layout.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <utility>
+
+namespace DevPlanner {
+
+namespace {
+// Deep enough for nodes a fraction of a pixel apart; coincident ones share
+// the leaf instead of splitting forever
+constexpr int MAX_DEPTH = 24;
+constexpr double MIN_DISTANCE2 = 1e-4;
+// Settled once nothing moves more than this per iteration
+constexpr double SETTLED_MOVE = 0.5;
+// Below this the repulsion pass is cheaper than starting threads
+constexpr size_t PARALLEL_MIN = 4096;
+} // namespace
+
+ForceLayout::ForceLayout(std::vector<LayoutPoint> positions,
+                         const std::vector<LayoutEdge> &edges,
+                         std::vector<char> pinned, const Options &options)
+    : m_options(options), m_pinned(std::move(pinned)) {
+  const size_t n = positions.size();
+  // Big boards need room to expand to their final size before cooling down
+  m_temperature = options.idealLength *
+                  std::max(2.0, std::sqrt(static_cast<double>(n)) / 8);
+  m_pinned.resize(n, 0);
+  m_x.resize(n);
+  m_y.resize(n);
+  m_fx.resize(n);
+  m_fy.resize(n);
+  // Stacked nodes (new boards, AI batches) get a small deterministic spread
+  // so they do not cancel each other out
+  for (size_t i = 0; i < n; ++i) {
+    double angle = static_cast<double>(i) * 2.399963; // golden angle
+    double radius = std::sqrt(static_cast<double>(i));
+    m_x[i] = positions[i].x + std::cos(angle) * radius;
+    m_y[i] = positions[i].y + std::sin(angle) * radius;
+  }
+  for (const auto &e : edges) {
+    if (e.from == e.to || e.from < 0 || e.to < 0 ||
+        static_cast<size_t>(e.from) >= n || static_cast<size_t>(e.to) >= n)
+      continue;
+    m_from.push_back(e.from);
+    m_to.push_back(e.to);
+  }
+  m_ex.resize(m_from.size());
+  m_ey.resize(m_from.size());
+}
+
+std::vector<LayoutPoint> ForceLayout::positions() const {
+  std::vector<LayoutPoint> result(m_x.size());
+  for (size_t i = 0; i < m_x.size(); ++i)
+    result[i] = {m_x[i], m_y[i]};
+  return result;
+}
+
+int ForceLayout::quadrant(const Cell &cell, double x, double y) const {
+  double half = cell.size / 2;
+  return (x >= cell.x0 + half ? 1 : 0) + (y >= cell.y0 + half ? 2 : 0);
+}
+
+void ForceLayout::buildTree() {
+  m_cells.clear();
+  if (m_x.empty())
+    return;
+  auto [minX, maxX] = std::minmax_element(m_x.begin(), m_x.end());
+  auto [minY, maxY] = std::minmax_element(m_y.begin(), m_y.end());
+  double size = std::max(*maxX - *minX, *maxY - *minY) + 1;
+  Cell root;
+  root.x0 = *minX;
+  root.y0 = *minY;
+  root.size = size;
+  m_cells.push_back(root);
+  for (size_t i = 0; i < m_x.size(); ++i)
+    insert(static_cast<int>(i));
+}
+
+void ForceLayout::insert(int body) {
+  const double x = m_x[body];
+  const double y = m_y[body];
+  int c = 0;
+  for (int depth = 0;; ++depth) {
+    if (m_cells[c].child < 0) {
+      if (m_cells[c].mass == 0 || depth >= MAX_DEPTH) {
+        m_cells[c].mass += 1;
+        m_cells[c].sumX += x;
+        m_cells[c].sumY += y;
+        return;
+      }
+      // Split the leaf and push its single body one level down
+      int first = static_cast<int>(m_cells.size());
+      double half = m_cells[c].size / 2;
+      for (int q = 0; q < 4; ++q) {
+        Cell child;
+        child.x0 = m_cells[c].x0 + (q & 1 ? half : 0);
+        child.y0 = m_cells[c].y0 + (q & 2 ? half : 0);
+        child.size = half;
+        m_cells.push_back(child);
+      }
+      m_cells[c].child = first;
+      const Cell &leaf = m_cells[c];
+      Cell &moved = m_cells[first + quadrant(leaf, leaf.sumX, leaf.sumY)];
+      moved.mass = leaf.mass;
+      moved.sumX = leaf.sumX;
+      moved.sumY = leaf.sumY;
+    }
+    m_cells[c].mass += 1;
+    m_cells[c].sumX += x;
+    m_cells[c].sumY += y;
+    c = m_cells[c].child + quadrant(m_cells[c], x, y);
+  }
+}
+
+void ForceLayout::repulse(int body, std::vector<int> &stack) {
+  const double k2 = m_options.idealLength * m_options.idealLength;
+  const double theta2 = m_options.theta * m_options.theta;
+  const double x = m_x[body];
+  const double y = m_y[body];
+  double fx = 0;
+  double fy = 0;
+  stack.clear();
+  stack.push_back(0);
+  while (!stack.empty()) {
+    const Cell &cell = m_cells[stack.back()];
+    stack.pop_back();
+    if (cell.mass == 0)
+      continue;
+    double dx = x - cell.sumX / cell.mass;
+    double dy = y - cell.sumY / cell.mass;
+    double d2 = dx * dx + dy * dy;
+    if (cell.child >= 0 && cell.size * cell.size >= theta2 * d2) {
+      for (int q = 0; q < 4; ++q)
+        stack.push_back(cell.child + q);
+      continue;
+    }
+    // The body's own leaf sits at distance zero and is skipped here
+    if (d2 < MIN_DISTANCE2)
+      continue;
+    double f = k2 * cell.mass / d2;
+    fx += dx * f;
+    fy += dy * f;
+  }
+  m_fx[body] = fx;
+  m_fy[body] = fy;
+}
+
+bool ForceLayout::step() {
+  const size_t n = m_x.size();
+  if (n == 0 || m_iteration >= m_options.iterations)
+    return false;
+  ++m_iteration;
+
+  buildTree();
+  // The tree is read-only from here, so bodies can be split across threads
+  unsigned threads = m_options.threads;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+  if (n < PARALLEL_MIN || threads < 2) {
+    for (size_t i = 0; i < n; ++i)
+      repulse(static_cast<int>(i), m_stack);
+  } else {
+    std::vector<std::thread> pool;
+    size_t chunk = (n + threads - 1) / threads;
+    for (unsigned t = 1; t < threads; ++t) {
+      size_t begin = std::min(n, t * chunk);
+      size_t end = std::min(n, begin + chunk);
+      pool.emplace_back([this, begin, end]() {
+        std::vector<int> stack;
+        for (size_t i = begin; i < end; ++i)
+          repulse(static_cast<int>(i), stack);
+      });
+    }
+    for (size_t i = 0; i < std::min(n, chunk); ++i)
+      repulse(static_cast<int>(i), m_stack);
+    for (auto &t : pool)
+      t.join();
+  }
+
+  // Springs: gather, compute in a branch-free loop, then scatter
+  const double invK = 1.0 / m_options.idealLength;
+  const size_t e = m_from.size();
+  for (size_t i = 0; i < e; ++i) {
+    m_ex[i] = m_x[m_to[i]] - m_x[m_from[i]];
+    m_ey[i] = m_y[m_to[i]] - m_y[m_from[i]];
+  }
+  for (size_t i = 0; i < e; ++i) {
+    double d = std::sqrt(m_ex[i] * m_ex[i] + m_ey[i] * m_ey[i]) * invK;
+    m_ex[i] *= d;
+    m_ey[i] *= d;
+  }
+  for (size_t i = 0; i < e; ++i) {
+    m_fx[m_from[i]] += m_ex[i];
+    m_fy[m_from[i]] += m_ey[i];
+    m_fx[m_to[i]] -= m_ex[i];
+    m_fy[m_to[i]] -= m_ey[i];
+  }
+
+  double cx = 0;
+  double cy = 0;
+  for (size_t i = 0; i < n; ++i) {
+    cx += m_x[i];
+    cy += m_y[i];
+  }
+  cx /= n;
+  cy /= n;
+  const double g = m_options.gravity;
+  for (size_t i = 0; i < n; ++i) {
+    m_fx[i] -= g * (m_x[i] - cx);
+    m_fy[i] -= g * (m_y[i] - cy);
+  }
+
+  // Displacement capped by the temperature
+  double maxMove = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (m_pinned[i])
+      continue;
+    double len = std::sqrt(m_fx[i] * m_fx[i] + m_fy[i] * m_fy[i]);
+    if (len < 1e-9)
+      continue;
+    double move = std::min(len, m_temperature);
+    m_x[i] += m_fx[i] / len * move;
+    m_y[i] += m_fy[i] / len * move;
+    maxMove = std::max(maxMove, move);
+  }
+  m_temperature *= m_options.cooling;
+  return maxMove > SETTLED_MOVE && m_iteration < m_options.iterations;
+}
+
+ForceLayoutRunner::~ForceLayoutRunner() { stop(); }
+
+void ForceLayoutRunner::start(std::vector<LayoutPoint> positions,
+                              const std::vector<LayoutEdge> &edges,
+                              std::vector<char> pinned,
+                              const ForceLayout::Options &options) {
+  stop();
+  m_cancel = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_fresh = false;
+    m_finished = false;
+  }
+  // The snapshot is taken here, on the caller's thread; the worker never
+  // touches the board
+  auto layout = std::make_shared<ForceLayout>(std::move(positions), edges,
+                                              std::move(pinned), options);
+  m_thread = std::thread([this, layout]() {
+    using Clock = std::chrono::steady_clock;
+    auto lastFrame = Clock::now();
+    bool more = true;
+    while (more && !m_cancel) {
+      more = layout->step();
+      auto now = Clock::now();
+      if (more && now - lastFrame < std::chrono::milliseconds(FRAME_MS))
+        continue;
+      lastFrame = now;
+      std::vector<LayoutPoint> frame = layout->positions();
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_frame = std::move(frame);
+      m_fresh = true;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_finished = true;
+  });
+}
+
+void ForceLayoutRunner::stop() {
+  m_cancel = true;
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+bool ForceLayoutRunner::takeFrame(std::vector<LayoutPoint> *positions,
+                                  bool *finished) {
+  bool done;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    done = m_finished;
+    if (!m_fresh && !done)
+      return false;
+    if (m_fresh)
+      positions->swap(m_frame);
+    else
+      positions->clear();
+    m_fresh = false;
+  }
+  if (done && m_thread.joinable())
+    m_thread.join();
+  *finished = done;
+  return true;
+}
+
+} // namespace DevPlanner
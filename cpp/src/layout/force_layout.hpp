@@ -0,0 +1,96 @@
+#ifndef FORCE_LAYOUT_HPP
+#define FORCE_LAYOUT_HPP
+
+#include "layered_layout.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DevPlanner {
+
+// Fruchterman-Reingold style spring embedder. Repulsion goes through a
+// Barnes-Hut quadtree (O(n log n) per iteration), springs are computed over
+// flat edge arrays. Pinned nodes keep their place but still push and pull on
+// the others. Positions are node centres.
+class ForceLayout {
+public:
+  struct Options {
+    double idealLength = 320; // rest length of a spring
+    double theta = 1.0;       // Barnes-Hut opening angle
+    double gravity = 1.0;     // pull towards the centroid, keeps islands near
+    int iterations = 300;
+    double cooling = 0.97; // temperature factor per iteration
+    unsigned threads = 0;  // repulsion threads, 0: all cores but one
+  };
+
+  ForceLayout(std::vector<LayoutPoint> positions,
+              const std::vector<LayoutEdge> &edges, std::vector<char> pinned,
+              const Options &options);
+
+  // One iteration; false once the layout has cooled down or settled
+  bool step();
+  int iteration() const { return m_iteration; }
+  std::vector<LayoutPoint> positions() const;
+
+private:
+  struct Cell {
+    double x0, y0, size;
+    double mass = 0;
+    double sumX = 0, sumY = 0; // mass-weighted, centre = sum / mass
+    int child = -1;            // first of four consecutive cells
+  };
+
+  void buildTree();
+  void insert(int body);
+  int quadrant(const Cell &cell, double x, double y) const;
+  void repulse(int body, std::vector<int> &stack);
+
+  Options m_options;
+  int m_iteration = 0;
+  double m_temperature;
+  // Structure of arrays so the per-node and per-edge loops vectorize
+  std::vector<double> m_x, m_y, m_fx, m_fy;
+  std::vector<char> m_pinned;
+  std::vector<int> m_from, m_to;
+  std::vector<double> m_ex, m_ey;
+  std::vector<Cell> m_cells;
+  std::vector<int> m_stack;
+};
+
+// Runs a ForceLayout on a worker thread. The GUI polls takeFrame(), which
+// only ever hands out the newest positions, so a slow frame never queues up
+// stale ones.
+class ForceLayoutRunner {
+public:
+  // Minimum time between published frames
+  static constexpr int FRAME_MS = 16;
+
+  ForceLayoutRunner() = default;
+  ~ForceLayoutRunner();
+  ForceLayoutRunner(const ForceLayoutRunner &) = delete;
+  ForceLayoutRunner &operator=(const ForceLayoutRunner &) = delete;
+
+  void start(std::vector<LayoutPoint> positions,
+             const std::vector<LayoutEdge> &edges, std::vector<char> pinned,
+             const ForceLayout::Options &options);
+  // Blocks until the worker has left its current iteration
+  void stop();
+  bool isRunning() const { return m_thread.joinable(); }
+
+  // False when nothing new was published since the last call. finished is
+  // set with the last frame; the runner can then be started again.
+  bool takeFrame(std::vector<LayoutPoint> *positions, bool *finished);
+
+private:
+  std::thread m_thread;
+  std::atomic<bool> m_cancel{false};
+  std::mutex m_mutex;
+  std::vector<LayoutPoint> m_frame;
+  bool m_fresh = false;
+  bool m_finished = false;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,438 @@
+#include "layered_layout.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <thread>
+#include <utility>
+
+namespace DevPlanner {
+
+namespace {
+
+// Adjacency lists in one array: the neighbours of v are
+// targets[offsets[v] .. offsets[v + 1])
+struct Csr {
+  std::vector<int> offsets;
+  std::vector<int> targets;
+
+  void build(int n, const std::vector<std::pair<int, int>> &edges,
+             bool reverse) {
+    offsets.assign(n + 1, 0);
+    for (const auto &e : edges)
+      offsets[(reverse ? e.second : e.first) + 1]++;
+    for (int v = 0; v < n; ++v)
+      offsets[v + 1] += offsets[v];
+    targets.resize(edges.size());
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto &e : edges) {
+      int from = reverse ? e.second : e.first;
+      int to = reverse ? e.first : e.second;
+      targets[fill[from]++] = to;
+    }
+  }
+
+  int begin(int v) const { return offsets[v]; }
+  int end(int v) const { return offsets[v + 1]; }
+};
+
+struct Component {
+  std::vector<int> nodes;                  // global ids
+  std::vector<std::pair<int, int>> edges;  // local ids
+  std::vector<LayoutPoint> positions;      // local top-left corners
+  double width = 0;
+  double height = 0;
+};
+
+int findRoot(std::vector<int> &parent, int v) {
+  while (parent[v] != v) {
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
+  return v;
+}
+
+std::vector<Component> splitComponents(int n,
+                                       const std::vector<LayoutEdge> &edges) {
+  std::vector<int> parent(n);
+  std::iota(parent.begin(), parent.end(), 0);
+  for (const auto &e : edges) {
+    if (e.from < 0 || e.to < 0 || e.from >= n || e.to >= n)
+      continue;
+    int a = findRoot(parent, e.from);
+    int b = findRoot(parent, e.to);
+    if (a != b)
+      parent[std::max(a, b)] = std::min(a, b);
+  }
+
+  std::vector<int> componentOf(n, -1);
+  std::vector<int> local(n);
+  std::vector<Component> components;
+  for (int v = 0; v < n; ++v) {
+    int root = findRoot(parent, v);
+    if (componentOf[root] < 0) {
+      componentOf[root] = static_cast<int>(components.size());
+      components.emplace_back();
+    }
+    Component &c = components[componentOf[root]];
+    local[v] = static_cast<int>(c.nodes.size());
+    c.nodes.push_back(v);
+  }
+  for (const auto &e : edges) {
+    if (e.from < 0 || e.to < 0 || e.from >= n || e.to >= n ||
+        e.from == e.to)
+      continue;
+    Component &c = components[componentOf[findRoot(parent, e.from)]];
+    c.edges.emplace_back(local[e.from], local[e.to]);
+  }
+  return components;
+}
+
+// Reverses DFS back edges so the graph becomes acyclic
+void breakCycles(int n, std::vector<std::pair<int, int>> &edges) {
+  std::vector<std::pair<int, int>> indexed;
+  indexed.reserve(edges.size());
+  for (size_t i = 0; i < edges.size(); ++i)
+    indexed.emplace_back(edges[i].first, static_cast<int>(i));
+  Csr out;
+  out.offsets.assign(n + 1, 0);
+  for (const auto &e : edges)
+    out.offsets[e.first + 1]++;
+  for (int v = 0; v < n; ++v)
+    out.offsets[v + 1] += out.offsets[v];
+  std::vector<int> edgeAt(edges.size());
+  std::vector<int> fill(out.offsets.begin(), out.offsets.end() - 1);
+  for (size_t i = 0; i < edges.size(); ++i)
+    edgeAt[fill[edges[i].first]++] = static_cast<int>(i);
+
+  enum : char { White, Gray, Black };
+  std::vector<char> color(n, White);
+  std::vector<int> cursor(out.offsets.begin(), out.offsets.end() - 1);
+  std::vector<int> stack;
+  for (int root = 0; root < n; ++root) {
+    if (color[root] != White)
+      continue;
+    stack.push_back(root);
+    color[root] = Gray;
+    while (!stack.empty()) {
+      int v = stack.back();
+      if (cursor[v] == out.end(v)) {
+        color[v] = Black;
+        stack.pop_back();
+        continue;
+      }
+      int e = edgeAt[cursor[v]++];
+      int w = edges[e].second;
+      if (color[w] == Gray) {
+        std::swap(edges[e].first, edges[e].second);
+      } else if (color[w] == White) {
+        color[w] = Gray;
+        stack.push_back(w);
+      }
+    }
+  }
+}
+
+// Longest path from the sources, then sources are pulled down next to
+// their first successor so they do not all sit on layer 0
+std::vector<int> rankNodes(int n, const std::vector<std::pair<int, int>> &dag,
+                           std::vector<int> *topoOrder) {
+  Csr out;
+  out.build(n, dag, false);
+  std::vector<int> indegree(n, 0);
+  for (const auto &e : dag)
+    indegree[e.second]++;
+
+  std::vector<int> &order = *topoOrder;
+  order.clear();
+  order.reserve(n);
+  for (int v = 0; v < n; ++v) {
+    if (indegree[v] == 0)
+      order.push_back(v);
+  }
+  std::vector<int> rank(n, 0);
+  for (size_t i = 0; i < order.size(); ++i) {
+    int v = order[i];
+    for (int k = out.begin(v); k < out.end(v); ++k) {
+      int w = out.targets[k];
+      rank[w] = std::max(rank[w], rank[v] + 1);
+      if (--indegree[w] == 0)
+        order.push_back(w);
+    }
+  }
+
+  std::vector<int> indegreeAgain(n, 0);
+  for (const auto &e : dag)
+    indegreeAgain[e.second]++;
+  for (int v = 0; v < n; ++v) {
+    if (indegreeAgain[v] != 0 || out.begin(v) == out.end(v))
+      continue;
+    int minSucc = rank[out.targets[out.begin(v)]];
+    for (int k = out.begin(v); k < out.end(v); ++k)
+      minSucc = std::min(minSucc, rank[out.targets[k]]);
+    rank[v] = minSucc - 1;
+  }
+  return rank;
+}
+
+void layoutComponent(Component &c, const LayeredLayout::Options &o) {
+  const bool vertical =
+      o.direction == LayeredLayout::Direction::TopToBottom;
+  // Extent along the layer (order axis) and across layers
+  const double nodeExtent = vertical ? o.nodeWidth : o.nodeHeight;
+  const double layerExtent = vertical ? o.nodeHeight : o.nodeWidth;
+  const int n = static_cast<int>(c.nodes.size());
+
+  if (n == 1) {
+    c.positions = {LayoutPoint()};
+    c.width = o.nodeWidth;
+    c.height = o.nodeHeight;
+    return;
+  }
+
+  std::vector<std::pair<int, int>> dag = c.edges;
+  std::sort(dag.begin(), dag.end());
+  dag.erase(std::unique(dag.begin(), dag.end()), dag.end());
+  breakCycles(n, dag);
+
+  std::vector<int> topo;
+  std::vector<int> rank = rankNodes(n, dag, &topo);
+
+  // Long edges get a chain of dummy nodes so they keep a lane of their own.
+  // Past the budget they are left as direct edges and only pull on the
+  // ordering through their endpoints.
+  const size_t dummyBudget = 2 * (static_cast<size_t>(n) + dag.size());
+  std::vector<int> nodeRank = rank;
+  std::vector<std::pair<int, int>> links; // adjacent-layer or long
+  links.reserve(dag.size());
+  int total = n;
+  for (const auto &e : dag) {
+    int span = nodeRank[e.second] - nodeRank[e.first];
+    if (span <= 1 ||
+        static_cast<size_t>(total - n + span - 1) > dummyBudget) {
+      links.push_back(e);
+      continue;
+    }
+    int prev = e.first;
+    for (int k = 1; k < span; ++k) {
+      nodeRank.push_back(nodeRank[e.first] + k);
+      links.emplace_back(prev, total);
+      prev = total++;
+    }
+    links.emplace_back(prev, e.second);
+  }
+
+  Csr up;
+  Csr down;
+  up.build(total, links, true);
+  down.build(total, links, false);
+
+  int layerCount = 1 + *std::max_element(nodeRank.begin(), nodeRank.end());
+  std::vector<std::vector<int>> layers(layerCount);
+  // Topological order keeps chains next to each other from the start
+  std::vector<char> placed(total, 0);
+  for (int v : topo) {
+    layers[nodeRank[v]].push_back(v);
+    placed[v] = 1;
+    for (int k = down.begin(v); k < down.end(v); ++k) {
+      int w = down.targets[k];
+      while (w >= n && !placed[w]) {
+        layers[nodeRank[w]].push_back(w);
+        placed[w] = 1;
+        w = down.targets[down.begin(w)];
+      }
+    }
+  }
+
+  std::vector<double> norm(total);
+  auto renumber = [&](const std::vector<int> &layer) {
+    double size = static_cast<double>(layer.size());
+    for (size_t i = 0; i < layer.size(); ++i)
+      norm[layer[i]] = (i + 0.5) / size;
+  };
+  for (const auto &layer : layers)
+    renumber(layer);
+
+  std::vector<std::pair<double, int>> keyed;
+  auto reorder = [&](std::vector<int> &layer, const Csr &adj) {
+    keyed.clear();
+    for (int v : layer) {
+      double sum = 0;
+      int count = adj.end(v) - adj.begin(v);
+      for (int k = adj.begin(v); k < adj.end(v); ++k)
+        sum += norm[adj.targets[k]];
+      keyed.emplace_back(count > 0 ? sum / count : norm[v], v);
+    }
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [](const auto &a, const auto &b) {
+                       return a.first < b.first;
+                     });
+    for (size_t i = 0; i < layer.size(); ++i)
+      layer[i] = keyed[i].second;
+    renumber(layer);
+  };
+  for (int sweep = 0; sweep < o.sweeps; ++sweep) {
+    for (int l = 1; l < layerCount; ++l)
+      reorder(layers[l], up);
+    for (int l = layerCount - 2; l >= 0; --l)
+      reorder(layers[l], down);
+  }
+
+  // Centres along the order axis. Dummies are thin, so long edges cost
+  // little space.
+  const double dummyExtent = o.nodeGap / 2;
+  auto extent = [&](int v) { return v < n ? nodeExtent : dummyExtent; };
+  auto separation = [&](int a, int b) {
+    double gap = (a < n && b < n) ? o.nodeGap : o.nodeGap / 2;
+    return (extent(a) + extent(b)) / 2 + gap;
+  };
+
+  std::vector<double> x(total);
+  for (const auto &layer : layers) {
+    double cursor = 0;
+    for (size_t i = 0; i < layer.size(); ++i) {
+      if (i > 0)
+        cursor += separation(layer[i - 1], layer[i]);
+      x[layer[i]] = cursor;
+    }
+  }
+
+  // Each pass moves nodes towards the mean of their neighbours on one side,
+  // averaging a left-packed and a right-packed placement so the layer stays
+  // ordered and separated without drifting to one side
+  std::vector<double> desired, left, right;
+  auto balance = [&](const std::vector<int> &layer, const Csr &adj) {
+    size_t m = layer.size();
+    desired.resize(m);
+    left.resize(m);
+    right.resize(m);
+    for (size_t i = 0; i < m; ++i) {
+      int v = layer[i];
+      int count = adj.end(v) - adj.begin(v);
+      double sum = 0;
+      for (int k = adj.begin(v); k < adj.end(v); ++k)
+        sum += x[adj.targets[k]];
+      desired[i] = count > 0 ? sum / count : x[v];
+    }
+    for (size_t i = 0; i < m; ++i) {
+      left[i] = i == 0 ? desired[i]
+                       : std::max(desired[i],
+                                  left[i - 1] +
+                                      separation(layer[i - 1], layer[i]));
+    }
+    for (size_t i = m; i-- > 0;) {
+      right[i] = i + 1 == m ? desired[i]
+                            : std::min(desired[i],
+                                       right[i + 1] -
+                                           separation(layer[i], layer[i + 1]));
+    }
+    for (size_t i = 0; i < m; ++i)
+      x[layer[i]] = (left[i] + right[i]) / 2;
+  };
+  for (int pass = 0; pass < 4; ++pass) {
+    for (int l = 1; l < layerCount; ++l)
+      balance(layers[l], up);
+    for (int l = layerCount - 2; l >= 0; --l)
+      balance(layers[l], down);
+  }
+
+  double minEdge = x[0] - nodeExtent / 2;
+  double maxEdge = x[0] + nodeExtent / 2;
+  for (int v = 0; v < n; ++v) {
+    minEdge = std::min(minEdge, x[v] - nodeExtent / 2);
+    maxEdge = std::max(maxEdge, x[v] + nodeExtent / 2);
+  }
+  int minRank = *std::min_element(rank.begin(), rank.end());
+  int maxRank = *std::max_element(rank.begin(), rank.end());
+
+  c.positions.resize(n);
+  for (int v = 0; v < n; ++v) {
+    double along = x[v] - nodeExtent / 2 - minEdge;
+    double across = (rank[v] - minRank) * (layerExtent + o.layerGap);
+    c.positions[v] = vertical ? LayoutPoint{along, across}
+                              : LayoutPoint{across, along};
+  }
+  double alongSize = maxEdge - minEdge;
+  double acrossSize =
+      (maxRank - minRank) * (layerExtent + o.layerGap) + layerExtent;
+  c.width = vertical ? alongSize : acrossSize;
+  c.height = vertical ? acrossSize : alongSize;
+}
+
+} // namespace
+
+std::vector<LayoutPoint>
+LayeredLayout::compute(int nodeCount, const std::vector<LayoutEdge> &edges,
+                       const Options &options) {
+  std::vector<LayoutPoint> result(std::max(nodeCount, 0));
+  if (nodeCount <= 0)
+    return result;
+
+  std::vector<Component> components = splitComponents(nodeCount, edges);
+  // Biggest first: they set the row width and take longest to lay out
+  std::stable_sort(components.begin(), components.end(),
+                   [](const Component &a, const Component &b) {
+                     return a.nodes.size() > b.nodes.size();
+                   });
+
+  unsigned threads = options.threads > 0
+                         ? options.threads
+                         : std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min<unsigned>(threads, components.size());
+  // Thread start-up costs more than laying out a few hundred nodes
+  if (nodeCount < 2000)
+    threads = 1;
+
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next++; i < components.size(); i = next++)
+      layoutComponent(components[i], options);
+  };
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t)
+    pool.emplace_back(worker);
+  worker();
+  for (auto &t : pool)
+    t.join();
+
+  // Shelf packing: rows about as wide as the drawing is tall overall
+  double area = 0;
+  double widest = 0;
+  for (const auto &c : components) {
+    area += (c.width + options.componentGap) *
+            (c.height + options.componentGap);
+    widest = std::max(widest, c.width);
+  }
+  double rowWidth = std::max(widest, std::sqrt(area) * 1.2);
+  double cursorX = 0;
+  double cursorY = 0;
+  double rowHeight = 0;
+  for (const auto &c : components) {
+    if (cursorX > 0 && cursorX + c.width > rowWidth) {
+      cursorX = 0;
+      cursorY += rowHeight + options.componentGap;
+      rowHeight = 0;
+    }
+    for (size_t i = 0; i < c.nodes.size(); ++i) {
+      result[c.nodes[i]] = {cursorX + c.positions[i].x,
+                            cursorY + c.positions[i].y};
+    }
+    cursorX += c.width + options.componentGap;
+    rowHeight = std::max(rowHeight, c.height);
+  }
+  return result;
+}
+
+std::vector<LayoutPoint> LayeredLayout::grid(int nodeCount,
+                                             const Options &options) {
+  std::vector<LayoutPoint> result(std::max(nodeCount, 0));
+  int columns = std::max(1, static_cast<int>(std::ceil(
+                                std::sqrt(static_cast<double>(nodeCount)))));
+  for (int i = 0; i < nodeCount; ++i) {
+    result[i] = {(i % columns) * (options.nodeWidth + options.nodeGap),
+                 (i / columns) * (options.nodeHeight + options.layerGap)};
+  }
+  return result;
+}
+
+} // namespace DevPlanner
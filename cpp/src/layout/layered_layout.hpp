@@ -0,0 +1,49 @@
+#ifndef LAYERED_LAYOUT_HPP
+#define LAYERED_LAYOUT_HPP
+
+#include <vector>
+
+namespace DevPlanner {
+
+struct LayoutPoint {
+  double x = 0;
+  double y = 0;
+};
+
+struct LayoutEdge {
+  int from;
+  int to;
+};
+
+// Sugiyama-style layered drawing of a directed graph: DFS cycle breaking,
+// longest-path ranking, dummy nodes for long edges, barycentric crossing
+// reduction and a balanced coordinate pass. Connected components are laid
+// out independently (in parallel) and packed in rows. Plain std types, so
+// it can run off the GUI thread.
+class LayeredLayout {
+public:
+  enum class Direction { TopToBottom, LeftToRight };
+
+  struct Options {
+    Direction direction = Direction::TopToBottom;
+    double nodeWidth = 220;
+    double nodeHeight = 140;
+    double nodeGap = 40;  // between neighbours in a layer
+    double layerGap = 80; // between layers
+    double componentGap = 120;
+    int sweeps = 4;       // down+up barycenter passes
+    unsigned threads = 0; // 0: hardware concurrency
+  };
+
+  // Top-left corner of every node, with the drawing starting at (0, 0)
+  static std::vector<LayoutPoint> compute(int nodeCount,
+                                          const std::vector<LayoutEdge> &edges,
+                                          const Options &options);
+
+  // Nodes in rows of ceil(sqrt(n)), in the given order
+  static std::vector<LayoutPoint> grid(int nodeCount, const Options &options);
+};
+
+} // namespace DevPlanner
+
+#endif
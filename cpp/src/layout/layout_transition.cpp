@@ -0,0 +1,63 @@
+#include "layout_transition.hpp"
+#include <algorithm>
+
+namespace DevPlanner {
+
+double LayoutTransition::ease(Easing easing, double t) {
+  t = std::clamp(t, 0.0, 1.0);
+  switch (easing) {
+  case Easing::Linear:
+    return t;
+  case Easing::OutCubic: {
+    double u = 1 - t;
+    return 1 - u * u * u;
+  }
+  case Easing::InOutCubic: {
+    if (t < 0.5)
+      return 4 * t * t * t;
+    double u = -2 * t + 2;
+    return 1 - u * u * u / 2;
+  }
+  }
+  return t;
+}
+
+void LayoutTransition::start(const std::vector<LayoutPoint> &from,
+                             const std::vector<LayoutPoint> &to,
+                             double durationMs, Easing easing) {
+  size_t n = std::min(from.size(), to.size());
+  m_fromX.resize(n);
+  m_fromY.resize(n);
+  m_deltaX.resize(n);
+  m_deltaY.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    m_fromX[i] = from[i].x;
+    m_fromY[i] = from[i].y;
+    m_deltaX[i] = to[i].x - from[i].x;
+    m_deltaY[i] = to[i].y - from[i].y;
+  }
+  m_duration = durationMs;
+  m_easing = easing;
+}
+
+void LayoutTransition::clear() {
+  m_fromX.clear();
+  m_fromY.clear();
+  m_deltaX.clear();
+  m_deltaY.clear();
+}
+
+bool LayoutTransition::sample(double elapsedMs,
+                              std::vector<LayoutPoint> *out) const {
+  bool running = elapsedMs < m_duration;
+  double k = running ? ease(m_easing, elapsedMs / m_duration) : 1.0;
+  size_t n = m_fromX.size();
+  out->resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    (*out)[i].x = m_fromX[i] + m_deltaX[i] * k;
+    (*out)[i].y = m_fromY[i] + m_deltaY[i] * k;
+  }
+  return running;
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,42 @@
+#ifndef LAYOUT_TRANSITION_HPP
+#define LAYOUT_TRANSITION_HPP
+
+#include "layered_layout.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace DevPlanner {
+
+// Interpolates a whole set of node positions at once, so an arrange over
+// thousands of nodes costs one loop per frame instead of one animation
+// object per node. Time-based: a slow frame skips ahead rather than
+// stretching the transition.
+class LayoutTransition {
+public:
+  enum class Easing { Linear, OutCubic, InOutCubic };
+
+  static double ease(Easing easing, double t);
+
+  void start(const std::vector<LayoutPoint> &from,
+             const std::vector<LayoutPoint> &to, double durationMs,
+             Easing easing = Easing::InOutCubic);
+  void clear();
+  bool isEmpty() const { return m_fromX.empty(); }
+  size_t size() const { return m_fromX.size(); }
+
+  // Positions at elapsedMs into out; false once the transition is over, in
+  // which case out holds the exact targets
+  bool sample(double elapsedMs, std::vector<LayoutPoint> *out) const;
+  LayoutPoint target(size_t i) const {
+    return {m_fromX[i] + m_deltaX[i], m_fromY[i] + m_deltaY[i]};
+  }
+
+private:
+  std::vector<double> m_fromX, m_fromY, m_deltaX, m_deltaY;
+  double m_duration = 0;
+  Easing m_easing = Easing::InOutCubic;
+};
+
+} // namespace DevPlanner
+
+#endif
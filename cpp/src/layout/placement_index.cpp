@@ -0,0 +1,101 @@
+#include "placement_index.hpp"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <tuple>
+#include <unordered_set>
+
+namespace DevPlanner {
+
+namespace {
+// Safety net for pathological boards; past it the rectangle goes below
+// everything
+constexpr int MAX_CANDIDATES = 100000;
+} // namespace
+
+PlacementIndex::PlacementIndex(double cellSize) : m_cellSize(cellSize) {}
+
+void PlacementIndex::clear() {
+  m_rects.clear();
+  m_cells.clear();
+}
+
+PlacementIndex::Key PlacementIndex::key(std::int64_t cx,
+                                        std::int64_t cy) const {
+  return (static_cast<Key>(static_cast<std::uint32_t>(cx)) << 32) |
+         static_cast<std::uint32_t>(cy);
+}
+
+std::int64_t PlacementIndex::cell(double v) const {
+  return static_cast<std::int64_t>(std::floor(v / m_cellSize));
+}
+
+void PlacementIndex::insert(const LayoutRect &rect) {
+  int id = static_cast<int>(m_rects.size());
+  m_rects.push_back(rect);
+  for (auto cx = cell(rect.x); cx <= cell(rect.x + rect.width); ++cx) {
+    for (auto cy = cell(rect.y); cy <= cell(rect.y + rect.height); ++cy)
+      m_cells[key(cx, cy)].push_back(id);
+  }
+}
+
+int PlacementIndex::blocker(const LayoutRect &rect, double gap) const {
+  double left = rect.x - gap;
+  double top = rect.y - gap;
+  double right = rect.x + rect.width + gap;
+  double bottom = rect.y + rect.height + gap;
+  for (auto cx = cell(left); cx <= cell(right); ++cx) {
+    for (auto cy = cell(top); cy <= cell(bottom); ++cy) {
+      auto it = m_cells.find(key(cx, cy));
+      if (it == m_cells.end())
+        continue;
+      for (int id : it->second) {
+        const LayoutRect &r = m_rects[id];
+        if (r.x < right && left < r.x + r.width && r.y < bottom &&
+            top < r.y + r.height)
+          return id;
+      }
+    }
+  }
+  return -1;
+}
+
+LayoutPoint PlacementIndex::findFree(const LayoutPoint &anchor, double width,
+                                     double height, double gap) const {
+  using Candidate = std::tuple<double, double, double>; // distance², x, y
+  std::priority_queue<Candidate, std::vector<Candidate>,
+                      std::greater<Candidate>>
+      open;
+  std::unordered_set<Key> seen;
+  auto push = [&](double x, double y) {
+    Key k = key(std::llround(x), std::llround(y));
+    if (!seen.insert(k).second)
+      return;
+    double dx = x - anchor.x;
+    double dy = y - anchor.y;
+    open.emplace(dx * dx + dy * dy, x, y);
+  };
+
+  push(anchor.x, anchor.y);
+  for (int visited = 0; !open.empty() && visited < MAX_CANDIDATES;
+       ++visited) {
+    auto [distance, x, y] = open.top();
+    open.pop();
+    int b = blocker({x, y, width, height}, gap);
+    if (b < 0)
+      return {x, y};
+    // Step past the blocker on each side, keeping the other coordinate
+    const LayoutRect &r = m_rects[b];
+    push(r.x + r.width + gap, y);
+    push(r.x - gap - width, y);
+    push(x, r.y + r.height + gap);
+    push(x, r.y - gap - height);
+  }
+
+  double bottom = anchor.y;
+  for (const auto &r : m_rects)
+    bottom = std::max(bottom, r.y + r.height + gap);
+  return {anchor.x, bottom};
+}
+
+} // namespace DevPlanner
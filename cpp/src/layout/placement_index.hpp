@@ -0,0 +1,49 @@
+#ifndef PLACEMENT_INDEX_HPP
+#define PLACEMENT_INDEX_HPP
+
+#include "layered_layout.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace DevPlanner {
+
+struct LayoutRect {
+  double x = 0;
+  double y = 0;
+  double width = 0;
+  double height = 0;
+};
+
+// Occupied rectangles in a spatial hash grid, for dropping new nodes into
+// free space. Insert-only: callers rebuild it after moves and deletes.
+class PlacementIndex {
+public:
+  explicit PlacementIndex(double cellSize = 256);
+
+  void clear();
+  void insert(const LayoutRect &rect);
+  int size() const { return static_cast<int>(m_rects.size()); }
+
+  // Top-left corner closest to anchor where a width x height rectangle
+  // keeps gap from everything in the index. Candidates are generated by
+  // stepping past whatever blocks the current one, nearest first, so the
+  // cost grows with the obstacles around the anchor, not the board size.
+  LayoutPoint findFree(const LayoutPoint &anchor, double width, double height,
+                       double gap) const;
+
+private:
+  using Key = std::uint64_t;
+  Key key(std::int64_t cx, std::int64_t cy) const;
+  std::int64_t cell(double v) const;
+  // Index of a rectangle closer than gap to rect, -1 when there is none
+  int blocker(const LayoutRect &rect, double gap) const;
+
+  double m_cellSize;
+  std::vector<LayoutRect> m_rects;
+  std::unordered_map<Key, std::vector<int>> m_cells;
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -0,0 +1,157 @@
+#include "skyline_packer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <queue>
+#include <tuple>
+
+namespace DevPlanner {
+
+namespace {
+
+constexpr double EPSILON = 1e-9;
+
+// Segments of the skyline as a doubly linked list over arrays. Heap entries
+// carry the segment's version and are dropped when it no longer matches.
+class Skyline {
+public:
+  explicit Skyline(double width) { add(0, width, 0, -1, -1); }
+
+  // Places a w x h rectangle in the lowest valley and returns its corner
+  LayoutPoint place(double w, double h) {
+    for (;;) {
+      int s = lowest();
+      if (w <= m_w[s] + EPSILON) {
+        LayoutPoint corner{m_x[s], m_y[s]};
+        if (w >= m_w[s] - EPSILON) {
+          m_y[s] += h;
+          merge(s);
+        } else {
+          int t = add(m_x[s], w, m_y[s] + h, m_prev[s], s);
+          m_x[s] += w;
+          m_w[s] -= w;
+          touch(s);
+          merge(t);
+        }
+        return corner;
+      }
+      // Too narrow: fill the valley up to its lower neighbour
+      double level = -1;
+      if (m_prev[s] >= 0)
+        level = m_y[m_prev[s]];
+      if (m_next[s] >= 0)
+        level = level < 0 ? m_y[m_next[s]] : std::min(level, m_y[m_next[s]]);
+      if (level < 0) {
+        // The block is narrower than the item; it overhangs on the right
+        LayoutPoint corner{m_x[s], m_y[s]};
+        m_y[s] += h;
+        touch(s);
+        return corner;
+      }
+      m_y[s] = level;
+      merge(s);
+    }
+  }
+
+private:
+  using Entry = std::tuple<double, double, int, int>; // y, x, segment, version
+
+  int add(double x, double w, double y, int prev, int next) {
+    int s = static_cast<int>(m_x.size());
+    m_x.push_back(x);
+    m_w.push_back(w);
+    m_y.push_back(y);
+    m_prev.push_back(prev);
+    m_next.push_back(next);
+    m_version.push_back(0);
+    m_alive.push_back(1);
+    if (prev >= 0)
+      m_next[prev] = s;
+    if (next >= 0)
+      m_prev[next] = s;
+    m_heap.emplace(y, x, s, 0);
+    return s;
+  }
+
+  void touch(int s) {
+    m_heap.emplace(m_y[s], m_x[s], s, ++m_version[s]);
+  }
+
+  void unlink(int s) {
+    m_alive[s] = 0;
+    if (m_prev[s] >= 0)
+      m_next[m_prev[s]] = m_next[s];
+    if (m_next[s] >= 0)
+      m_prev[m_next[s]] = m_prev[s];
+  }
+
+  // Absorbs neighbours at the same height so valleys stay valleys
+  void merge(int s) {
+    int p = m_prev[s];
+    if (p >= 0 && std::abs(m_y[p] - m_y[s]) < EPSILON) {
+      m_x[s] = m_x[p];
+      m_w[s] += m_w[p];
+      unlink(p);
+    }
+    int n = m_next[s];
+    if (n >= 0 && std::abs(m_y[n] - m_y[s]) < EPSILON) {
+      m_w[s] += m_w[n];
+      unlink(n);
+    }
+    touch(s);
+  }
+
+  int lowest() {
+    for (;;) {
+      auto [y, x, s, version] = m_heap.top();
+      if (m_alive[s] && version == m_version[s])
+        return s;
+      m_heap.pop();
+    }
+  }
+
+  std::vector<double> m_x, m_w, m_y;
+  std::vector<int> m_prev, m_next, m_version;
+  std::vector<char> m_alive;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_heap;
+};
+
+} // namespace
+
+std::vector<LayoutPoint>
+SkylinePacker::pack(const std::vector<PackItem> &items,
+                    const Options &options) {
+  std::vector<LayoutPoint> result(items.size());
+  std::map<int, std::vector<int>> groups;
+  for (size_t i = 0; i < items.size(); ++i)
+    groups[items[i].group].push_back(static_cast<int>(i));
+
+  double blockX = 0;
+  for (auto &entry : groups) {
+    std::vector<int> &members = entry.second;
+    std::stable_sort(members.begin(), members.end(), [&](int a, int b) {
+      return items[a].height > items[b].height;
+    });
+    double area = 0;
+    double widest = 0;
+    for (int i : members) {
+      double w = items[i].width + options.gap;
+      area += w * (items[i].height + options.gap);
+      widest = std::max(widest, w);
+    }
+    double width = std::max(widest, std::sqrt(area * options.aspect));
+
+    Skyline skyline(width);
+    double right = 0;
+    for (int i : members) {
+      LayoutPoint corner = skyline.place(items[i].width + options.gap,
+                                         items[i].height + options.gap);
+      result[i] = {blockX + corner.x, corner.y};
+      right = std::max(right, corner.x + items[i].width);
+    }
+    blockX += right + options.groupGap;
+  }
+  return result;
+}
+
+} // namespace DevPlanner
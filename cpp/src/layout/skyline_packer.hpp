@@ -0,0 +1,37 @@
+#ifndef SKYLINE_PACKER_HPP
+#define SKYLINE_PACKER_HPP
+
+#include "layered_layout.hpp"
+#include <vector>
+
+namespace DevPlanner {
+
+struct PackItem {
+  double width = 0;
+  double height = 0;
+  int group = 0; // items of one group are packed into one block
+};
+
+// Skyline packing for unconnected boards. Each group gets a block about
+// Options::aspect times wider than tall; blocks are laid side by side in
+// ascending group order. Within a block items go into the lowest skyline
+// valley (tallest items first, ties keep the input order). A valley that is
+// too narrow is raised to its lower neighbour and merged. Every item and
+// every raise touches a constant number of segments, so with the heap of
+// segments the whole pack is O(n log n).
+class SkylinePacker {
+public:
+  struct Options {
+    double gap = 20; // between items
+    double groupGap = 120;
+    double aspect = 1.6; // block width / height
+  };
+
+  // Top-left corner of every item, starting at (0, 0)
+  static std::vector<LayoutPoint> pack(const std::vector<PackItem> &items,
+                                       const Options &options);
+};
+
+} // namespace DevPlanner
+
+#endif
@@ -1,103 +1,84 @@
 #include "ai_chat_panel.hpp"
+#include "chat_message_delegate.hpp"
 #include "../ai/ai_action_registry.hpp"
+#include "../ai/ai_response_parser.hpp"
+#include "../ai/local_command_parser.hpp"
+#include "../ai/providers/provider_registry.hpp"
 #include "core/config.hpp"
 #include "core/storage.hpp"
+#include <QApplication>
+#include <QClipboard>
+#include <QElapsedTimer>
 #include <QFrame>
 #include <QHBoxLayout>
 #include <QInputDialog>
 #include <QJsonDocument>
 #include <QRegularExpression>
 #include <QScrollBar>
-#include <QSslError>
+#include <QShortcut>
+#include <QSignalBlocker>
 #include <QTimer>
 #include <QVBoxLayout>
+#include <algorithm>
 
 namespace DevPlanner {
 
-const QString AIChatPanel::OPENROUTER_API_URL =
-    "https://openrouter.ai/api/v1/chat/completions";
-
+// Actions are described by the "tools" array of each request
 const QString AIChatPanel::SYSTEM_PROMPT =
     R"(Ты — AI-ассистент Dev Planner. Помогай управлять задачами.
 
 ПРАВИЛА:
-1. Для ДЕЙСТВИЙ над задачами ВСЕГДА возвращай ТОЛЬКО чистый JSON без текста
+1. Для ДЕЙСТВИЙ над задачами вызывай инструменты (можно несколько за раз)
 2. Для ВОПРОСОВ и советов отвечай текстом
+3. Нумерация задач с 1, как в списке ТЕКУЩИЕ ЗАДАЧИ)";
 
-ДЕЙСТВИЯ (только JSON, без текста вокруг):
-{"action": "create_task", "title": "...", "description": "...", "status": "todo"}
-{"actions": [{"action": "create_task", "title": "...", "description": "...", "status": "todo"}, ...]}
-{"action": "set_status", "task": 1, "status": "done"}
-{"action": "set_many_status", "tasks": [1,2,3,4], "status": "done"}
-{"action": "connect", "from": 1, "to": 2}
-{"action": "connect_many", "connections": [[1,2],[2,3]]}
-{"action": "rename", "task": 1, "title": "..."}
-{"action": "delete", "task": 1}
-{"action": "clear_all"}
-{"action": "arrange_tree"}
-
-СТАТУСЫ: todo, progress, done, none
-Нумерация задач с 1.
-
-ПРИМЕРЫ:
-"сделай все задачи готовыми" → {"action": "set_many_status", "tasks": [1,2,3,4], "status": "done"}
-"создай 3 задачи" → {"actions": [{"action": "create_task", "title": "Задача 1", "description": "", "status": "todo"}, ...]}
-"что такое agile?" → Отвечай текстом)";
-
-ChatMessage::ChatMessage(const QString &text, bool isUser, QWidget *parent)
-    : QFrame(parent) {
-  auto *layout = new QVBoxLayout(this);
-  layout->setContentsMargins(16, 12, 16, 12);
-  layout->setSpacing(6);
-
-  auto *label = new QLabel(isUser ? "ВЫ" : "AI ASSISTANT", this);
-  label->setStyleSheet(
-      QString(
-          "color: %1; font-size: 9px; font-weight: 900; letter-spacing: 2px;")
-          .arg(isUser ? "#d900ff" : "#00ff9d"));
-  label->setAlignment(isUser ? Qt::AlignRight : Qt::AlignLeft);
-
-  auto *message = new QLabel(text, this);
-  message->setWordWrap(true);
-  message->setStyleSheet(
-      QString("color: %1; font-size: 14px;")
-          .arg(isUser ? "#ffffff" : "rgba(255,255,255,0.9)"));
-  message->setTextInteractionFlags(Qt::TextSelectableByMouse);
-
-  layout->addWidget(label);
-  layout->addWidget(message);
-
-  QString bg = isUser ? "rgba(217, 0, 255, 0.15)" : "rgba(0, 255, 157, 0.08)";
-  QString border =
-      isUser ? "rgba(217, 0, 255, 0.4)" : "rgba(0, 255, 157, 0.25)";
-  QString marginStyle = isUser ? "margin-left: 40px;" : "margin-right: 40px;";
-
-  setStyleSheet(
-      QString("ChatMessage { background: %1; border: 1px solid %2; "
-              "border-radius: 16px; %3 margin-top: 6px; margin-bottom: 6px; }")
-          .arg(bg, border, marginStyle));
-}
-
-AIChatPanel::AIChatPanel(QWidget *parent) : GlassmorphismWidget(parent) {
-  m_networkManager = new QNetworkAccessManager(this);
-  connect(m_networkManager, &QNetworkAccessManager::finished, this,
-          &AIChatPanel::onNetworkReply);
-
-#ifdef Q_OS_WIN
-  connect(m_networkManager, &QNetworkAccessManager::sslErrors, this,
-          [](QNetworkReply *reply, const QList<QSslError> &errors) {
-            reply->ignoreSslErrors();
-          });
-#endif
-
+AIChatPanel::AIChatPanel(QWidget *parent)
+    : GlassmorphismWidget(parent), m_cache(getCacheDir()) {
   m_apiKey = Storage::loadApiKey();
   m_models = Storage::loadModels(m_currentModel);
 
-  QJsonObject systemMsg;
-  systemMsg["role"] = "system";
-  systemMsg["content"] = SYSTEM_PROMPT;
-  m_messages.append(systemMsg);
+  m_providers = new ProviderRegistry(this);
+  m_providers->load();
+  QJsonObject settings = Storage::loadSettings();
+  m_currentProvider = settings["provider"].toString("openrouter");
+  AIProvider *provider = m_providers->provider(m_currentProvider);
+  if (!provider && !m_providers->providers().isEmpty()) {
+    provider = m_providers->providers().first();
+    m_currentProvider = provider->id();
+  }
+  if (provider && m_currentProvider != "openrouter") {
+    m_currentModel = settings["model"].toString();
+    if (!provider->config().models.contains(m_currentModel))
+      m_currentModel = provider->config().models.value(0);
+  }
+
+  QJsonObject hedgeSettings = settings["hedge"].toObject();
+  m_hedgeEnabled = hedgeSettings["enabled"].toBool(false);
+  m_hedgeModel = hedgeSettings["secondary"].toString();
+  m_hedgePolicy.setBaseDelay(hedgeSettings["delay_ms"].toInt(4000));
+  m_hedgePolicy.setAutoTune(hedgeSettings["auto_delay"].toBool(true));
+
+  // Exact counts need a local vocabulary; otherwise counts are estimated.
+  // cl100k_base is the default because pretokenize() splits like it does.
+  QString tokenizer = settings["tokenizer"].toString("cl100k_base");
+  for (const auto &name : {tokenizer, QString("cl100k_base")}) {
+    if (m_tokenizer.load(getTokenizerDir() + "/" + name + ".tiktoken"))
+      break;
+  }
+
+  m_maxInFlight =
+      qMax(1, settings["queue"].toObject()["max_in_flight"].toInt(3));
+
+  QJsonObject cacheSettings = settings["cache"].toObject();
+  m_cache.setEnabled(cacheSettings["enabled"].toBool(true));
+  if (cacheSettings.contains("max_mb"))
+    m_cache.setMaxBytes(
+        static_cast<qint64>(cacheSettings["max_mb"].toDouble() * 1024 * 1024));
+  if (cacheSettings.contains("ttl_hours"))
+    m_cache.setTtlSeconds(
+        static_cast<qint64>(cacheSettings["ttl_hours"].toDouble() * 3600));
 
+  resetMessages();
   setupUI();
 }
 
@@ -113,6 +94,22 @@ void AIChatPanel::setupUI() {
   headerLayout->addWidget(header);
   headerLayout->addStretch();
 
+  m_modelSelector = new QComboBox(this);
+  m_modelSelector->setCursor(Qt::PointingHandCursor);
+  m_modelSelector->setStyleSheet(
+      "QComboBox { background: rgba(255,255,255,0.05); color: #ffffff; "
+      "border: 1px solid rgba(255,255,255,0.1); border-radius: 10px; "
+      "padding: 4px 10px; font-size: 11px; } "
+      "QComboBox QAbstractItemView { background: #1a1a1e; color: #ffffff; "
+      "selection-background-color: rgba(217,0,255,0.3); }");
+  updateModelSelector();
+  connect(m_modelSelector, &QComboBox::currentIndexChanged, this,
+          &AIChatPanel::onModelChanged);
+  for (auto *p : m_providers->providers())
+    connect(p, &AIProvider::statsChanged, this,
+            &AIChatPanel::updateModelSelector);
+  headerLayout->addWidget(m_modelSelector);
+
   auto *apiKeyBtn = new QPushButton("⚙", this);
   apiKeyBtn->setFixedSize(32, 32);
   apiKeyBtn->setCursor(Qt::PointingHandCursor);
@@ -121,25 +118,80 @@ void AIChatPanel::setupUI() {
       "border-radius: 16px; font-size: 16px; } QPushButton:hover { background: "
       "rgba(217,0,255,0.2); }");
   connect(apiKeyBtn, &QPushButton::clicked, this, &AIChatPanel::onApiKeySetup);
+
+  m_cacheBtn = new QPushButton("⚡", this);
+  m_cacheBtn->setFixedSize(32, 32);
+  m_cacheBtn->setCursor(Qt::PointingHandCursor);
+  m_cacheBtn->setCheckable(true);
+  m_cacheBtn->setChecked(m_cache.isEnabled());
+  m_cacheBtn->setStyleSheet(
+      "QPushButton { background: rgba(255,255,255,0.05); color: "
+      "rgba(255,255,255,0.4); border-radius: 16px; font-size: 14px; } "
+      "QPushButton:checked { color: #00ff9d; } QPushButton:hover { "
+      "background: rgba(0,255,157,0.2); }");
+  connect(m_cacheBtn, &QPushButton::toggled, this,
+          &AIChatPanel::onCacheToggled);
+  updateCacheButton();
+
+  m_hedgeBtn = new QPushButton("⑂", this);
+  m_hedgeBtn->setFixedSize(32, 32);
+  m_hedgeBtn->setCursor(Qt::PointingHandCursor);
+  m_hedgeBtn->setCheckable(true);
+  m_hedgeBtn->setChecked(m_hedgeEnabled);
+  m_hedgeBtn->setStyleSheet(
+      "QPushButton { background: rgba(255,255,255,0.05); color: "
+      "rgba(255,255,255,0.4); border-radius: 16px; font-size: 14px; } "
+      "QPushButton:checked { color: #00d4ff; } QPushButton:hover { "
+      "background: rgba(0,212,255,0.2); }");
+  connect(m_hedgeBtn, &QPushButton::toggled, this,
+          &AIChatPanel::onHedgeToggled);
+  updateHedgeButton();
+
+  headerLayout->addWidget(m_hedgeBtn);
+  headerLayout->addWidget(m_cacheBtn);
   headerLayout->addWidget(apiKeyBtn);
 
   layout->addLayout(headerLayout);
 
-  m_scrollArea = new QScrollArea(this);
-  m_scrollArea->setWidgetResizable(true);
-  m_scrollArea->setStyleSheet(
-      "QScrollArea { background: transparent; border: none; } "
+  // Rows are painted by the delegate; only visible ones get text layouts,
+  // the rest are laid out from cheap height estimates
+  m_transcript = new ChatTranscriptModel(this);
+  m_transcriptView = new QListView(this);
+  m_transcriptView->setModel(m_transcript);
+  m_transcriptView->setItemDelegate(new ChatMessageDelegate(m_transcriptView));
+  m_transcriptView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+  m_transcriptView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  m_transcriptView->setResizeMode(QListView::Adjust);
+  m_transcriptView->setUniformItemSizes(false);
+  m_transcriptView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+  m_transcriptView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_transcriptView->setFrameShape(QFrame::NoFrame);
+  m_transcriptView->setStyleSheet(
+      "QListView { background: transparent; border: none; outline: none; } "
+      "QListView::item, QListView::item:selected, QListView::item:hover { "
+      "background: transparent; } "
       "QScrollBar:vertical { background: transparent; width: 4px; } "
       "QScrollBar::handle:vertical { background: rgba(255,255,255,0.1); "
       "border-radius: 2px; }");
+  layout->addWidget(m_transcriptView, 1);
+  connect(m_transcriptView->verticalScrollBar(), &QScrollBar::valueChanged,
+          this, [this](int value) {
+            if (value == m_transcriptView->verticalScrollBar()->minimum() &&
+                m_transcriptFrom > 0)
+              loadOlderHistory();
+          });
 
-  m_messagesWidget = new QWidget(this);
-  m_messagesWidget->setStyleSheet("background: transparent;");
-  m_messagesLayout = new QVBoxLayout(m_messagesWidget);
-  m_messagesLayout->setAlignment(Qt::AlignTop);
-  m_messagesLayout->setSpacing(12);
-  m_scrollArea->setWidget(m_messagesWidget);
-  layout->addWidget(m_scrollArea, 1);
+  auto *copyShortcut = new QShortcut(QKeySequence::Copy, m_transcriptView);
+  copyShortcut->setContext(Qt::WidgetShortcut);
+  connect(copyShortcut, &QShortcut::activated, this, [this]() {
+    QModelIndexList rows = m_transcriptView->selectionModel()->selectedRows();
+    std::sort(rows.begin(), rows.end());
+    QStringList texts;
+    for (const auto &row : rows)
+      texts.append(row.data().toString());
+    if (!texts.isEmpty())
+      QApplication::clipboard()->setText(texts.join("\n\n"));
+  });
 
   auto *inputFrame = new QFrame(this);
   inputFrame->setStyleSheet(
@@ -163,198 +215,665 @@ void AIChatPanel::setupUI() {
       "font-weight: bold; } QPushButton:hover { background: #ff00ff; }");
   connect(m_sendBtn, &QPushButton::clicked, this, &AIChatPanel::onSendClicked);
 
+  m_tokenLabel = new QLabel(this);
+  m_tokenLabel->setStyleSheet("QLabel { color: rgba(255,255,255,0.35); "
+                              "font-size: 11px; border: none; }");
+  connect(m_inputField, &QLineEdit::textChanged, this,
+          &AIChatPanel::updateTokenCounter);
+
   inputLayout->addWidget(m_inputField);
+  inputLayout->addWidget(m_tokenLabel);
   inputLayout->addWidget(m_sendBtn);
   layout->addWidget(inputFrame);
+
+  auto *statusLayout = new QHBoxLayout();
+  statusLayout->setContentsMargins(0, 0, 10, 0);
+  m_statusLabel = new QLabel(this);
+  m_statusLabel->setStyleSheet(
+      "color: rgba(255,255,255,0.4); font-size: 11px; padding-left: 15px;");
+  m_statusLabel->hide();
+  statusLayout->addWidget(m_statusLabel, 1);
+
+  m_cancelBatchBtn = new QPushButton("✕", this);
+  m_cancelBatchBtn->setFixedSize(20, 20);
+  m_cancelBatchBtn->setToolTip("Остановить выполнение действий");
+  m_cancelBatchBtn->setStyleSheet(
+      "QPushButton { background: transparent; color: rgba(255,255,255,0.5); "
+      "border: none; font-size: 12px; }"
+      "QPushButton:hover { color: #ff6b6b; }");
+  m_cancelBatchBtn->hide();
+  connect(m_cancelBatchBtn, &QPushButton::clicked, this,
+          &AIChatPanel::cancelBatch);
+  statusLayout->addWidget(m_cancelBatchBtn);
+  layout->addLayout(statusLayout);
+
+  // Requests per minute decays even when nothing happens
+  auto *statusTimer = new QTimer(this);
+  statusTimer->setInterval(5000);
+  connect(statusTimer, &QTimer::timeout, this,
+          &AIChatPanel::updateQueueStatus);
+  statusTimer->start();
+  updateTokenCounter();
 }
 
-void AIChatPanel::updateModelSelector() {}
+void AIChatPanel::updateModelSelector() {
+  struct Item {
+    QString text;
+    QStringList data;
+  };
+  QList<Item> items;
+  for (const auto *p : m_providers->providers()) {
+    const LatencyStats &lat = p->latency();
+    QString stats;
+    if (!lat.isEmpty())
+      stats = QString("  p50 %1 мс · p95 %2 мс")
+                  .arg(qRound(lat.percentile(0.5)))
+                  .arg(qRound(lat.percentile(0.95)));
+    if (p->inFlight() + p->queued() > 0)
+      stats += QString("  ⏳%1").arg(p->inFlight() + p->queued());
+    for (const auto &model : p->config().models) {
+      items.append({QString("%1 · %2%3")
+                        .arg(p->config().name, model.section('/', -1), stats),
+                    QStringList{p->id(), model}});
+    }
+  }
+
+  // Update texts in place so an open popup is not reset
+  bool sameShape = m_modelSelector->count() == items.size();
+  for (int i = 0; sameShape && i < items.size(); ++i)
+    sameShape = m_modelSelector->itemData(i).toStringList() == items[i].data;
 
-void AIChatPanel::setProject(const QString &projectName) {
-  if (!m_currentProject.isEmpty()) {
-    QJsonArray items;
-    for (int i = 1; i < m_messages.size(); ++i)
-      items.append(m_messages[i]);
-    Storage::saveContext(m_currentProject, items);
+  QSignalBlocker blocker(m_modelSelector);
+  if (sameShape) {
+    for (int i = 0; i < items.size(); ++i)
+      m_modelSelector->setItemText(i, items[i].text);
+    return;
+  }
+  m_modelSelector->clear();
+  for (const auto &item : items) {
+    m_modelSelector->addItem(item.text, item.data);
+    if (item.data == QStringList{m_currentProvider, m_currentModel})
+      m_modelSelector->setCurrentIndex(m_modelSelector->count() - 1);
   }
+}
+
+void AIChatPanel::setProject(const QString &projectName) {
+  cancelQueue();
   m_currentProject = projectName;
   m_taskCounter = 0;
-  QJsonArray saved = Storage::loadContext(projectName);
-  m_messages = QJsonArray();
-  QJsonObject sys;
-  sys["role"] = "system";
-  sys["content"] = SYSTEM_PROMPT;
-  m_messages.append(sys);
-  for (const auto &m : saved)
-    m_messages.append(m);
-  clearChatUI();
-  for (int i = 1; i < m_messages.size(); ++i) {
-    QJsonObject m = m_messages[i].toObject();
-    addMessageUI(m["content"].toString(), m["role"].toString() == "user");
+  m_positionCounter = 0;
+
+  // One read covers both the visible page and the model's context window
+  int size = Storage::contextSize(projectName);
+  m_transcriptFrom = qMax(0, size - HISTORY_PAGE);
+  QJsonArray tail =
+      Storage::loadContextRange(projectName, m_transcriptFrom, HISTORY_PAGE);
+  resetMessages();
+  for (int i = qMax(0, tail.size() - CONTEXT_WINDOW); i < tail.size(); ++i)
+    m_messages.append(tail[i]);
+  trimContextWindow();
+
+  // Lay out now so the view lands at the bottom without passing the top,
+  // which would page in older history
+  QSignalBlocker blocker(m_transcriptView->verticalScrollBar());
+  m_transcript->setEntries(transcriptEntries(tail));
+  m_transcriptView->doItemsLayout();
+  m_transcriptView->scrollToBottom();
+  updateTokenCounter();
+}
+
+QVector<ChatEntry> AIChatPanel::transcriptEntries(const QJsonArray &messages) {
+  QVector<ChatEntry> entries;
+  entries.reserve(messages.size());
+  for (const auto &value : messages) {
+    QJsonObject m = value.toObject();
+    QString content = m["content"].toString();
+    if (m["role"].toString() == "tool" || content.isEmpty())
+      continue;
+    entries.append({content, m["role"].toString() == "user", QString()});
   }
+  return entries;
 }
 
-void AIChatPanel::setTasksInfo(const QString &info) { m_tasksContext = info; }
-void AIChatPanel::clearChatUI() {
-  while (m_messagesLayout->count()) {
-    auto *i = m_messagesLayout->takeAt(0);
-    if (i->widget())
-      i->widget()->deleteLater();
-    delete i;
+void AIChatPanel::loadOlderHistory() {
+  if (m_currentProject.isEmpty())
+    return;
+  QVector<ChatEntry> entries;
+  while (entries.isEmpty() && m_transcriptFrom > 0) {
+    int from = qMax(0, m_transcriptFrom - HISTORY_PAGE);
+    entries = transcriptEntries(Storage::loadContextRange(
+        m_currentProject, from, m_transcriptFrom - from));
+    m_transcriptFrom = from;
   }
+  if (entries.isEmpty())
+    return;
+
+  // Keep the row under the top edge in place
+  QPersistentModelIndex anchor = m_transcriptView->indexAt(QPoint(0, 0));
+  m_transcript->prepend(entries);
+  if (anchor.isValid())
+    m_transcriptView->scrollTo(anchor, QAbstractItemView::PositionAtTop);
 }
-void AIChatPanel::onClearChat() {
-  clearChatUI();
+
+void AIChatPanel::resetMessages() {
+  m_historyTokens = -1;
   m_messages = QJsonArray();
   QJsonObject sys;
   sys["role"] = "system";
   sys["content"] = SYSTEM_PROMPT;
   m_messages.append(sys);
 }
-void AIChatPanel::addMessageUI(const QString &text, bool isUser) {
-  m_messagesLayout->addWidget(new ChatMessage(text, isUser, m_messagesWidget));
-  QTimer::singleShot(50, this, &AIChatPanel::scrollToBottom);
+
+void AIChatPanel::appendMessage(const QJsonObject &message) {
+  m_historyTokens = -1;
+  m_messages.append(message);
+  if (!m_currentProject.isEmpty())
+    Storage::appendContext(m_currentProject, message);
+  if (m_messages.size() > 1 + 2 * CONTEXT_WINDOW)
+    trimContextWindow();
 }
-void AIChatPanel::scrollToBottom() {
-  m_scrollArea->verticalScrollBar()->setValue(
-      m_scrollArea->verticalScrollBar()->maximum());
+
+void AIChatPanel::trimContextWindow() {
+  m_historyTokens = -1;
+  int cut = 1 + qMax(0, m_messages.size() - 1 - CONTEXT_WINDOW);
+  // A tool result without its assistant tool_calls message is rejected
+  while (cut < m_messages.size() &&
+         m_messages[cut].toObject()["role"].toString() == "tool")
+    cut++;
+  if (cut == 1)
+    return;
+  QJsonArray kept;
+  kept.append(m_messages[0]);
+  for (int i = cut; i < m_messages.size(); ++i)
+    kept.append(m_messages[i]);
+  m_messages = kept;
 }
+
+void AIChatPanel::setTasksInfo(const QString &info) {
+  m_context.setInfo(info);
+  m_contextTokens = -1;
+}
+
+void AIChatPanel::setTasks(const QList<TaskSnapshot> &tasks,
+                           const QList<QPair<int, int>> &connections) {
+  m_context.setTasks(tasks, connections);
+  m_contextTokens = -1;
+  m_taskCounter = tasks.size();
+  m_positionCounter = tasks.size();
+}
+
+void AIChatPanel::clearChatUI() { m_transcript->clear(); }
+void AIChatPanel::onClearChat() {
+  cancelQueue();
+  clearChatUI();
+  resetMessages();
+  if (!m_currentProject.isEmpty())
+    Storage::clearContext(m_currentProject);
+  m_transcriptFrom = 0;
+}
+void AIChatPanel::addMessageUI(const QString &text, bool isUser,
+                               const QString &badge) {
+  m_transcript->append({text, isUser, badge});
+  QTimer::singleShot(50, this, &AIChatPanel::scrollToBottom);
+}
+void AIChatPanel::scrollToBottom() { m_transcriptView->scrollToBottom(); }
 void AIChatPanel::onSendClicked() { sendMessage(); }
 
 void AIChatPanel::sendMessage() {
   QString text = m_inputField->text().trimmed();
-  if (text.isEmpty() || m_apiKey.isEmpty())
+  if (text.isEmpty())
     return;
-  addMessageUI(text, true);
+  emit requestTasks();
 
-  QString fullContent = text;
-  if (!m_tasksContext.isEmpty()) {
-    fullContent =
-        QString("ТЕКУЩИЕ ЗАДАЧИ:\n%1\n\nЗАПРОС: %2").arg(m_tasksContext, text);
+  // Mechanical commands never need the model
+  QElapsedTimer parseTimer;
+  parseTimer.start();
+  QJsonObject local = LocalCommandParser::parse(text, m_taskCounter);
+  if (!local.isEmpty()) {
+    m_inputField->clear();
+    if (m_queue.isEmpty() && !m_batchRunner) {
+      handleLocalCommand(text, local, parseTimer);
+      return;
+    }
+    // Stay behind the replies that are still pending
+    addMessageUI(text, true);
+    m_queue.enqueueLocal(text, local, "LOCAL ⚡");
+    updateQueueStatus();
+    return;
   }
 
-  QJsonObject msg;
-  msg["role"] = "user";
-  msg["content"] = fullContent;
-  m_messages.append(msg);
+  AIProvider *provider = m_providers->provider(m_currentProvider);
+  if (!provider || m_currentModel.isEmpty() ||
+      (provider->config().needsApiKey() && provider->config().apiKey.isEmpty()))
+    return;
+  addMessageUI(text, true);
   m_inputField->clear();
-  m_inputField->setEnabled(false);
-  m_sendBtn->setEnabled(false);
-  QNetworkRequest req{QUrl(OPENROUTER_API_URL)};
-  req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-  req.setRawHeader("Authorization", ("Bearer " + m_apiKey).toUtf8());
-  QJsonObject data;
-  data["model"] = m_currentModel;
-  data["messages"] = m_messages;
-  m_networkManager->post(req, QJsonDocument(data).toJson());
-}
-
-void AIChatPanel::onNetworkReply(QNetworkReply *reply) {
-  m_inputField->setEnabled(true);
-  m_sendBtn->setEnabled(true);
-  if (reply->error() == QNetworkReply::NoError) {
-    QByteArray responseData = reply->readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(responseData);
-    if (doc.isObject() && doc.object().contains("choices")) {
-      QString content = doc.object()["choices"]
-                            .toArray()[0]
-                            .toObject()["message"]
-                            .toObject()["content"]
-                            .toString();
+
+  m_queue.enqueue(text);
+  dispatchQueued();
+}
+
+void AIChatPanel::dispatchQueued() {
+  AIProvider *provider = m_providers->provider(m_currentProvider);
+  int limit = provider ? qMin(provider->config().maxConcurrent, m_maxInFlight)
+                       : 0;
+  bool refreshed = false;
+  while (RequestQueue::Entry *entry = m_queue.nextToDispatch(limit)) {
+    // Replies applied since the last request may have changed the board
+    if (!refreshed)
+      emit requestTasks();
+    refreshed = true;
+    int seq = entry->seq;
+    entry->sentContent = entry->text();
+    QString tasksContext = m_context.build(entry->text());
+    if (!tasksContext.isEmpty()) {
+      entry->sentContent = QString("ТЕКУЩИЕ ЗАДАЧИ:\n%1\n\nЗАПРОС: %2")
+                               .arg(tasksContext, entry->text());
+    }
+
+    // Earlier requests are still unanswered; the model sees them as
+    // preceding user turns so follow-ups keep their meaning
+    QJsonArray messages = m_messages;
+    for (const auto &pending : m_queue.pendingTextsBefore(seq)) {
       QJsonObject msg;
-      msg["role"] = "assistant";
-      msg["content"] = content;
-      m_messages.append(msg);
-      processAIResponse(content);
-    } else if (doc.object().contains("error")) {
-      QString errMsg = doc.object()["error"].toObject()["message"].toString();
-      addMessageUI("❌ API Error: " + errMsg, false);
-    } else {
-      addMessageUI("❌ Неверный ответ от API", false);
+      msg["role"] = "user";
+      msg["content"] = pending;
+      messages.append(msg);
     }
-  } else {
-    QString errorStr = reply->errorString();
-    addMessageUI("❌ Ошибка сети: " + errorStr, false);
+    QJsonObject msg;
+    msg["role"] = "user";
+    msg["content"] = entry->sentContent;
+    messages.append(msg);
+    m_queue.markInFlight(seq);
+
+    QString cacheKey = ResponseCache::makeKey(
+        m_currentProvider + ":" + m_currentModel, messages);
+    QJsonObject cached;
+    if (m_cache.lookup(cacheKey, cached)) {
+      m_queue.resolve(seq, cached, "CACHE");
+      continue;
+    }
+
+    QJsonObject data;
+    data["model"] = m_currentModel;
+    data["messages"] = messages;
+    data["tools"] = AIActionRegistry::instance().toolSchemas();
+    data["tool_choice"] = "auto";
+
+    QString secondary = m_hedgeEnabled ? hedgeSecondaryModel() : QString();
+    auto *request = new HedgedRequest(
+        provider, m_currentModel, secondary.isEmpty() ? nullptr : provider,
+        secondary, data, m_hedgePolicy.delayFor(m_currentModel),
+        [this](const QJsonObject &message) { return validateReply(message); },
+        &m_hedgePolicy, this);
+    request->setProperty("cacheKey", cacheKey);
+    request->setProperty("seq", seq);
+    connect(request, &HedgedRequest::firstChunk, this,
+            &AIChatPanel::replyStarted);
+    connect(request, &HedgedRequest::finished, this,
+            [this, request]() { onCompletionFinished(request); });
+    request->start();
   }
-  reply->deleteLater();
+  updateCacheButton();
+  releaseReady();
 }
 
-void AIChatPanel::processAIResponse(const QString &content) {
-  auto objects = extractAllJson(content);
-  QStringList results;
-  for (const auto &obj : objects) {
-    if (obj.contains("actions")) {
-      for (const auto &a : obj["actions"].toArray()) {
-        QString r = executeAction(a.toObject());
-        if (!r.isEmpty())
-          results.append(r);
-      }
-    } else {
-      QString r = executeAction(obj);
-      if (!r.isEmpty())
-        results.append(r);
-    }
+void AIChatPanel::updateTokenCounter() {
+  if (m_historyTokens < 0)
+    m_historyTokens = m_tokenizer.countMessages(m_messages);
+  QString input = m_inputField->text().trimmed();
+  int inputTokens = 0;
+  int contextTokens = 0;
+  if (!input.isEmpty()) {
+    // Only the input is tokenized per keystroke. Past FULL_CONTEXT_TASKS
+    // the tasks picked for the query come on top of the counted part.
+    if (m_contextTokens < 0)
+      m_contextTokens = m_tokenizer.count(m_context.build(QString()));
+    inputTokens = m_tokenizer.count(input);
+    contextTokens = m_contextTokens;
   }
+  int total = m_historyTokens + contextTokens + inputTokens;
+
+  bool exact = m_tokenizer.isLoaded() &&
+               m_context.size() <= TaskContext::FULL_CONTEXT_TASKS;
+  QString prefix = exact ? "" : "≈";
+  QString shown = total >= 10000 ? QString::number(total / 1000.0, 'f', 1) + "k"
+                                 : QString::number(total);
+  m_tokenLabel->setText(prefix + shown);
+  m_tokenLabel->setToolTip(
+      QString("Токенов в запросе: %1\nИстория: %2 · Задачи: %3 · Ввод: %4\n%5")
+          .arg(total)
+          .arg(m_historyTokens)
+          .arg(contextTokens)
+          .arg(inputTokens)
+          .arg(m_tokenizer.isLoaded()
+                   ? "Словарь: " + m_tokenizer.name()
+                   : "Оценка: нет словаря в " + getTokenizerDir()));
+}
 
-  QString textPart = cleanJsonFromText(content);
-  QString display;
+void AIChatPanel::releaseReady() {
+  RequestQueue::Entry entry;
+  while (!m_batchRunner && m_queue.takeNextReady(&entry)) {
+    if (entry.local) {
+      // Task numbers may have moved while it waited
+      QJsonObject action =
+          LocalCommandParser::parse(entry.text(), m_taskCounter);
+      if (action.isEmpty())
+        action = entry.reply;
+      QStringList results = applyLocalCommand(entry.text(), action);
+      addMessageUI(results.join("\n"), false, entry.badge);
+      continue;
+    }
 
-  if (!textPart.isEmpty() && textPart != "Готово") {
-    display = textPart;
-    if (!results.isEmpty()) {
-      display += "\n\n" + results.join("\n");
+    QJsonObject userMsg;
+    userMsg["role"] = "user";
+    userMsg["content"] = entry.sentContent;
+    appendMessage(userMsg);
+    if (!entry.error.isEmpty()) {
+      addMessageUI("❌ " + entry.error, false);
+      emit replyHandled();
+      continue;
     }
-  } else if (!results.isEmpty()) {
-    display = results.join("\n");
+    QString badge = entry.badge;
+    if (entry.texts.size() > 1)
+      badge += QString(" · ⧉%1").arg(entry.texts.size());
+    handleAssistantMessage(entry.reply, badge);
+  }
+  updateQueueStatus();
+  updateTokenCounter();
+}
+
+void AIChatPanel::cancelQueue() {
+  m_queue.clear();
+  cancelBatch();
+  for (auto *request : findChildren<HedgedRequest *>())
+    request->abort();
+  updateQueueStatus();
+}
+
+void AIChatPanel::updateQueueStatus() {
+  QStringList parts;
+  if (m_batchRunner)
+    parts << QString("действия %1/%2")
+                 .arg(m_batchRunner->done())
+                 .arg(m_batchRunner->total());
+  if (m_queue.waiting() > 0)
+    parts << QString("в очереди %1").arg(m_queue.waiting());
+  if (m_queue.inFlight() > 0)
+    parts << QString("в работе %1").arg(m_queue.inFlight());
+  int perMinute = m_queue.completedLastMinute();
+  if (perMinute > 0)
+    parts << QString("%1 запр/мин").arg(perMinute);
+  m_statusLabel->setText(parts.join(" · "));
+  m_statusLabel->setVisible(!parts.isEmpty());
+  m_cancelBatchBtn->setVisible(m_batchRunner != nullptr);
+}
+
+QString AIChatPanel::hedgeSecondaryModel() const {
+  AIProvider *provider = m_providers->provider(m_currentProvider);
+  if (!provider)
+    return QString();
+  const QStringList &models = provider->config().models;
+  if (m_hedgeModel != m_currentModel && models.contains(m_hedgeModel))
+    return m_hedgeModel;
+  for (const auto &model : models) {
+    if (model != m_currentModel)
+      return model;
+  }
+  return QString();
+}
+
+bool AIChatPanel::validateReply(const QJsonObject &message) const {
+  QList<QJsonObject> actions;
+  QJsonArray toolCalls = message["tool_calls"].toArray();
+  if (toolCalls.isEmpty()) {
+    actions = AIResponseParser::inlineActions(message["content"].toString());
   } else {
-    display = content;
+    bool ok;
+    actions = AIResponseParser::toolCallActions(toolCalls, &ok);
+    if (!ok)
+      return false;
   }
 
-  addMessageUI(display, false);
+  const auto &registry = AIActionRegistry::instance();
+  for (const auto &action : actions) {
+    if (!action["action"].toString().isEmpty() && !registry.validate(action))
+      return false;
+  }
+  return true;
 }
 
-QString AIChatPanel::formatAIMessage(const QString &content) { return content; }
-QString AIChatPanel::cleanJsonFromText(const QString &text) {
-  QString result;
-  int depth = 0;
-  for (int i = 0; i < text.length(); ++i) {
-    QChar c = text[i];
-    if (c == '{') {
-      depth++;
-    } else if (c == '}') {
-      depth--;
-    } else if (depth == 0) {
-      result += c;
+void AIChatPanel::onCompletionFinished(HedgedRequest *request) {
+  request->deleteLater();
+  updateHedgeButton();
+  int seq = request->property("seq").toInt();
+  if (request->hasError()) {
+    m_queue.resolve(seq, QJsonObject(), QString(), request->errorString());
+  } else {
+    // A fallback reply that failed validation would be replayed (and
+    // rolled back) for every identical prompt until it expired
+    if (validateReply(request->message())) {
+      m_cache.store(request->property("cacheKey").toString(),
+                    request->message());
+      updateCacheButton();
     }
+    QString badge = request->model().section('/', -1);
+    if (request->providerId() != "openrouter")
+      badge = request->providerId() + " · " + badge;
+    if (request->secondaryWon())
+      badge += " ⑂";
+    m_queue.resolve(seq, request->message(), badge);
   }
-  result = result.simplified();
-  return result.isEmpty() ? "" : result;
-}
-
-QList<QJsonObject> AIChatPanel::extractAllJson(const QString &text) {
-  QList<QJsonObject> res;
-  for (int i = 0; i < text.length(); ++i) {
-    if (text[i] == '{') {
-      int d = 0, s = i;
-      for (int j = i; j < text.length(); ++j) {
-        if (text[j] == '{')
-          d++;
-        else if (text[j] == '}') {
-          d--;
-          if (d == 0) {
-            auto doc = QJsonDocument::fromJson(text.mid(s, j - s + 1).toUtf8());
-            if (doc.isObject())
-              res.append(doc.object());
-            i = j;
-            break;
-          }
-        }
-      }
+  releaseReady();
+  dispatchQueued();
+}
+
+void AIChatPanel::handleAssistantMessage(const QJsonObject &message,
+                                         const QString &badge) {
+  QString content = message["content"].toString();
+  QJsonArray toolCalls = message["tool_calls"].toArray();
+  QJsonObject msg;
+  msg["role"] = "assistant";
+  msg["content"] = content;
+  if (!toolCalls.isEmpty())
+    msg["tool_calls"] = toolCalls;
+  appendMessage(msg);
+
+  if (toolCalls.isEmpty()) {
+    // Models without tool support still answer with inline JSON
+    processAIResponse(content, badge);
+    return;
+  }
+
+  QList<QJsonObject> actions = AIResponseParser::toolCallActions(toolCalls);
+  applyActionsAsync(actions, [this, toolCalls, content,
+                              badge](const QStringList &results,
+                                     bool rolledBack) {
+    // Every tool call needs a matching tool message in the history
+    for (int i = 0; i < toolCalls.size(); ++i) {
+      QJsonObject toolMsg;
+      toolMsg["role"] = "tool";
+      toolMsg["tool_call_id"] = toolCalls[i].toObject()["id"].toString();
+      toolMsg["content"] = rolledBack ? results.join("\n") : results.value(i);
+      appendMessage(toolMsg);
+    }
+
+    QStringList lines;
+    if (!content.trimmed().isEmpty())
+      lines.append(content.trimmed());
+    for (const auto &r : results) {
+      if (!r.isEmpty())
+        lines.append(r);
     }
+    addMessageUI(lines.join("\n"), false, badge);
+    emit replyHandled();
+  });
+}
+
+void AIChatPanel::handleLocalCommand(const QString &text,
+                                     const QJsonObject &action,
+                                     const QElapsedTimer &timer) {
+  addMessageUI(text, true);
+  QStringList results = applyLocalCommand(text, action);
+  qint64 micros = timer.nsecsElapsed() / 1000;
+  addMessageUI(results.join("\n"), false,
+               QString("LOCAL ⚡ %1 µs").arg(micros));
+}
+
+QStringList AIChatPanel::applyLocalCommand(const QString &text,
+                                           const QJsonObject &action) {
+  QStringList results = applyActions({action});
+
+  // Keep the model's view of the conversation consistent
+  QJsonObject userMsg;
+  userMsg["role"] = "user";
+  userMsg["content"] = text;
+  appendMessage(userMsg);
+  QJsonObject assistantMsg;
+  assistantMsg["role"] = "assistant";
+  assistantMsg["content"] =
+      QString::fromUtf8(QJsonDocument(action).toJson(QJsonDocument::Compact));
+  appendMessage(assistantMsg);
+  return results;
+}
+
+QStringList AIChatPanel::applyActions(const QList<QJsonObject> &actions,
+                                      bool *rolledBack) {
+  QStringList results;
+  if (rolledBack)
+    *rolledBack = false;
+  if (actions.isEmpty())
+    return results;
+
+  int savedCount = m_taskCounter, savedPosition = m_positionCounter;
+  QString failure;
+  emit transactionBegin();
+  for (const auto &a : actions) {
+    QString r = executeAction(a);
+    if (isActionFailure(r)) {
+      failure = r;
+      break;
+    }
+    results.append(r);
+    emit actionApplied(r);
   }
-  return res;
+  if (failure.isEmpty()) {
+    emit transactionCommit();
+  } else {
+    emit transactionRollback();
+    m_taskCounter = savedCount;
+    m_positionCounter = savedPosition;
+    results = QStringList{failure, "↺ Изменения из ответа отменены"};
+    if (rolledBack)
+      *rolledBack = true;
+  }
+  return results;
 }
 
+void AIChatPanel::applyActionsAsync(
+    const QList<QJsonObject> &actions,
+    std::function<void(const QStringList &, bool)> done) {
+  if (actions.size() < CHUNKED_BATCH_MIN) {
+    bool rolledBack = false;
+    QStringList results = applyActions(actions, &rolledBack);
+    done(results, rolledBack);
+    return;
+  }
+
+  // The whole reply is still one transaction; it stays open across slices
+  int savedCount = m_taskCounter, savedPosition = m_positionCounter;
+  emit transactionBegin();
+  emit batchRunning(true);
+
+  m_batchRunner = new ActionBatchRunner(
+      actions,
+      [this](const QJsonObject &a) {
+        QString r = executeAction(a);
+        if (!isActionFailure(r))
+          emit actionApplied(r);
+        return r;
+      },
+      this);
+  m_progressId = m_transcript->append(
+      {QString("⏳ Выполняю действия: 0/%1").arg(actions.size()), false, {}});
+  scrollToBottom();
+
+  connect(m_batchRunner, &ActionBatchRunner::progress, this,
+          [this](int n, int total) {
+            m_progressId = m_transcript->setText(
+                m_progressId,
+                QString("⏳ Выполняю действия: %1/%2").arg(n).arg(total));
+            updateQueueStatus();
+          });
+  connect(m_batchRunner, &ActionBatchRunner::finished, this,
+          [this, savedCount, savedPosition, done]() {
+            ActionBatchRunner *runner = m_batchRunner;
+            m_batchRunner = nullptr;
+
+            QStringList results;
+            bool rolledBack = runner->isCancelled() ||
+                              !runner->failure().isEmpty();
+            if (rolledBack) {
+              emit transactionRollback();
+              m_taskCounter = savedCount;
+              m_positionCounter = savedPosition;
+              results << (runner->isCancelled() ? "⏹ Выполнение остановлено"
+                                                : runner->failure())
+                      << "↺ Изменения из ответа отменены";
+            } else {
+              emit transactionCommit();
+              results = runner->results();
+            }
+            emit batchRunning(false);
+            m_transcript->setText(
+                m_progressId,
+                QString("%1 Действия: %2/%3 за %4 мс")
+                    .arg(rolledBack ? "⏹" : "✓")
+                    .arg(runner->done())
+                    .arg(runner->total())
+                    .arg(runner->elapsedMs()));
+            m_progressId = 0;
+            runner->deleteLater();
+
+            done(results, rolledBack);
+            // Replies that arrived meanwhile were held back
+            releaseReady();
+          });
+  updateQueueStatus();
+  m_batchRunner->start();
+}
+
+void AIChatPanel::cancelBatch() {
+  if (m_batchRunner)
+    m_batchRunner->cancel();
+}
+
+void AIChatPanel::processAIResponse(const QString &content,
+                                    const QString &badge) {
+  QList<QJsonObject> actions = AIResponseParser::inlineActions(content);
+  applyActionsAsync(actions, [this, content, badge](QStringList results, bool) {
+    results.removeAll(QString());
+
+    QString textPart = AIResponseParser::cleanJsonFromText(content);
+    QString display;
+
+    if (!textPart.isEmpty() && textPart != "Готово") {
+      display = textPart;
+      if (!results.isEmpty()) {
+        display += "\n\n" + results.join("\n");
+      }
+    } else if (!results.isEmpty()) {
+      display = results.join("\n");
+    } else {
+      display = content;
+    }
+
+    addMessageUI(display, false, badge);
+    emit replyHandled();
+  });
+}
+
+QString AIChatPanel::formatAIMessage(const QString &content) { return content; }
 QString AIChatPanel::executeAction(const QJsonObject &data) {
   QString actionName = data["action"].toString();
   if (actionName.isEmpty())
@@ -365,6 +884,7 @@ QString AIChatPanel::executeAction(const QJsonObject &data) {
   ctx.createTask = [this](const QString &title, const QString &desc,
                           const QString &status, int x, int y) {
     emit taskCreated(title, desc, status, x, y);
+    m_taskCounter++;
   };
 
   ctx.connectTasks = [this](int from, int to) { emit tasksConnect(from, to); };
@@ -385,25 +905,35 @@ QString AIChatPanel::executeAction(const QJsonObject &data) {
     emit taskUpdateDesc(idx, desc);
   };
 
-  ctx.deleteTask = [this](int idx) { emit taskDelete(idx); };
+  ctx.deleteTask = [this](int idx) {
+    emit taskDelete(idx);
+    m_taskCounter--;
+  };
 
-  ctx.clearAll = [this]() { emit clearAllTasks(); };
+  ctx.clearAll = [this]() {
+    emit clearAllTasks();
+    m_taskCounter = 0;
+  };
 
   ctx.arrange = [this](const QString &type) { emit arrangeTasks(type); };
 
   ctx.getTaskCount = [this]() -> int { return m_taskCounter; };
 
-  ctx.getPositionCounter = [this]() -> int & { return m_taskCounter; };
+  ctx.getPositionCounter = [this]() -> int & { return m_positionCounter; };
+
+  ctx.placeTask = m_placeTask;
+
+  // Without a snapshot every task would seem to have no dependencies
+  if (m_context.size() > 0) {
+    ctx.reachableTasks = [this](int idx, bool downstream) {
+      return m_context.reachable(idx, downstream);
+    };
+  }
 
   return AIActionRegistry::instance().execute(actionName, data, ctx);
 }
 
 QString AIChatPanel::describeAction(const QJsonObject &data) { return ""; }
-QPair<int, int> AIChatPanel::getTaskPosition() {
-  int c = m_taskCounter % 3, r = m_taskCounter / 3;
-  m_taskCounter++;
-  return {50 + c * 250, 50 + r * 180};
-}
 void AIChatPanel::onApiKeySetup() {
   bool ok;
   QString k = QInputDialog::getText(this, "API", "Key:", QLineEdit::Normal,
@@ -411,10 +941,96 @@ void AIChatPanel::onApiKeySetup() {
   if (ok) {
     m_apiKey = k.trimmed();
     Storage::saveApiKey(m_apiKey);
+    if (AIProvider *p = m_providers->provider("openrouter"))
+      p->setApiKey(m_apiKey);
   }
 }
 void AIChatPanel::onQuickAction(const QString &text) {}
 void AIChatPanel::onAddModel() {}
-void AIChatPanel::onModelChanged(int index) {}
+bool AIChatPanel::selectModel(const QString &providerId,
+                              const QString &model) {
+  updateModelSelector();
+  int index = m_modelSelector->findData(QStringList{providerId, model});
+  if (index < 0)
+    return false;
+  if (m_modelSelector->currentIndex() == index)
+    onModelChanged(index);
+  else
+    m_modelSelector->setCurrentIndex(index);
+  return true;
+}
+
+void AIChatPanel::submit(const QString &text) {
+  m_inputField->setText(text);
+  sendMessage();
+}
+
+void AIChatPanel::onModelChanged(int index) {
+  QStringList data = m_modelSelector->itemData(index).toStringList();
+  if (data.size() != 2)
+    return;
+  m_currentProvider = data[0];
+  m_currentModel = data[1];
+  if (m_currentProvider == "openrouter")
+    Storage::saveModels(m_models, m_currentModel);
+
+  QJsonObject settings = Storage::loadSettings();
+  settings["provider"] = m_currentProvider;
+  settings["model"] = m_currentModel;
+  Storage::saveSettings(settings);
+  updateHedgeButton();
+}
+
+void AIChatPanel::onCacheToggled(bool enabled) {
+  m_cache.setEnabled(enabled);
+  QJsonObject settings = Storage::loadSettings();
+  QJsonObject cacheSettings = settings["cache"].toObject();
+  cacheSettings["enabled"] = enabled;
+  settings["cache"] = cacheSettings;
+  Storage::saveSettings(settings);
+  updateCacheButton();
+}
+
+void AIChatPanel::updateCacheButton() {
+  m_cacheBtn->setToolTip(
+      QString("Кэш ответов: %1\nПопаданий: %2 · Промахов: %3\nЗаписей: %4 "
+              "(%5 КБ)")
+          .arg(m_cache.isEnabled() ? "вкл" : "выкл")
+          .arg(m_cache.hits())
+          .arg(m_cache.misses())
+          .arg(m_cache.entryCount())
+          .arg(m_cache.totalBytes() / 1024));
+}
+
+void AIChatPanel::onHedgeToggled(bool enabled) {
+  m_hedgeEnabled = enabled;
+  QJsonObject settings = Storage::loadSettings();
+  QJsonObject hedgeSettings = settings["hedge"].toObject();
+  hedgeSettings["enabled"] = enabled;
+  settings["hedge"] = hedgeSettings;
+  Storage::saveSettings(settings);
+  updateHedgeButton();
+}
+
+void AIChatPanel::updateHedgeButton() {
+  QStringList lines;
+  lines << QString("Дублирование запроса: %1")
+               .arg(m_hedgeEnabled ? "вкл" : "выкл");
+  QString secondary = hedgeSecondaryModel();
+  lines << QString("Резервная модель: %1")
+               .arg(secondary.isEmpty() ? "нет" : secondary.section('/', -1));
+  lines << QString("Задержка: %1 мс")
+               .arg(m_hedgePolicy.delayFor(m_currentModel));
+  for (const auto &model : m_hedgePolicy.models()) {
+    const LatencyStats *total = m_hedgePolicy.total(model);
+    lines << QString("%1: p50 %2 · p95 %3 · p99 %4 мс (%5)")
+                 .arg(model.section('/', -1))
+                 .arg(qRound(total->percentile(0.5)))
+                 .arg(qRound(total->percentile(0.95)))
+                 .arg(qRound(total->percentile(0.99)))
+                 .arg(total->count());
+  }
+  m_hedgeBtn->setToolTip(lines.join("\n"));
+}
 
 } // namespace DevPlanner
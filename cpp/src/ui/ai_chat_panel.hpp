@@ -1,41 +1,62 @@
 #ifndef AI_CHAT_PANEL_HPP
 #define AI_CHAT_PANEL_HPP
 
+#include "ai/providers/hedged_request.hpp"
+#include "ai/action_batch_runner.hpp"
+#include "ai/bpe_tokenizer.hpp"
+#include "ai/request_queue.hpp"
+#include "ai/task_context.hpp"
+#include "chat_transcript_model.hpp"
+#include "core/response_cache.hpp"
 #include "glassmorphism_widget.hpp"
 #include <QComboBox>
-#include <QFrame>
+#include <QElapsedTimer>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QLabel>
 #include <QLineEdit>
 #include <QList>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
+#include <QListView>
 #include <QPair>
+#include <QPoint>
 #include <QPushButton>
-#include <QScrollArea>
-#include <QVBoxLayout>
+#include <functional>
 
 namespace DevPlanner {
 
-class ChatMessage : public QFrame {
-  Q_OBJECT
-public:
-  explicit ChatMessage(const QString &text, bool isUser,
-                       QWidget *parent = nullptr);
-};
+class ProviderRegistry;
 
 class AIChatPanel : public GlassmorphismWidget {
   Q_OBJECT
 
 public:
-  static const QString OPENROUTER_API_URL;
   static const QString SYSTEM_PROMPT;
+  // Messages sent to the model; older ones stay in the on-disk log
+  static constexpr int CONTEXT_WINDOW = 40;
+  // Transcript rows loaded per scroll-back step
+  static constexpr int HISTORY_PAGE = 200;
+  // Replies with more actions run in time slices with a progress bubble
+  static constexpr int CHUNKED_BATCH_MIN = 64;
 
   explicit AIChatPanel(QWidget *parent = nullptr);
   void setProject(const QString &projectName);
   void setTasksInfo(const QString &info);
-  void setTaskCounter(int count) { m_taskCounter = count; }
+  // Board state for retrieval (see TaskContext), usually given in answer
+  // to requestTasks(). Connections are 0-based.
+  void setTasks(const QList<TaskSnapshot> &tasks,
+                const QList<QPair<int, int>> &connections);
+  void setTaskCounter(int count) { m_taskCounter = m_positionCounter = count; }
+  // Free-space placement for created tasks (see ActionContext::placeTask);
+  // without it tasks go to the fixed three-column grid
+  void setPlacement(std::function<QPoint(int nearTask)> place) {
+    m_placeTask = std::move(place);
+  }
+
+  ProviderRegistry *providers() const { return m_providers; }
+  // Picks a provider/model pair as if chosen in the selector
+  bool selectModel(const QString &providerId, const QString &model);
+  // Sends text as if typed into the input field
+  void submit(const QString &text);
 
 signals:
   void taskCreated(const QString &title, const QString &description,
@@ -47,51 +68,120 @@ signals:
   void taskDelete(int taskIdx);
   void tasksDeleteMany(const QList<int> &tasks);
   void clearAllTasks();
+  // Emitted before a request is built; connect directly and answer with
+  // setTasks(), or the model sees the board as it was last given
   void requestTasks();
   void arrangeTasks(const QString &type);
   void disconnectTasks(int fromIdx, int toIdx);
+  // Wrap all mutations of one AI reply (see NodeCanvas transactions)
+  void transactionBegin();
+  void transactionCommit();
+  void transactionRollback();
+  // True while a time-sliced batch holds its transaction open; connect to
+  // NodeCanvas::setEditingLocked so a rollback cannot take user edits along
+  void batchRunning(bool running);
+  // Pipeline milestones of a model reply, for latency measurements
+  void replyStarted();
+  void actionApplied(const QString &result);
+  void replyHandled();
 
 private slots:
   void onSendClicked();
-  void onNetworkReply(QNetworkReply *reply);
   void onApiKeySetup();
   void onClearChat();
   void onQuickAction(const QString &text);
   void onAddModel();
   void onModelChanged(int index);
+  void onCacheToggled(bool enabled);
+  void onHedgeToggled(bool enabled);
   void scrollToBottom();
+  void updateQueueStatus();
+  void updateTokenCounter();
 
 private:
   void setupUI();
   void sendMessage();
-  void processAIResponse(const QString &content);
+  // Starts waiting queue entries up to the pipeline depth
+  void dispatchQueued();
+  // Applies answered entries at the head of the queue, in order
+  void releaseReady();
+  void cancelQueue();
+  void onCompletionFinished(HedgedRequest *request);
+  QString hedgeSecondaryModel() const;
+  // True when every action in the reply passes AIActionRegistry::validate
+  bool validateReply(const QJsonObject &message) const;
+  void handleAssistantMessage(const QJsonObject &message,
+                              const QString &badge);
+  void handleLocalCommand(const QString &text, const QJsonObject &action,
+                          const QElapsedTimer &timer);
+  QStringList applyLocalCommand(const QString &text,
+                                const QJsonObject &action);
+  // Results are aligned with actions unless the batch was rolled back
+  QStringList applyActions(const QList<QJsonObject> &actions,
+                           bool *rolledBack = nullptr);
+  // Same, but large batches are time-sliced and done() runs later
+  void applyActionsAsync(
+      const QList<QJsonObject> &actions,
+      std::function<void(const QStringList &results, bool rolledBack)> done);
+  void cancelBatch();
+  void processAIResponse(const QString &content, const QString &badge);
+  void updateCacheButton();
+  void updateHedgeButton();
   QString formatAIMessage(const QString &content);
-  void addMessageUI(const QString &text, bool isUser);
+  void addMessageUI(const QString &text, bool isUser,
+                    const QString &badge = QString());
   void clearChatUI();
+  static QVector<ChatEntry> transcriptEntries(const QJsonArray &messages);
+  void loadOlderHistory();
+  void resetMessages();
+  // Appends to m_messages and the project's chat log
+  void appendMessage(const QJsonObject &message);
+  void trimContextWindow();
   void updateModelSelector();
 
-  QList<QJsonObject> extractAllJson(const QString &text);
   QString executeAction(const QJsonObject &data);
   QString describeAction(const QJsonObject &data);
-  QString cleanJsonFromText(const QString &text);
-  QPair<int, int> getTaskPosition();
 
-  QNetworkAccessManager *m_networkManager;
+  ProviderRegistry *m_providers;
   QString m_apiKey;
+  QString m_currentProvider;
   QString m_currentModel;
   QStringList m_models;
   QJsonArray m_messages;
   QString m_currentProject;
+  // Log index of the oldest message shown in the transcript
+  int m_transcriptFrom = 0;
+  // Tasks on the board, kept current by the actions between snapshots
   int m_taskCounter = 0;
-  QString m_tasksContext;
+  // Next cell of the fixed grid, used when no placement is set
+  int m_positionCounter = 0;
+  std::function<QPoint(int)> m_placeTask;
+  TaskContext m_context;
+  ResponseCache m_cache;
+  RequestQueue m_queue;
+  int m_maxInFlight = 3;
+  // Replies wait in the queue while a batch runs
+  ActionBatchRunner *m_batchRunner = nullptr;
+  quint64 m_progressId = 0; // transcript row showing batch progress
+  HedgePolicy m_hedgePolicy;
+  BpeTokenizer m_tokenizer;
+  // Tokens of m_messages, -1 when it changed since the last count
+  int m_historyTokens = -1;
+  // Tokens of the task context without a query, -1 when the board changed
+  int m_contextTokens = -1;
+  bool m_hedgeEnabled = false;
+  QString m_hedgeModel;
 
-  QVBoxLayout *m_messagesLayout;
-  QWidget *m_messagesWidget;
-  QScrollArea *m_scrollArea;
+  ChatTranscriptModel *m_transcript;
+  QListView *m_transcriptView;
   QLineEdit *m_inputField;
   QPushButton *m_sendBtn;
+  QPushButton *m_cacheBtn;
+  QPushButton *m_cancelBatchBtn;
+  QPushButton *m_hedgeBtn;
   QComboBox *m_modelSelector;
   QLabel *m_statusLabel;
+  QLabel *m_tokenLabel;
 };
 
 } // namespace DevPlanner
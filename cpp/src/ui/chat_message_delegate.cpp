@@ -0,0 +1,178 @@
+#include "chat_message_delegate.hpp"
+#include "chat_transcript_model.hpp"
+#include <QFontMetrics>
+#include <QListView>
+#include <QPainter>
+#include <QPersistentModelIndex>
+#include <QtMath>
+
+namespace DevPlanner {
+
+namespace {
+
+constexpr int OUTER_V = 9;   // gap between bubbles
+constexpr int EDGE = 4;      // bubble to viewport edge
+constexpr int INDENT = 40;   // opposite-side indent
+constexpr int PADDING_H = 16;
+constexpr int PADDING_V = 12;
+constexpr int HEADER_SPACING = 6;
+constexpr qreal RADIUS = 16.0;
+
+} // namespace
+
+ChatMessageDelegate::ChatMessageDelegate(QListView *view)
+    : QStyledItemDelegate(view), m_view(view) {
+  m_textFont = view->font();
+  m_textFont.setPixelSize(14);
+  m_headerFont = view->font();
+  m_headerFont.setPixelSize(9);
+  m_headerFont.setWeight(QFont::Black);
+  m_headerFont.setLetterSpacing(QFont::AbsoluteSpacing, 2);
+}
+
+int ChatMessageDelegate::textWidth() const {
+  return qMax(40, m_view->viewport()->width() - INDENT - 2 * EDGE -
+                      2 * PADDING_H);
+}
+
+int ChatMessageDelegate::rowHeight(int textHeight) const {
+  return 2 * OUTER_V + 2 * PADDING_V + QFontMetrics(m_headerFont).height() +
+         HEADER_SPACING + textHeight;
+}
+
+int ChatMessageDelegate::estimateTextHeight(const QString &text,
+                                            int width) const {
+  QFontMetrics fm(m_textFont);
+  // Word wrapping wastes some of each line
+  qreal perLine = qMax(1.0, width / (fm.averageCharWidth() * 1.1));
+  int lines = 0;
+  int run = 0;
+  for (QChar c : text) {
+    if (c == '\n') {
+      lines += qMax(1, qCeil(run / perLine));
+      run = 0;
+    } else {
+      run++;
+    }
+  }
+  lines += qMax(1, qCeil(run / perLine));
+  return lines * fm.lineSpacing();
+}
+
+const ChatMessageDelegate::CachedLayout &
+ChatMessageDelegate::layoutFor(const QModelIndex &index) const {
+  quint64 id = index.data(ChatTranscriptModel::IdRole).toULongLong();
+  int width = textWidth();
+  auto it = m_cache.find(id);
+  if (it != m_cache.end() && it->width == width)
+    return *it;
+
+  if (m_cache.size() >= MAX_CACHED) {
+    m_cache.clear();
+    m_reported.clear();
+  }
+
+  QString text = index.data(Qt::DisplayRole).toString();
+  text.replace('\n', QChar::LineSeparator);
+  auto layout = std::make_shared<QTextLayout>(text, m_textFont);
+  QTextOption option;
+  option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+  layout->setTextOption(option);
+  layout->setCacheEnabled(true);
+
+  qreal height = 0;
+  layout->beginLayout();
+  for (QTextLine line = layout->createLine(); line.isValid();
+       line = layout->createLine()) {
+    line.setLineWidth(width);
+    line.setPosition(QPointF(0, height));
+    height += line.height();
+  }
+  layout->endLayout();
+
+  CachedLayout cached;
+  cached.width = width;
+  cached.textHeight = qCeil(height);
+  cached.layout = std::move(layout);
+  return *m_cache.insert(id, cached);
+}
+
+QSize ChatMessageDelegate::sizeHint(const QStyleOptionViewItem &option,
+                                    const QModelIndex &index) const {
+  Q_UNUSED(option);
+  quint64 id = index.data(ChatTranscriptModel::IdRole).toULongLong();
+  int width = textWidth();
+
+  int textHeight;
+  auto it = m_cache.constFind(id);
+  if (it != m_cache.constEnd() && it->width == width) {
+    textHeight = it->textHeight;
+  } else {
+    textHeight =
+        estimateTextHeight(index.data(Qt::DisplayRole).toString(), width);
+  }
+  int height = rowHeight(textHeight);
+  m_reported.insert(id, height);
+  return QSize(m_view->viewport()->width(), height);
+}
+
+void ChatMessageDelegate::paint(QPainter *painter,
+                                const QStyleOptionViewItem &option,
+                                const QModelIndex &index) const {
+  bool isUser = index.data(ChatTranscriptModel::IsUserRole).toBool();
+  bool selected = option.state & QStyle::State_Selected;
+  const CachedLayout &cached = layoutFor(index);
+
+  painter->save();
+  painter->setRenderHint(QPainter::Antialiasing);
+
+  QRect bubble = option.rect.adjusted(isUser ? INDENT : EDGE, OUTER_V,
+                                      isUser ? -EDGE : -INDENT, -OUTER_V);
+  QColor bg = isUser ? QColor(217, 0, 255, 38) : QColor(0, 255, 157, 20);
+  QColor border = isUser ? QColor(217, 0, 255, 102) : QColor(0, 255, 157, 64);
+  if (selected)
+    border.setAlpha(220);
+  painter->setPen(QPen(border, 1));
+  painter->setBrush(bg);
+  painter->drawRoundedRect(QRectF(bubble).adjusted(0.5, 0.5, -0.5, -0.5),
+                           RADIUS, RADIUS);
+
+  QString header = isUser ? "ВЫ" : "AI ASSISTANT";
+  QString badge = index.data(ChatTranscriptModel::BadgeRole).toString();
+  if (!badge.isEmpty())
+    header += " · " + badge;
+  int headerHeight = QFontMetrics(m_headerFont).height();
+  QRect headerRect(bubble.left() + PADDING_H, bubble.top() + PADDING_V,
+                   bubble.width() - 2 * PADDING_H, headerHeight);
+  painter->setFont(m_headerFont);
+  painter->setPen(isUser ? QColor("#d900ff") : QColor("#00ff9d"));
+  painter->drawText(headerRect,
+                    (isUser ? Qt::AlignRight : Qt::AlignLeft) |
+                        Qt::AlignVCenter,
+                    header);
+
+  painter->setPen(isUser ? QColor(255, 255, 255)
+                         : QColor(255, 255, 255, 230));
+  cached.layout->draw(painter,
+                      QPointF(headerRect.left(),
+                              headerRect.bottom() + 1 + HEADER_SPACING));
+  painter->restore();
+
+  // The view laid this row out with an estimate; fix it once it is known
+  quint64 id = index.data(ChatTranscriptModel::IdRole).toULongLong();
+  int exact = rowHeight(cached.textHeight);
+  if (m_reported.value(id) != exact) {
+    m_reported.insert(id, exact);
+    QPersistentModelIndex persistent(index);
+    auto *self = const_cast<ChatMessageDelegate *>(this);
+    QMetaObject::invokeMethod(
+        self,
+        [self, persistent]() {
+          if (persistent.isValid())
+            emit self->sizeHintChanged(persistent);
+        },
+        Qt::QueuedConnection);
+  }
+}
+
+} // namespace DevPlanner
@@ -0,0 +1,54 @@
+#ifndef CHAT_MESSAGE_DELEGATE_HPP
+#define CHAT_MESSAGE_DELEGATE_HPP
+
+#include <QFont>
+#include <QHash>
+#include <QStyledItemDelegate>
+#include <QTextLayout>
+#include <memory>
+
+class QListView;
+
+namespace DevPlanner {
+
+// Paints chat bubbles for ChatTranscriptModel. Text layouts are built only
+// when a row is painted and cached per message id and width; rows that were
+// never visible report an estimated height, corrected on first paint.
+class ChatMessageDelegate : public QStyledItemDelegate {
+  Q_OBJECT
+
+public:
+  explicit ChatMessageDelegate(QListView *view);
+
+  void paint(QPainter *painter, const QStyleOptionViewItem &option,
+             const QModelIndex &index) const override;
+  QSize sizeHint(const QStyleOptionViewItem &option,
+                 const QModelIndex &index) const override;
+
+  void clearCache() { m_cache.clear(); }
+
+private:
+  struct CachedLayout {
+    int width = 0;
+    int textHeight = 0;
+    std::shared_ptr<QTextLayout> layout;
+  };
+
+  int textWidth() const;
+  int estimateTextHeight(const QString &text, int width) const;
+  const CachedLayout &layoutFor(const QModelIndex &index) const;
+  int rowHeight(int textHeight) const;
+
+  QListView *m_view;
+  QFont m_textFont;
+  QFont m_headerFont;
+  mutable QHash<quint64, CachedLayout> m_cache;
+  // Heights handed to the view, to detect when an estimate was off
+  mutable QHash<quint64, int> m_reported;
+
+  static constexpr int MAX_CACHED = 2000;
+};
+
+} // namespace DevPlanner
+
+#endif
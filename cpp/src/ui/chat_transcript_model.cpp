@@ -0,0 +1,75 @@
+#include "chat_transcript_model.hpp"
+
+namespace DevPlanner {
+
+ChatTranscriptModel::ChatTranscriptModel(QObject *parent)
+    : QAbstractListModel(parent) {}
+
+int ChatTranscriptModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_entries.size();
+}
+
+QVariant ChatTranscriptModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= m_entries.size())
+    return QVariant();
+  const ChatEntry &entry = m_entries[index.row()];
+  switch (role) {
+  case Qt::DisplayRole:
+    return entry.text;
+  case IsUserRole:
+    return entry.isUser;
+  case BadgeRole:
+    return entry.badge;
+  case IdRole:
+    return m_ids[index.row()];
+  default:
+    return QVariant();
+  }
+}
+
+quint64 ChatTranscriptModel::append(const ChatEntry &entry) {
+  int row = m_entries.size();
+  beginInsertRows(QModelIndex(), row, row);
+  m_entries.append(entry);
+  m_ids.append(m_nextId++);
+  endInsertRows();
+  return m_ids.last();
+}
+
+quint64 ChatTranscriptModel::setText(quint64 id, const QString &text) {
+  // Rows being updated are usually near the bottom
+  int row = m_ids.lastIndexOf(id);
+  if (row < 0)
+    return 0;
+  m_entries[row].text = text;
+  // A new id drops the delegate's cached layout for the row
+  m_ids[row] = m_nextId++;
+  QModelIndex idx = index(row);
+  emit dataChanged(idx, idx);
+  return m_ids[row];
+}
+
+void ChatTranscriptModel::prepend(const QVector<ChatEntry> &entries) {
+  if (entries.isEmpty())
+    return;
+  beginInsertRows(QModelIndex(), 0, entries.size() - 1);
+  QVector<quint64> ids(entries.size());
+  for (auto &id : ids)
+    id = m_nextId++;
+  m_entries = entries + m_entries;
+  m_ids = ids + m_ids;
+  endInsertRows();
+}
+
+void ChatTranscriptModel::setEntries(const QVector<ChatEntry> &entries) {
+  beginResetModel();
+  m_entries = entries;
+  m_ids.resize(entries.size());
+  for (auto &id : m_ids)
+    id = m_nextId++;
+  endResetModel();
+}
+
+void ChatTranscriptModel::clear() { setEntries(QVector<ChatEntry>()); }
+
+} // namespace DevPlanner
@@ -0,0 +1,49 @@
+#ifndef CHAT_TRANSCRIPT_MODEL_HPP
+#define CHAT_TRANSCRIPT_MODEL_HPP
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVector>
+
+namespace DevPlanner {
+
+struct ChatEntry {
+  QString text;
+  bool isUser = false;
+  QString badge;
+};
+
+// Chat messages for the transcript QListView. Every row has an id that
+// survives inserts above it, so the delegate can key its layout cache.
+class ChatTranscriptModel : public QAbstractListModel {
+  Q_OBJECT
+
+public:
+  enum Role { IsUserRole = Qt::UserRole + 1, BadgeRole, IdRole };
+
+  explicit ChatTranscriptModel(QObject *parent = nullptr);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+
+  // Returns the id of the new row
+  quint64 append(const ChatEntry &entry);
+  // Replaces a row's text; the row gets a new id, which is returned (0 if
+  // the row is gone)
+  quint64 setText(quint64 id, const QString &text);
+  // Inserts older messages above the current ones
+  void prepend(const QVector<ChatEntry> &entries);
+  // Replaces everything with a single reset
+  void setEntries(const QVector<ChatEntry> &entries);
+  void clear();
+
+private:
+  QVector<ChatEntry> m_entries;
+  QVector<quint64> m_ids;
+  quint64 m_nextId = 1;
+};
+
+} // namespace DevPlanner
+
+#endif
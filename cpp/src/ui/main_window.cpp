@@ -13,6 +13,7 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QScrollArea>
+#include <QShortcut>
 #include <QSplitter>
 #include <QVBoxLayout>
 
@@ -101,8 +102,48 @@ void MainWindow::setupToolbar(QVBoxLayout *layout) {
     if (m_canvas)
       m_canvas->setNoteMode(checked);
   });
+  auto *bundle = new ModernButton("BUNDLE", QColor(217, 0, 255, 60), this);
+  bundle->setCheckable(true);
+  connect(bundle, &QPushButton::toggled, this, [this, bundle](bool checked) {
+    bundle->setText(checked ? "BUNDLE ✓" : "BUNDLE");
+    if (m_canvas)
+      m_canvas->setEdgeBundling(checked);
+  });
+  auto *path = new ModernButton("PATH", QColor(255, 204, 0, 80), this);
+  path->setCheckable(true);
+  connect(path, &QPushButton::toggled, this, [this, path](bool checked) {
+    path->setText(checked ? "PATH ✓" : "PATH");
+    if (m_canvas)
+      m_canvas->setAnalysisVisible(checked);
+  });
+  auto *arr = new ModernButton("ARRANGE", QColor(217, 0, 255, 100), this);
+  connect(arr, &QPushButton::clicked, this, [this, arr]() {
+    QMenu m;
+    m.setStyleSheet(
+        "QMenu { background: #1a1a1e; color: #ffffff; border: 1px "
+        "solid rgba(255,255,255,0.1); } "
+        "QMenu::item:selected { background: rgba(217,0,255,0.3); }");
+    const QList<QPair<QString, QString>> types = {{"Tree", "tree"},
+                                                  {"Grid", "grid"},
+                                                  {"Horizontal", "horizontal"},
+                                                  {"Vertical", "vertical"},
+                                                  {"Force", "force"},
+                                                  {"Pack", "pack"}};
+    for (const auto &t : types) {
+      QString type = t.second;
+      connect(m.addAction(t.first), &QAction::triggered, this,
+              [this, type]() {
+                if (!m_canvas->editingLocked())
+                  m_canvas->arrange(type);
+              });
+    }
+    m.exec(arr->mapToGlobal(QPoint(0, arr->height())));
+  });
   l->addWidget(clr);
   l->addWidget(m_noteModeBtn);
+  l->addWidget(bundle);
+  l->addWidget(path);
+  l->addWidget(arr);
   l->addStretch();
 
   for (auto it = getStatuses().begin(); it != getStatuses().end(); ++it) {
@@ -128,6 +169,9 @@ void MainWindow::setupContent(QVBoxLayout *layout) {
   connect(m_canvas, &NodeCanvas::changed, this, &MainWindow::scheduleAutosave);
   connect(m_canvas, &NodeCanvas::zoomChanged, this,
           &MainWindow::updateZoomLabel);
+  auto *undo = new QShortcut(QKeySequence::Undo, this);
+  connect(undo, &QShortcut::activated, this,
+          [this]() { m_canvas->undoLastTransaction(); });
   s->addWidget(m_canvas);
   s->setSizes({220, 1180});
   layout->addWidget(s, 1);
@@ -292,7 +336,7 @@ void MainWindow::updateZoomLabel(int p) {
 }
 
 void MainWindow::clearAll() {
-  if (!m_currentProject.isEmpty() &&
+  if (!m_currentProject.isEmpty() && !m_canvas->editingLocked() &&
       QMessageBox::Yes ==
           QMessageBox::question(this, "Clear", "Clear all tasks?")) {
     m_canvas->clearAll();
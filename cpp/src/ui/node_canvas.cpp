@@ -1,15 +1,27 @@
 #include "node_canvas.hpp"
 #include "core/config.hpp"
+#include "layout/edge_router.hpp"
+#include "layout/layered_layout.hpp"
+#include "layout/layout_transition.hpp"
+#include "layout/placement_index.hpp"
+#include "layout/skyline_packer.hpp"
 #include "task_node.hpp"
+#include <QDate>
 #include <QGestureEvent>
+#include <QHash>
 #include <QLinearGradient>
+#include <QLocale>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPinchGesture>
+#include <QPolygonF>
 #include <QRadialGradient>
 #include <QRandomGenerator>
+#include <QSet>
 #include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
 
 namespace DevPlanner {
 
@@ -49,6 +61,40 @@ NodeCanvas::NodeCanvas(QWidget *parent) : QWidget(parent) {
   m_blobTimer = new QTimer(this);
   connect(m_blobTimer, &QTimer::timeout, this, &NodeCanvas::updateBlobs);
   m_blobTimer->start(33);
+
+  m_transitionTimer = new QTimer(this);
+  m_transitionTimer->setInterval(16);
+  connect(m_transitionTimer, &QTimer::timeout, this,
+          &NodeCanvas::advanceTransition);
+
+  m_forceTimer = new QTimer(this);
+  m_forceTimer->setInterval(ForceLayoutRunner::FRAME_MS);
+  connect(m_forceTimer, &QTimer::timeout, this, &NodeCanvas::applyForceFrame);
+
+  m_routingDelay = new QTimer(this);
+  m_routingDelay->setSingleShot(true);
+  m_routingDelay->setInterval(ROUTING_DELAY_MS);
+  connect(m_routingDelay, &QTimer::timeout, this, &NodeCanvas::startRouting);
+  m_routingPoll = new QTimer(this);
+  m_routingPoll->setInterval(16);
+  connect(m_routingPoll, &QTimer::timeout, this, &NodeCanvas::applyRoutes);
+  m_bundlingPoll = new QTimer(this);
+  m_bundlingPoll->setInterval(16);
+  connect(m_bundlingPoll, &QTimer::timeout, this, &NodeCanvas::applyBundles);
+  // Zero delay: status edits made in one go are propagated together
+  m_propagationDelay = new QTimer(this);
+  m_propagationDelay->setSingleShot(true);
+  connect(m_propagationDelay, &QTimer::timeout, this,
+          &NodeCanvas::propagateStatuses);
+  m_simulationDelay = new QTimer(this);
+  m_simulationDelay->setSingleShot(true);
+  m_simulationDelay->setInterval(SIMULATION_DELAY_MS);
+  connect(m_simulationDelay, &QTimer::timeout, this,
+          &NodeCanvas::startSimulation);
+  m_simulationPoll = new QTimer(this);
+  m_simulationPoll->setInterval(16);
+  connect(m_simulationPoll, &QTimer::timeout, this,
+          &NodeCanvas::applySimulation);
 }
 
 NodeCanvas::~NodeCanvas() { clearAll(); }
@@ -57,22 +103,53 @@ TaskNode *NodeCanvas::addNode(qreal x, qreal y, bool emitChanged) {
   QString title = m_noteMode ? "" : "New Task";
   TaskNode *node = new TaskNode(x, y, this, title, this);
   m_nodes.append(node);
+  int id = m_graph.addNode(remainingWork(node));
+  m_graphIds.insert(node, id);
+  if (id >= m_graphNodes.size())
+    m_graphNodes.resize(id + 1);
+  m_graphNodes[id] = node;
+  if (!m_placementDirty)
+    m_placement.insert({x, y, TaskNode::BASE_WIDTH, TaskNode::BASE_HEIGHT});
   node->updateScale(m_scale);
+  node->setEnabled(!m_editingLocked);
   updateNodePosition(node);
   connect(node, &TaskNode::changed, this, &NodeCanvas::onNodeChanged);
   connect(node, &TaskNode::deleteRequested, this,
           &NodeCanvas::onNodeDeleteRequested);
   connect(node, &TaskNode::connectionRequested, this,
           &NodeCanvas::onNodeConnectionRequested);
-  update();
+  scheduleRouting(QRectF(x, y, TaskNode::BASE_WIDTH, TaskNode::BASE_HEIGHT));
+  scheduleSimulation();
+  requestRepaint();
   if (emitChanged)
-    emit changed();
+    notifyChanged();
   return node;
 }
 
 void NodeCanvas::removeNode(TaskNode *node, bool emitChanged) {
   if (!m_nodes.contains(node))
     return;
+  cancelForceLayout();
+  finishTransition();
+  m_placementDirty = true;
+  int id = m_graphIds.take(node);
+  m_graph.removeNode(id);
+  m_reach.nodeRemoved(id);
+  if (m_hoveredNode == node)
+    m_hoveredNode = nullptr;
+  m_graphNodes[id] = nullptr;
+  m_criticality.remove(node);
+  schedulePropagation();
+  scheduleSimulation();
+  dropRoutes(node);
+  if (m_bundleNodes.contains(node)) {
+    m_bundleNodes.clear();
+    m_bundles = EdgeBundles();
+  }
+  if (m_bundlingNodes.contains(node))
+    m_bundlingNodes.clear(); // its result no longer matches the board
+  scheduleRouting(QRectF(node->nodeX(), node->nodeY(), TaskNode::BASE_WIDTH,
+                         TaskNode::BASE_HEIGHT));
   m_connections.erase(std::remove_if(m_connections.begin(), m_connections.end(),
                                      [node](const auto &c) {
                                        return c.first == node ||
@@ -81,12 +158,42 @@ void NodeCanvas::removeNode(TaskNode *node, bool emitChanged) {
                       m_connections.end());
   m_nodes.removeOne(node);
   node->deleteLater();
-  update();
+  requestRepaint();
   if (emitChanged)
-    emit changed();
+    notifyChanged();
 }
 
 void NodeCanvas::clearAll() {
+  resetHistory();
+  clearBoard();
+}
+
+void NodeCanvas::clearBoard() {
+  cancelForceLayout();
+  resetTransition();
+  m_router.stop();
+  m_routingPoll->stop();
+  m_routingDelay->stop();
+  m_routingEdges.clear();
+  m_routes.clear();
+  m_bundler.stop();
+  m_bundlingPoll->stop();
+  m_bundlingNodes.clear();
+  m_bundleNodes.clear();
+  m_bundles = EdgeBundles();
+  m_propagationDelay->stop();
+  m_simulator.stop();
+  m_simulationDelay->stop();
+  m_simulationPoll->stop();
+  m_simulatingNodes.clear();
+  m_forecast = SimulationResult();
+  m_criticality.clear();
+  m_graph.clear();
+  m_reach.clear();
+  m_graphIds.clear();
+  m_graphNodes.clear();
+  m_hoveredNode = nullptr;
+  m_placementDirty = true;
   for (auto *n : m_nodes)
     n->deleteLater();
   m_nodes.clear();
@@ -97,6 +204,13 @@ void NodeCanvas::clearAll() {
 void NodeCanvas::updateNodePosition(TaskNode *n) {
   n->move(static_cast<int>(n->nodeX() * m_scale + m_offset.x()),
           static_cast<int>(n->nodeY() * m_scale + m_offset.y()));
+  // Off-screen nodes keep no child widgets until they are panned into view
+  if (!n->isMaterialized() &&
+      rect()
+          .adjusted(-MATERIALIZE_MARGIN, -MATERIALIZE_MARGIN,
+                    MATERIALIZE_MARGIN, MATERIALIZE_MARGIN)
+          .intersects(n->geometry()))
+    n->materialize();
 }
 
 void NodeCanvas::updateAllNodes() {
@@ -105,7 +219,715 @@ void NodeCanvas::updateAllNodes() {
   update();
 }
 
+void NodeCanvas::arrange(const QString &type) {
+  if (type == "force") {
+    startForceLayout();
+    return;
+  }
+  if (m_nodes.isEmpty())
+    return;
+  stopForceLayout();
+
+  LayeredLayout::Options options;
+  options.nodeWidth = TaskNode::BASE_WIDTH;
+  options.nodeHeight = TaskNode::BASE_HEIGHT;
+  if (type == "horizontal")
+    options.direction = LayeredLayout::Direction::LeftToRight;
+
+  QList<TaskNode *> order = m_nodes;
+  std::vector<LayoutPoint> points;
+  if (type == "grid" || type == "pack") {
+    // Rows follow the current reading order, top to bottom, left to right
+    std::stable_sort(order.begin(), order.end(),
+                     [](const TaskNode *a, const TaskNode *b) {
+                       if (qFuzzyCompare(a->nodeY(), b->nodeY()))
+                         return a->nodeX() < b->nodeX();
+                       return a->nodeY() < b->nodeY();
+                     });
+  }
+  if (type == "grid") {
+    points = LayeredLayout::grid(order.size(), options);
+  } else if (type == "pack") {
+    // One block per status, in workflow order
+    static const QStringList STATUS_ORDER = {
+        "blocked", "todo", "ready", "progress", "done", "none", "cancelled"};
+    std::vector<PackItem> items;
+    items.reserve(order.size());
+    for (auto *n : order) {
+      int group = static_cast<int>(STATUS_ORDER.indexOf(n->status()));
+      if (group < 0)
+        group = static_cast<int>(STATUS_ORDER.size());
+      items.push_back({static_cast<double>(TaskNode::BASE_WIDTH),
+                       static_cast<double>(TaskNode::BASE_HEIGHT), group});
+    }
+    points = SkylinePacker::pack(items, SkylinePacker::Options());
+  } else {
+    QHash<TaskNode *, int> index;
+    for (int i = 0; i < order.size(); ++i)
+      index.insert(order[i], i);
+    std::vector<LayoutEdge> edges;
+    edges.reserve(m_connections.size());
+    for (const auto &c : m_connections)
+      edges.push_back({index.value(c.first), index.value(c.second)});
+    points = LayeredLayout::compute(order.size(), edges, options);
+  }
+
+  // Keep the board where it was instead of jumping to the origin
+  qreal left = order[0]->nodeX();
+  qreal top = order[0]->nodeY();
+  for (auto *n : order) {
+    left = qMin(left, n->nodeX());
+    top = qMin(top, n->nodeY());
+  }
+
+  std::vector<LayoutPoint> targets(order.size());
+  for (int i = 0; i < order.size(); ++i)
+    targets[i] = {left + points[i].x, top + points[i].y};
+  moveNodesAnimated(order, targets);
+}
+
+void NodeCanvas::moveNodesAnimated(const QList<TaskNode *> &nodes,
+                                   const std::vector<LayoutPoint> &targets) {
+  // Nodes off screen at both ends jump; only what can be seen glides
+  QRectF view = QRectF(rect()).adjusted(-MATERIALIZE_MARGIN,
+                                        -MATERIALIZE_MARGIN,
+                                        MATERIALIZE_MARGIN, MATERIALIZE_MARGIN);
+  auto onScreen = [&](qreal x, qreal y) {
+    return view.intersects(QRectF(x * m_scale + m_offset.x(),
+                                  y * m_scale + m_offset.y(),
+                                  TaskNode::BASE_WIDTH * m_scale,
+                                  TaskNode::BASE_HEIGHT * m_scale));
+  };
+
+  // The transaction records the final layout; the glide is display only
+  QList<TaskNode *> moving;
+  std::vector<LayoutPoint> from;
+  std::vector<LayoutPoint> to;
+  beginTransaction();
+  for (int i = 0; i < nodes.size(); ++i) {
+    TaskNode *n = nodes[i];
+    const LayoutPoint &t = targets[i];
+    if (qFuzzyCompare(n->nodeX(), t.x) && qFuzzyCompare(n->nodeY(), t.y))
+      continue;
+    if (onScreen(n->nodeX(), n->nodeY()) || onScreen(t.x, t.y)) {
+      moving.append(n);
+      from.push_back({n->nodeX(), n->nodeY()});
+      to.push_back(t);
+    }
+    n->setNodePosition(t.x, t.y);
+    updateNodePosition(n);
+  }
+  m_placementDirty = true;
+  scheduleRouting();
+  requestRepaint();
+  notifyChanged();
+  commitTransaction();
+
+  // A transition still running is picked up from where its nodes are now
+  resetTransition();
+  if (moving.isEmpty())
+    return;
+  m_transitionNodes = moving;
+  for (int i = 0; i < moving.size(); ++i) {
+    m_transitionIndex.insert(moving[i], i);
+    moving[i]->setNodePosition(from[i].x, from[i].y);
+    updateNodePosition(moving[i]);
+  }
+  m_transition.start(from, to, TRANSITION_MS);
+  m_transitionClock.start();
+  m_transitionTimer->start();
+}
+
+void NodeCanvas::advanceTransition() {
+  bool running =
+      m_transition.sample(m_transitionClock.elapsed(), &m_transitionFrame);
+  for (int i = 0; i < m_transitionNodes.size(); ++i) {
+    TaskNode *n = m_transitionNodes[i];
+    n->setNodePosition(m_transitionFrame[i].x, m_transitionFrame[i].y);
+    updateNodePosition(n);
+  }
+  requestRepaint();
+  if (!running)
+    resetTransition();
+}
+
+void NodeCanvas::resetTransition() {
+  m_transitionTimer->stop();
+  m_transitionNodes.clear();
+  m_transitionIndex.clear();
+  m_transition.clear();
+}
+
+void NodeCanvas::finishTransition() {
+  if (m_transitionNodes.isEmpty())
+    return;
+  for (int i = 0; i < m_transitionNodes.size(); ++i) {
+    LayoutPoint t = m_transition.target(i);
+    m_transitionNodes[i]->setNodePosition(t.x, t.y);
+    updateNodePosition(m_transitionNodes[i]);
+  }
+  resetTransition();
+  requestRepaint();
+}
+
+QPointF NodeCanvas::freeNodePosition(int nearIdx) {
+  finishTransition();
+  if (m_placementDirty) {
+    m_placement.clear();
+    for (auto *n : m_nodes) {
+      m_placement.insert({n->nodeX(), n->nodeY(), TaskNode::BASE_WIDTH,
+                          TaskNode::BASE_HEIGHT});
+    }
+    m_placementDirty = false;
+  }
+
+  LayoutPoint anchor;
+  if (nearIdx >= 0 && nearIdx < m_nodes.size()) {
+    // To the right of the node, the direction chains flow in
+    TaskNode *n = m_nodes[nearIdx];
+    anchor = {n->nodeX() + TaskNode::BASE_WIDTH + PLACEMENT_GAP, n->nodeY()};
+  } else {
+    QPointF centre = (QPointF(width(), height()) / 2 - m_offset) / m_scale;
+    anchor = {centre.x() - TaskNode::BASE_WIDTH / 2.0,
+              centre.y() - TaskNode::BASE_HEIGHT / 2.0};
+    // Repeated drops on an unchanged view continue from the previous one
+    // instead of searching through the cluster they have built
+    if (m_hasLastDrop && m_lastDropCentre == centre)
+      anchor = {m_lastDrop.x(), m_lastDrop.y()};
+    m_lastDropCentre = centre;
+  }
+
+  LayoutPoint p =
+      m_placement.findFree(anchor, TaskNode::BASE_WIDTH,
+                           TaskNode::BASE_HEIGHT, PLACEMENT_GAP);
+  if (nearIdx < 0) {
+    m_lastDrop = QPointF(p.x, p.y);
+    m_hasLastDrop = true;
+  }
+  return QPointF(p.x, p.y);
+}
+
+void NodeCanvas::startForceLayout() {
+  stopForceLayout();
+  finishTransition();
+  if (m_nodes.isEmpty())
+    return;
+
+  QHash<TaskNode *, int> index;
+  std::vector<LayoutPoint> centres;
+  std::vector<char> pinned;
+  centres.reserve(m_nodes.size());
+  pinned.reserve(m_nodes.size());
+  for (int i = 0; i < m_nodes.size(); ++i) {
+    index.insert(m_nodes[i], i);
+    QPointF c = m_nodes[i]->getCenter();
+    centres.push_back({c.x(), c.y()});
+    pinned.push_back(m_nodes[i]->isPinned());
+  }
+  std::vector<LayoutEdge> edges;
+  edges.reserve(m_connections.size());
+  for (const auto &c : m_connections)
+    edges.push_back({index.value(c.first), index.value(c.second)});
+
+  m_forceNodes = m_nodes;
+  m_forceSnapshot = getProjectData();
+  m_forceLayout.start(std::move(centres), edges, std::move(pinned),
+                      ForceLayout::Options());
+  m_forceTimer->start();
+}
+
+void NodeCanvas::stopForceLayout() {
+  if (m_forceNodes.isEmpty())
+    return;
+  m_forceLayout.stop();
+  m_forceTimer->stop();
+  m_forceNodes.clear();
+  scheduleRouting();
+  notifyChanged();
+  // Same bookkeeping as commitTransaction: one undo step for the whole run
+  if (m_transactionDepth == 0)
+    m_undoSnapshot = m_forceSnapshot;
+  m_forceSnapshot = QJsonObject();
+}
+
+void NodeCanvas::cancelForceLayout() {
+  if (m_forceNodes.isEmpty())
+    return;
+  m_forceLayout.stop();
+  m_forceTimer->stop();
+  m_forceNodes.clear();
+  m_forceSnapshot = QJsonObject();
+}
+
+void NodeCanvas::applyForceFrame() {
+  std::vector<LayoutPoint> frame;
+  bool finished = false;
+  if (!m_forceLayout.takeFrame(&frame, &finished))
+    return;
+  if (frame.size() == static_cast<size_t>(m_forceNodes.size())) {
+    for (int i = 0; i < m_forceNodes.size(); ++i) {
+      TaskNode *n = m_forceNodes[i];
+      if (n->isPinned() || n->isDragging())
+        continue;
+      n->setNodePosition(frame[i].x - TaskNode::BASE_WIDTH / 2.0,
+                         frame[i].y - TaskNode::BASE_HEIGHT / 2.0);
+      updateNodePosition(n);
+    }
+    m_placementDirty = true;
+    requestRepaint();
+  }
+  if (finished)
+    stopForceLayout();
+}
+
+void NodeCanvas::nodeMoved(TaskNode *node) {
+  scheduleRouting(QRectF(node->nodeX(), node->nodeY(), TaskNode::BASE_WIDTH,
+                         TaskNode::BASE_HEIGHT));
+}
+
+void NodeCanvas::scheduleRouting(const QRectF &area) {
+  if (area.isNull())
+    m_routeAll = true;
+  else
+    m_routeArea = m_routeArea.isNull() ? area : m_routeArea.united(area);
+  // Restarted on every call, so a drag only routes once it pauses
+  m_routingDelay->start();
+}
+
+void NodeCanvas::dropRoutes(TaskNode *node) {
+  for (auto it = m_routes.begin(); it != m_routes.end();) {
+    if (it.key().first == node || it.key().second == node)
+      it = m_routes.erase(it);
+    else
+      ++it;
+  }
+}
+
+void NodeCanvas::startRouting() {
+  // Nodes still moving on their own; their final places get routed
+  if (isForceLayoutRunning())
+    return;
+  // Routes are not drawn while bundling; the requests stay queued for
+  // when it is switched off
+  if (m_edgeBundling) {
+    startBundling();
+    return;
+  }
+  if (m_router.isRunning())
+    return;
+
+  // Where nodes are headed, not where a transition shows them
+  QHash<TaskNode *, int> index;
+  std::vector<LayoutRect> obstacles;
+  obstacles.reserve(m_nodes.size());
+  for (auto *n : m_nodes) {
+    QPointF pos(n->nodeX(), n->nodeY());
+    auto it = m_transitionIndex.constFind(n);
+    if (it != m_transitionIndex.constEnd()) {
+      LayoutPoint t = m_transition.target(it.value());
+      pos = QPointF(t.x, t.y);
+    }
+    index.insert(n, static_cast<int>(obstacles.size()));
+    obstacles.push_back({pos.x(), pos.y(), TaskNode::BASE_WIDTH,
+                         TaskNode::BASE_HEIGHT});
+  }
+
+  // Only edges that are unrouted, whose endpoints moved, or that pass
+  // through the area something changed in
+  std::vector<RouteRequest> requests;
+  m_routingEdges.clear();
+  m_routingEnds.clear();
+  for (const auto &c : m_connections) {
+    int from = index.value(c.first, -1);
+    int to = index.value(c.second, -1);
+    if (from < 0 || to < 0)
+      continue;
+    QPointF a(obstacles[from].x, obstacles[from].y);
+    QPointF b(obstacles[to].x, obstacles[to].y);
+    auto route = m_routes.constFind(c);
+    bool stale = route == m_routes.constEnd() || route->from != a ||
+                 route->to != b;
+    if (!stale && !m_routeAll &&
+        !(!m_routeArea.isNull() && route->bounds.intersects(m_routeArea)))
+      continue;
+    requests.push_back({from, to});
+    m_routingEdges.append(c);
+    m_routingEnds.append(qMakePair(a, b));
+  }
+  m_routeAll = false;
+  m_routeArea = QRectF();
+  if (requests.empty())
+    return;
+  m_router.start(std::move(obstacles), std::move(requests),
+                 EdgeRouter::Options());
+  m_routingPoll->start();
+}
+
+void NodeCanvas::applyRoutes() {
+  std::vector<std::vector<LayoutPoint>> routes;
+  if (!m_router.takeResult(&routes))
+    return;
+  m_routingPoll->stop();
+  if (routes.size() == static_cast<size_t>(m_routingEdges.size())) {
+    // Connections removed while the batch ran are skipped
+    QSet<Edge> live(m_connections.begin(), m_connections.end());
+    for (int i = 0; i < m_routingEdges.size(); ++i) {
+      if (!live.contains(m_routingEdges[i]) || routes[i].empty())
+        continue;
+      EdgeRoute route;
+      route.points.reserve(static_cast<int>(routes[i].size()));
+      for (const auto &pt : routes[i])
+        route.points.append(QPointF(pt.x, pt.y));
+      route.bounds = QPolygonF(route.points).boundingRect();
+      route.from = m_routingEnds[i].first;
+      route.to = m_routingEnds[i].second;
+      m_routes.insert(m_routingEdges[i], route);
+    }
+  }
+  m_routingEdges.clear();
+  m_routingEnds.clear();
+  requestRepaint();
+  // Picks up whatever moved while this batch was out
+  startRouting();
+}
+
+void NodeCanvas::setEdgeBundling(bool enabled) {
+  if (m_edgeBundling == enabled)
+    return;
+  m_edgeBundling = enabled;
+  if (!enabled) {
+    m_bundler.stop();
+    m_bundlingPoll->stop();
+    m_bundlingNodes.clear();
+    m_bundleNodes.clear();
+    m_bundles = EdgeBundles();
+  }
+  scheduleRouting();
+  update();
+}
+
+void NodeCanvas::startBundling() {
+  std::vector<LayoutPoint> centres;
+  centres.reserve(m_nodes.size());
+  QHash<TaskNode *, int> index;
+  for (int i = 0; i < m_nodes.size(); ++i) {
+    TaskNode *n = m_nodes[i];
+    LayoutPoint pos{n->nodeX(), n->nodeY()};
+    auto it = m_transitionIndex.constFind(n);
+    if (it != m_transitionIndex.constEnd())
+      pos = m_transition.target(it.value());
+    centres.push_back({pos.x + TaskNode::BASE_WIDTH / 2.0,
+                       pos.y + TaskNode::BASE_HEIGHT / 2.0});
+    index.insert(n, i);
+  }
+  std::vector<LayoutEdge> edges;
+  edges.reserve(m_connections.size());
+  for (const auto &c : m_connections)
+    edges.push_back({index.value(c.first), index.value(c.second)});
+
+  m_bundlingNodes = m_nodes;
+  m_bundler.start(std::move(centres), std::move(edges),
+                  EdgeBundler::Options());
+  m_bundlingPoll->start();
+}
+
+void NodeCanvas::applyBundles() {
+  EdgeBundles bundles;
+  if (!m_bundler.takeResult(&bundles))
+    return;
+  m_bundlingPoll->stop();
+  if (!m_edgeBundling ||
+      bundles.nodeCount != m_bundlingNodes.size() || m_bundlingNodes.isEmpty())
+    return;
+  m_bundles = std::move(bundles);
+  m_bundleNodes = m_bundlingNodes;
+  m_bundlingNodes.clear();
+  requestRepaint();
+}
+
+void NodeCanvas::drawBundles(QPainter &p) {
+  const int n = m_bundles.nodeCount;
+  auto point = [&](int i) {
+    if (i < n) {
+      TaskNode *t = m_bundleNodes[i];
+      return QPointF(t->x() + t->width() / 2.0, t->y() + t->height() / 2.0);
+    }
+    const LayoutPoint &h = m_bundles.hubs[i - n];
+    return QPointF(h.x, h.y) * m_scale + m_offset;
+  };
+
+  // Strokes sorted into a few thickness classes by how many edges they
+  // carry, one pen and one drawLines() call per class
+  constexpr int CLASSES = 6;
+  QVector<QLineF> lines[CLASSES];
+  QRectF view(rect());
+  for (const auto &s : m_bundles.segments) {
+    QLineF line(point(s.from), point(s.to));
+    if (!view.intersects(QRectF(line.p1(), line.p2()).normalized().adjusted(
+            -1, -1, 1, 1)))
+      continue;
+    int cls = std::min(CLASSES - 1, static_cast<int>(std::log2(s.weight)));
+    lines[cls].append(line);
+  }
+  for (int cls = 0; cls < CLASSES; ++cls) {
+    if (lines[cls].isEmpty())
+      continue;
+    p.setPen(QPen(QColor(217, 0, 255, 70 + cls * 30), 1.0 + cls * 0.8,
+                  Qt::SolidLine, Qt::RoundCap));
+    p.drawLines(lines[cls]);
+  }
+}
+
+double NodeCanvas::remainingWork(const TaskNode *node) {
+  return isFinished(node) ? 0 : 1;
+}
+
+bool NodeCanvas::isFinished(const TaskNode *node) {
+  return node->status() == "done" || node->status() == "cancelled";
+}
+
+void NodeCanvas::nodeStatusChanged(TaskNode *node) {
+  auto it = m_graphIds.constFind(node);
+  if (it == m_graphIds.constEnd())
+    return;
+  m_graph.setWeight(it.value(), remainingWork(node));
+  m_graph.setDone(it.value(), isFinished(node));
+  schedulePropagation();
+  scheduleSimulation();
+  if (m_analysisVisible)
+    requestRepaint();
+}
+
+void NodeCanvas::nodeEstimateChanged(TaskNode *node) {
+  if (m_graphIds.contains(node))
+    scheduleSimulation();
+}
+
+void NodeCanvas::scheduleSimulation() {
+  // Edits in quick succession, e.g. typing estimates, share one run
+  if (m_analysisVisible && !m_graph.inBulk())
+    m_simulationDelay->start();
+}
+
+void NodeCanvas::startSimulation() {
+  std::vector<TaskEstimate> estimates(m_graph.nodeCount());
+  for (int id = 0; id < m_graphNodes.size(); ++id) {
+    const TaskNode *n = m_graphNodes[id];
+    if (n && !isFinished(n))
+      estimates[id] = n->estimate();
+  }
+  m_simulatingNodes = m_graphNodes;
+  m_simulator.start(ScheduleSimulator::plan(m_graph, estimates),
+                    ScheduleSimulator::Options());
+  m_simulationPoll->start();
+}
+
+void NodeCanvas::applySimulation() {
+  SimulationResult result;
+  if (!m_simulator.takeResult(&result))
+    return;
+  m_simulationPoll->stop();
+  m_criticality.clear();
+  const int ids = qMin(m_simulatingNodes.size(),
+                       static_cast<int>(result.criticality.size()));
+  for (int id = 0; id < ids; ++id) {
+    // Nodes removed while the run was out are skipped
+    TaskNode *n = m_simulatingNodes[id];
+    if (n && result.criticality[id] > 0 && m_graphIds.contains(n))
+      m_criticality.insert(n, result.criticality[id]);
+  }
+  m_simulatingNodes.clear();
+  m_forecast = std::move(result);
+  requestRepaint();
+}
+
+void NodeCanvas::schedulePropagation() {
+  if (m_propagating || m_graph.inBulk())
+    return;
+  // Inside a transaction the derived statuses belong to the same batch
+  if (inTransaction())
+    propagateStatuses();
+  else
+    m_propagationDelay->start();
+}
+
+void NodeCanvas::propagateStatuses() {
+  m_propagationDelay->stop();
+  std::vector<int> touched = m_graph.takeTouched();
+  std::sort(touched.begin(), touched.end());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+  // Only the direct dependents of what changed can flip, and a flip between
+  // "ready" and "blocked" finishes nothing, so it goes no further
+  QList<QPair<TaskNode *, QString>> flips;
+  for (int id : touched) {
+    if (id >= m_graphNodes.size() || !m_graphNodes[id])
+      continue;
+    TaskNode *node = m_graphNodes[id];
+    const QString status = node->status();
+    if (status != "none" && status != "todo" && status != "ready" &&
+        status != "blocked")
+      continue;
+    QString wanted;
+    if (!m_graph.predecessors(id).empty())
+      wanted = m_graph.openPredecessors(id) == 0 ? "ready" : "blocked";
+    else if (status == "blocked")
+      wanted = "ready";
+    if (!wanted.isEmpty() && wanted != status)
+      flips.append({node, wanted});
+  }
+  if (flips.isEmpty())
+    return;
+
+  // Derived statuses are not an edit of their own: undo keeps pointing at
+  // the state before whatever caused them
+  QJsonObject undo = m_undoSnapshot;
+  bool nested = inTransaction();
+  m_propagating = true;
+  beginTransaction();
+  for (const auto &flip : flips)
+    flip.first->setStatus(flip.second);
+  commitTransaction();
+  m_propagating = false;
+  if (!nested)
+    m_undoSnapshot = undo;
+}
+
+QList<TaskNode *> NodeCanvas::criticalPath() {
+  QList<TaskNode *> path;
+  for (int id : m_graph.criticalPath())
+    path.append(m_graphNodes[id]);
+  return path;
+}
+
+QList<QPair<TaskNode *, TaskNode *>> NodeCanvas::cyclicConnections() const {
+  QList<QPair<TaskNode *, TaskNode *>> edges;
+  for (const auto &e : m_graph.cycleEdges())
+    edges.append(qMakePair(m_graphNodes[e.first], m_graphNodes[e.second]));
+  return edges;
+}
+
+QList<TaskNode *> NodeCanvas::reachableNodes(TaskNode *node,
+                                             bool downstream) {
+  QList<TaskNode *> out;
+  auto it = m_graphIds.constFind(node);
+  if (it == m_graphIds.constEnd())
+    return out;
+  const SparseBitset &cone = downstream ? m_reach.descendants(it.value())
+                                        : m_reach.ancestors(it.value());
+  cone.forEach([&](int id) { out.append(m_graphNodes[id]); });
+  return out;
+}
+
+void NodeCanvas::setHoveredNode(TaskNode *node) {
+  if (m_hoveredNode == node)
+    return;
+  m_hoveredNode = node;
+  update();
+}
+
+void NodeCanvas::drawCones(QPainter &p) {
+  auto it = m_graphIds.constFind(m_hoveredNode);
+  if (it == m_graphIds.constEnd())
+    return;
+  // Only frames that can be seen are drawn; the cones themselves come
+  // from the cache after the first hover
+  QRect view = rect();
+  p.setBrush(Qt::NoBrush);
+  auto frame = [&](const SparseBitset &cone, const QColor &color) {
+    p.setPen(QPen(color, 2));
+    cone.forEach([&](int id) {
+      QRect g = m_graphNodes[id]->geometry();
+      if (g.intersects(view))
+        p.drawRoundedRect(QRectF(g).adjusted(-4, -4, 4, 4), 13, 13);
+    });
+  };
+  frame(m_reach.ancestors(it.value()), QColor(0, 200, 255, 170));
+  frame(m_reach.descendants(it.value()), QColor(255, 0, 85, 170));
+}
+
+void NodeCanvas::setAnalysisVisible(bool visible) {
+  if (m_analysisVisible == visible)
+    return;
+  m_analysisVisible = visible;
+  scheduleSimulation();
+  update();
+}
+
+void NodeCanvas::drawAnalysis(QPainter &p) {
+  auto centre = [](const TaskNode *n) {
+    return QPointF(n->x() + n->width() / 2.0, n->y() + n->height() / 2.0);
+  };
+
+  // Critical path: a glow along the chain and a frame around each task
+  QList<TaskNode *> path = criticalPath();
+  p.setBrush(Qt::NoBrush);
+  p.setPen(QPen(QColor(255, 204, 0, 90), 8, Qt::SolidLine, Qt::RoundCap,
+                Qt::RoundJoin));
+  for (int i = 1; i < path.size(); ++i)
+    p.drawLine(centre(path[i - 1]), centre(path[i]));
+  p.setPen(QPen(QColor(255, 204, 0, 200), 2));
+  for (const TaskNode *n : path)
+    p.drawRoundedRect(QRectF(n->geometry()).adjusted(-5, -5, 5, 5), 14, 14);
+
+  // Connections that close a cycle are left out of the analysis
+  p.setPen(QPen(QColor(255, 0, 85, 220), 2, Qt::DashLine, Qt::RoundCap));
+  for (const auto &e : m_graph.cycleEdges())
+    p.drawLine(centre(m_graphNodes[e.first]), centre(m_graphNodes[e.second]));
+
+  if (m_forecast.iterations > 0)
+    drawForecast(p);
+}
+
+void NodeCanvas::drawForecast(QPainter &p) {
+  // Badge over each visible open task: how often it was critical
+  const QRect view = rect();
+  QFont font = p.font();
+  font.setPointSizeF(8);
+  p.setFont(font);
+  for (auto it = m_criticality.constBegin(); it != m_criticality.constEnd();
+       ++it) {
+    const TaskNode *n = it.key();
+    if (it.value() < MIN_SHOWN_CRITICALITY || isFinished(n) ||
+        !n->geometry().intersects(view))
+      continue;
+    QRectF badge(n->x() + n->width() - 44, n->y() - 22, 44, 16);
+    p.setPen(Qt::NoPen);
+    p.setBrush(QColor(255, 204, 0, 40 + static_cast<int>(160 * it.value())));
+    p.drawRoundedRect(badge, 8, 8);
+    p.setPen(QColor(20, 20, 28));
+    p.drawText(badge, Qt::AlignCenter,
+               QString("%1%").arg(qRound(it.value() * 100)));
+  }
+
+  // Completion dates at a few confidence levels
+  const QDate today = QDate::currentDate();
+  QStringList levels;
+  for (int level : {50, 80, 95}) {
+    double days = m_forecast.percentile(level);
+    QDate date = today.addDays(static_cast<qint64>(std::ceil(days)));
+    levels.append(QString("P%1 %2 (%3 дн.)")
+                      .arg(level)
+                      .arg(QLocale().toString(date, QLocale::ShortFormat))
+                      .arg(days, 0, 'f', 1));
+  }
+  QString text = QString("Прогноз по %1 прогонам: %2")
+                     .arg(m_forecast.iterations)
+                     .arg(levels.join("  ·  "));
+  font.setPointSizeF(10);
+  p.setFont(font);
+  QRectF box(16, height() - 44, p.fontMetrics().horizontalAdvance(text) + 24,
+             28);
+  p.setPen(QPen(QColor(255, 204, 0, 120), 1));
+  p.setBrush(QColor(20, 20, 28, 220));
+  p.drawRoundedRect(box, 10, 10);
+  p.setPen(QColor(255, 230, 150));
+  p.drawText(box, Qt::AlignCenter, text);
+}
+
 void NodeCanvas::startConnection(TaskNode *n) {
+  if (m_editingLocked)
+    return;
   m_connectingFrom = n;
   setCursor(Qt::CrossCursor);
   update();
@@ -133,8 +955,16 @@ void NodeCanvas::completeConnection(TaskNode *t, bool emitChanged) {
       }
     if (!ex) {
       m_connections.append(qMakePair(m_connectingFrom, t));
+      int from = m_graphIds.value(m_connectingFrom);
+      int to = m_graphIds.value(t);
+      m_graph.addEdge(from, to);
+      m_reach.edgeAdded(from, to);
+      schedulePropagation();
+      scheduleSimulation();
+      scheduleRouting(QRectF(t->nodeX(), t->nodeY(), TaskNode::BASE_WIDTH,
+                             TaskNode::BASE_HEIGHT));
       if (emitChanged)
-        emit changed();
+        notifyChanged();
     }
   }
   if (m_hoverTarget)
@@ -154,17 +984,39 @@ void NodeCanvas::updateConnectionOverlay() { update(); }
 void NodeCanvas::addConnection(TaskNode *f, TaskNode *t) {
   if (f && t && f != t) {
     m_connections.append(qMakePair(f, t));
-    update();
+    int from = m_graphIds.value(f);
+    int to = m_graphIds.value(t);
+    m_graph.addEdge(from, to);
+    m_reach.edgeAdded(from, to);
+    schedulePropagation();
+    scheduleSimulation();
+    scheduleRouting(QRectF(t->nodeX(), t->nodeY(), TaskNode::BASE_WIDTH,
+                           TaskNode::BASE_HEIGHT));
+    requestRepaint();
   }
 }
 void NodeCanvas::removeConnection(TaskNode *f, TaskNode *t) {
+  for (const auto &c : m_connections) {
+    if ((c.first != f || c.second != t) && (c.first != t || c.second != f))
+      continue;
+    int from = m_graphIds.value(c.first);
+    int to = m_graphIds.value(c.second);
+    m_graph.removeEdge(from, to);
+    m_reach.edgeRemoved(from, to);
+  }
+  schedulePropagation();
+  scheduleSimulation();
   m_connections.erase(std::remove_if(m_connections.begin(), m_connections.end(),
                                      [f, t](const auto &c) {
                                        return (c.first == f && c.second == t) ||
                                               (c.first == t && c.second == f);
                                      }),
                       m_connections.end());
-  update();
+  m_routes.remove(qMakePair(f, t));
+  m_routes.remove(qMakePair(t, f));
+  scheduleRouting(QRectF(t->nodeX(), t->nodeY(), TaskNode::BASE_WIDTH,
+                         TaskNode::BASE_HEIGHT));
+  requestRepaint();
 }
 void NodeCanvas::applyZoom(qreal f, const QPointF &p) {
   qreal old = m_scale;
@@ -225,9 +1077,16 @@ void NodeCanvas::paintEvent(QPaintEvent *e) {
   }
 
   p.setRenderHint(QPainter::Antialiasing, true);
-  for (const auto &conn : m_connections) {
-    drawConnection(p, conn.first, conn.second);
+  if (m_edgeBundling && !m_bundleNodes.isEmpty()) {
+    drawBundles(p);
+  } else {
+    for (const auto &conn : m_connections)
+      drawConnection(p, conn.first, conn.second);
   }
+  if (m_analysisVisible)
+    drawAnalysis(p);
+  if (m_hoveredNode && !m_connectingFrom)
+    drawCones(p);
 
   if (m_connectingFrom) {
     QPointF start(m_connectingFrom->x() + m_connectingFrom->width() / 2.0,
@@ -250,6 +1109,22 @@ void NodeCanvas::paintEvent(QPaintEvent *e) {
 }
 
 void NodeCanvas::drawConnection(QPainter &p, TaskNode *n1, TaskNode *n2) {
+  auto route = m_routes.constFind(qMakePair(n1, n2));
+  if (route != m_routes.constEnd() &&
+      route->from == QPointF(n1->nodeX(), n1->nodeY()) &&
+      route->to == QPointF(n2->nodeX(), n2->nodeY())) {
+    QPolygonF line;
+    line.reserve(route->points.size());
+    for (const QPointF &pt : route->points)
+      line.append(pt * m_scale + m_offset);
+    QLinearGradient g(line.first(), line.last());
+    g.setColorAt(0, getStatuses()[n1->status()].color);
+    g.setColorAt(1, getStatuses()[n2->status()].color);
+    p.setPen(QPen(QBrush(g), 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+    p.drawPolyline(line);
+    return;
+  }
+
   QPointF s(n1->x() + n1->width() / 2.0, n1->y() + n1->height() / 2.0);
   QPointF e(n2->x() + n2->width() / 2.0, n2->y() + n2->height() / 2.0);
   QLinearGradient g(s, e);
@@ -302,14 +1177,17 @@ void NodeCanvas::mouseReleaseEvent(QMouseEvent *e) {
 }
 
 void NodeCanvas::mouseDoubleClickEvent(QMouseEvent *e) {
-  if (e->button() == Qt::LeftButton)
+  if (e->button() == Qt::LeftButton && !m_editingLocked)
     addNode((e->position().x() - m_offset.x()) / m_scale -
                 TaskNode::BASE_WIDTH / 2.0,
             (e->position().y() - m_offset.y()) / m_scale -
                 TaskNode::BASE_HEIGHT / 2.0);
 }
 
-void NodeCanvas::resizeEvent(QResizeEvent *e) { QWidget::resizeEvent(e); }
+void NodeCanvas::resizeEvent(QResizeEvent *e) {
+  QWidget::resizeEvent(e);
+  updateAllNodes();
+}
 
 bool NodeCanvas::event(QEvent *e) {
   if (e->type() == QEvent::Gesture) {
@@ -323,14 +1201,23 @@ bool NodeCanvas::event(QEvent *e) {
   return QWidget::event(e);
 }
 
-void NodeCanvas::onNodeChanged() { emit changed(); }
+void NodeCanvas::onNodeChanged() { notifyChanged(); }
 void NodeCanvas::onNodeDeleteRequested(TaskNode *n) { removeNode(n); }
 void NodeCanvas::onNodeConnectionRequested(TaskNode *n) { startConnection(n); }
 
 QJsonObject NodeCanvas::getProjectData() const {
   QJsonArray nd, cd;
-  for (auto *n : m_nodes)
-    nd.append(n->getData());
+  for (auto *n : m_nodes) {
+    QJsonObject o = n->getData();
+    // Gliding nodes are saved where they are heading
+    auto it = m_transitionIndex.constFind(n);
+    if (it != m_transitionIndex.constEnd()) {
+      LayoutPoint t = m_transition.target(it.value());
+      o["x"] = t.x;
+      o["y"] = t.y;
+    }
+    nd.append(o);
+  }
   for (const auto &c : m_connections) {
     int i1 = m_nodes.indexOf(c.first), i2 = m_nodes.indexOf(c.second);
     if (i1 >= 0 && i2 >= 0) {
@@ -350,14 +1237,23 @@ QJsonObject NodeCanvas::getProjectData() const {
 }
 
 void NodeCanvas::loadProjectData(const QJsonObject &d) {
-  clearAll();
+  resetHistory();
+  loadBoard(d);
+}
+
+void NodeCanvas::loadBoard(const QJsonObject &d) {
+  clearBoard();
   m_scale = d["scale"].toDouble(1.0);
   m_offset = QPointF(d["offset_x"].toDouble(), d["offset_y"].toDouble());
+  // Finish times are computed once for the whole board
+  m_graph.beginBulk();
   QJsonArray nd = d["nodes"].toArray();
   for (const auto &nv : nd) {
     auto o = nv.toObject();
     auto *n = addNode(o["x"].toDouble(), o["y"].toDouble(), false);
     n->loadData(o);
+    m_graph.setWeight(m_graphIds.value(n), remainingWork(n));
+    m_graph.setDone(m_graphIds.value(n), isFinished(n));
   }
   QJsonArray cd = d["connections"].toArray();
   for (const auto &cv : cd) {
@@ -365,9 +1261,104 @@ void NodeCanvas::loadProjectData(const QJsonObject &d) {
     if (c.size() == 2)
       addConnection(m_nodes[c[0].toInt()], m_nodes[c[1].toInt()]);
   }
+  m_graph.endBulk();
+  // Saved statuses are taken as they are, even if they disagree
+  m_graph.takeTouched();
+  scheduleSimulation();
+  update();
+}
+
+void NodeCanvas::notifyChanged() {
+  if (m_transactionDepth > 0) {
+    m_transactionDirty = true;
+    return;
+  }
+  // Undoing the last batch past a later edit would drop that edit
+  m_undoSnapshot = QJsonObject();
+  emit changed();
+}
+
+void NodeCanvas::requestRepaint() {
+  if (m_transactionDepth > 0)
+    m_transactionRepaint = true;
+  else
+    update();
+}
+
+void NodeCanvas::beginTransaction() {
+  if (m_transactionDepth++ == 0) {
+    m_transactionSnapshot = getProjectData();
+    m_transactionDirty = false;
+    m_transactionRepaint = false;
+  }
+}
+
+void NodeCanvas::commitTransaction() {
+  if (m_transactionDepth == 0 || --m_transactionDepth > 0)
+    return;
+  if (m_transactionDirty)
+    m_undoSnapshot = m_transactionSnapshot;
+  m_transactionSnapshot = QJsonObject();
+  if (m_transactionRepaint || m_transactionDirty)
+    update();
+  if (m_transactionDirty)
+    emit changed();
+}
+
+void NodeCanvas::rollbackTransaction() {
+  if (m_transactionDepth == 0)
+    return;
+  QJsonObject snapshot = m_transactionSnapshot;
+  m_transactionSnapshot = QJsonObject();
+  restoreSnapshot(snapshot);
+  m_transactionDepth = 0;
+  m_transactionDirty = false;
+  m_transactionRepaint = false;
   update();
 }
 
+void NodeCanvas::undoLastTransaction() {
+  if (m_transactionDepth > 0)
+    return;
+  // Undo during a force layout reverts the layout itself
+  stopForceLayout();
+  if (m_undoSnapshot.isEmpty())
+    return;
+  QJsonObject snapshot = m_undoSnapshot;
+  m_undoSnapshot = QJsonObject();
+  m_transactionDepth = 1;
+  restoreSnapshot(snapshot);
+  m_transactionDepth = 0;
+  update();
+  emit changed();
+}
+
+void NodeCanvas::setEditingLocked(bool locked) {
+  if (m_editingLocked == locked)
+    return;
+  m_editingLocked = locked;
+  if (locked && m_connectingFrom)
+    cancelConnection();
+  for (auto *n : m_nodes)
+    n->setEnabled(!locked);
+}
+
+void NodeCanvas::restoreSnapshot(const QJsonObject &snapshot) {
+  // Keep signals from the reloaded nodes inside the current transaction
+  if (m_connectingFrom)
+    cancelConnection();
+  m_hoverTarget = nullptr;
+  loadBoard(snapshot);
+}
+
+void NodeCanvas::resetHistory() {
+  m_transactionDepth = 0;
+  m_transactionDirty = false;
+  m_transactionRepaint = false;
+  m_transactionSnapshot = QJsonObject();
+  m_undoSnapshot = QJsonObject();
+}
+
 void NodeCanvas::updateBlobs() {
   for (auto &b : m_blobs) {
     b.pos += b.velocity;
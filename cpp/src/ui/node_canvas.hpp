@@ -1,12 +1,24 @@
 #ifndef NODE_CANVAS_HPP
 #define NODE_CANVAS_HPP
 
+#include "graph/reachability_index.hpp"
+#include "graph/schedule_simulator.hpp"
+#include "graph/task_graph.hpp"
+#include "layout/edge_bundler.hpp"
+#include "layout/edge_router.hpp"
+#include "layout/force_layout.hpp"
+#include "layout/layout_transition.hpp"
+#include "layout/placement_index.hpp"
+#include <QElapsedTimer>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QList>
 #include <QPair>
 #include <QPointF>
+#include <QRectF>
 #include <QTimer>
+#include <QVector>
 #include <QWidget>
 
 namespace DevPlanner {
@@ -36,6 +48,8 @@ public:
   // Node management
   TaskNode *addNode(qreal x, qreal y, bool emitChanged = true);
   void removeNode(TaskNode *node, bool emitChanged = true);
+  // Also drops the undo entry and any open transaction, as does
+  // loadProjectData(): neither may carry over to another board
   void clearAll();
 
   // Note mode
@@ -68,6 +82,11 @@ public:
   // Connection overlay
   void updateConnectionOverlay();
 
+  // Draws connections as bundles sharing strokes instead of one path each,
+  // for boards too dense to read edge by edge
+  void setEdgeBundling(bool enabled);
+  bool edgeBundling() const { return m_edgeBundling; }
+
   // Connections
   const QList<QPair<TaskNode *, TaskNode *>> &connections() const {
     return m_connections;
@@ -79,6 +98,60 @@ public:
   void updateNodePosition(TaskNode *node);
   void updateAllNodes();
 
+  // Top-left corner of the nearest free spot for a new node: right of node
+  // nearIdx, or around the view centre when it is -1
+  QPointF freeNodePosition(int nearIdx = -1);
+  // Nodes moved outside the canvas' own layout code (drags)
+  void invalidatePlacement() { m_placementDirty = true; }
+  // Re-routes the edges around a dragged node once the drag pauses
+  void nodeMoved(TaskNode *node);
+
+  // Auto-layout: "tree"/"vertical" layer top to bottom, "horizontal" left to
+  // right, "grid" keeps the reading order, "pack" packs notes tightly in
+  // one block per status. Runs as one transaction.
+  // "force" starts startForceLayout().
+  void arrange(const QString &type);
+
+  // Arranged nodes glide to their places; this lands them immediately
+  void finishTransition();
+  bool isAnimating() const { return !m_transitionNodes.isEmpty(); }
+
+  // Spring embedder on a worker thread; nodes settle on screen as frames
+  // arrive. Pinned nodes stay put. Stopping keeps the positions reached so
+  // far; the whole run is one undo step.
+  void startForceLayout();
+  void stopForceLayout();
+  bool isForceLayoutRunning() const { return !m_forceNodes.isEmpty(); }
+
+  // Dependency analysis, kept current as nodes, connections and statuses
+  // change. Open tasks count as one unit of work, done and cancelled ones
+  // as none, so the critical path is the longest chain of open tasks.
+  QList<TaskNode *> criticalPath();
+  QList<QPair<TaskNode *, TaskNode *>> cyclicConnections() const;
+  bool hasCycles() const { return m_graph.hasCycles(); }
+  // Highlights the critical path and the connections closing cycles
+  void setAnalysisVisible(bool visible);
+  bool analysisVisible() const { return m_analysisVisible; }
+  // Called by TaskNode::setStatus. Dependents without a status, "todo",
+  // "ready" or "blocked" follow their predecessors: "ready" once all of
+  // them are done or cancelled, "blocked" while any is still open.
+  void nodeStatusChanged(TaskNode *node);
+  // Monte Carlo forecast over the task estimates, rerun shortly after each
+  // edit while the analysis is shown. Tasks without an estimate count as
+  // one day, finished ones as none.
+  const SimulationResult &forecast() const { return m_forecast; }
+  // Share of the simulated schedules in which node was critical
+  float criticality(const TaskNode *node) const {
+    return m_criticality.value(node);
+  }
+  // Called by TaskNode::setEstimate
+  void nodeEstimateChanged(TaskNode *node);
+  // Everything node transitively blocks (downstream) or waits for
+  QList<TaskNode *> reachableNodes(TaskNode *node, bool downstream);
+  // The hovered node gets both of its cones highlighted
+  void setHoveredNode(TaskNode *node);
+  TaskNode *hoveredNode() const { return m_hoveredNode; }
+
   // Stats
   QMap<QString, int> getStats() const;
 
@@ -92,6 +165,21 @@ public:
   // Access to nodes
   const QList<TaskNode *> &nodes() const { return m_nodes; }
 
+  // Transactions: mutations between begin/commit produce a single repaint,
+  // a single changed() and a single undo entry; rollback restores the board.
+  // An edit outside a transaction drops the undo entry.
+  void beginTransaction();
+  void commitTransaction();
+  void rollbackTransaction();
+  bool inTransaction() const { return m_transactionDepth > 0; }
+  bool canUndoTransaction() const { return !m_undoSnapshot.isEmpty(); }
+  void undoLastTransaction();
+  // For a transaction left open across the event loop (a time-sliced AI
+  // batch): its rollback reloads the whole board and would take user edits
+  // along, so nodes take none meanwhile. Panning and zooming still work.
+  void setEditingLocked(bool locked);
+  bool editingLocked() const { return m_editingLocked; }
+
 signals:
   void changed();
   void zoomChanged(int percent);
@@ -111,11 +199,56 @@ private slots:
   void onNodeChanged();
   void onNodeDeleteRequested(TaskNode *node);
   void onNodeConnectionRequested(TaskNode *node);
+  void applyForceFrame();
+  void advanceTransition();
+  void startRouting();
+  void applyRoutes();
+  void applyBundles();
+  void startSimulation();
+  void applySimulation();
 
 private:
   void applyZoom(qreal factor, const QPointF &mousePos);
   void drawConnection(QPainter &painter, TaskNode *node1, TaskNode *node2);
+  void drawBundles(QPainter &painter);
+  void drawAnalysis(QPainter &painter);
+  void drawCones(QPainter &painter);
+  void drawForecast(QPainter &painter);
+  static double remainingWork(const TaskNode *node);
+  static bool isFinished(const TaskNode *node);
+  void schedulePropagation();
+  void propagateStatuses();
+  void scheduleSimulation();
   void updateBlobs();
+  void notifyChanged();
+  void requestRepaint();
+  // Board contents only; transactions and undo are the caller's
+  void clearBoard();
+  void loadBoard(const QJsonObject &data);
+  void restoreSnapshot(const QJsonObject &snapshot);
+  void resetHistory();
+  // Commits targets as one transaction, then animates visible nodes there
+  void moveNodesAnimated(const QList<TaskNode *> &nodes,
+                         const std::vector<LayoutPoint> &targets);
+  void resetTransition();
+  // Drops a running force layout without recording it, for when the nodes
+  // it works on go away
+  void cancelForceLayout();
+  // Queues edges near area (canvas coordinates) for re-routing; a null
+  // area re-routes every edge
+  void scheduleRouting(const QRectF &area = QRectF());
+  void dropRoutes(TaskNode *node);
+  void startBundling();
+
+  // Nodes this close to the viewport get their widgets built ahead of time
+  static constexpr int MATERIALIZE_MARGIN = 200;
+  // Free space kept around nodes placed by freeNodePosition
+  static constexpr int PLACEMENT_GAP = 30;
+  static constexpr int TRANSITION_MS = 300;
+  static constexpr int ROUTING_DELAY_MS = 60;
+  static constexpr int SIMULATION_DELAY_MS = 150;
+  // Tasks critical in fewer runs get no badge
+  static constexpr float MIN_SHOWN_CRITICALITY = 0.01f;
 
   QList<TaskNode *> m_nodes;
   QList<QPair<TaskNode *, TaskNode *>> m_connections;
@@ -145,6 +278,77 @@ private:
   QTimer *m_blobTimer = nullptr;
   bool m_noteMode = false;
 
+  // One interpolation pass per frame for every gliding node
+  LayoutTransition m_transition;
+  QList<TaskNode *> m_transitionNodes;
+  QHash<const TaskNode *, int> m_transitionIndex;
+  std::vector<LayoutPoint> m_transitionFrame;
+  QElapsedTimer m_transitionClock;
+  QTimer *m_transitionTimer = nullptr;
+
+  ForceLayoutRunner m_forceLayout;
+  QTimer *m_forceTimer = nullptr;
+  QList<TaskNode *> m_forceNodes; // frame order, empty when idle
+  QJsonObject m_forceSnapshot;
+
+  // Occupied node rects; rebuilt on the next query after moves and deletes,
+  // appended to as nodes are added
+  PlacementIndex m_placement;
+  bool m_placementDirty = true;
+  bool m_hasLastDrop = false;
+  QPointF m_lastDrop;
+  QPointF m_lastDropCentre;
+
+  // Orthogonal edge routes in canvas coordinates, kept per connection along
+  // with where its endpoints were when it was routed. An edge whose
+  // endpoints have moved since draws as a plain curve until re-routed.
+  struct EdgeRoute {
+    QVector<QPointF> points;
+    QRectF bounds;
+    QPointF from, to;
+  };
+  using Edge = QPair<TaskNode *, TaskNode *>;
+  QHash<Edge, EdgeRoute> m_routes;
+  EdgeRoutingRunner m_router;
+  QTimer *m_routingDelay = nullptr;
+  QTimer *m_routingPoll = nullptr;
+  QList<Edge> m_routingEdges; // batch in flight
+  QVector<QPair<QPointF, QPointF>> m_routingEnds;
+  bool m_routeAll = false;
+  QRectF m_routeArea;
+
+  // Bundles are computed for one layout and reused until it changes; node
+  // ends follow their nodes live, hubs stay until the next computation
+  bool m_edgeBundling = false;
+  EdgeBundlingRunner m_bundler;
+  QTimer *m_bundlingPoll = nullptr;
+  EdgeBundles m_bundles;
+  QList<TaskNode *> m_bundleNodes;   // node order of m_bundles
+  QList<TaskNode *> m_bundlingNodes; // node order of the batch in flight
+
+  TaskGraph m_graph;
+  QHash<const TaskNode *, int> m_graphIds;
+  QVector<TaskNode *> m_graphNodes; // by graph id, null for free ids
+  ReachabilityIndex m_reach{m_graph};
+  TaskNode *m_hoveredNode = nullptr;
+  bool m_analysisVisible = false;
+  QTimer *m_propagationDelay = nullptr;
+  bool m_propagating = false;
+
+  ScheduleSimulationRunner m_simulator;
+  QTimer *m_simulationDelay = nullptr;
+  QTimer *m_simulationPoll = nullptr;
+  QVector<TaskNode *> m_simulatingNodes; // graph ids of the run in flight
+  SimulationResult m_forecast;
+  QHash<const TaskNode *, float> m_criticality;
+
+  int m_transactionDepth = 0;
+  bool m_transactionDirty = false;
+  bool m_transactionRepaint = false;
+  QJsonObject m_transactionSnapshot;
+  QJsonObject m_undoSnapshot;
+  bool m_editingLocked = false;
+
   friend class ConnectionOverlay;
 };
 
@@ -2,27 +2,39 @@
 #include "core/config.hpp"
 #include "node_canvas.hpp"
 #include <QHBoxLayout>
+#include <QInputDialog>
+#include <QJsonArray>
 #include <QMenu>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPixmap>
+#include <QRegularExpression>
 #include <QVBoxLayout>
+#include <cmath>
 
 namespace DevPlanner {
 
 TaskNode::TaskNode(qreal x, qreal y, NodeCanvas *canvas, const QString &title,
                    QWidget *parent)
-    : GlassmorphismWidget(parent), m_canvas(canvas), m_nodeX(x), m_nodeY(y) {
+    : GlassmorphismWidget(parent), m_canvas(canvas), m_nodeX(x), m_nodeY(y),
+      m_isNote(title.isEmpty()), m_title(title) {
   setFixedSize(BASE_WIDTH, BASE_HEIGHT);
   setMouseTracking(true);
   setAttribute(Qt::WA_TranslucentBackground);
   move(static_cast<int>(x), static_cast<int>(y));
-  setupUI(title);
+}
+
+void TaskNode::materialize() {
+  if (m_materialized)
+    return;
+  m_materialized = true;
+  setupUI();
+  updateScale(m_scale);
   show();
 }
 
-void TaskNode::setupUI(const QString &title) {
+void TaskNode::setupUI() {
   auto *layout = new QVBoxLayout(this);
   layout->setContentsMargins(15, 12, 15, 12);
   layout->setSpacing(8);
@@ -33,7 +45,7 @@ void TaskNode::setupUI(const QString &title) {
   m_statusIndicator = new QLabel(this);
   updateStatusIndicator();
 
-  m_titleEdit = new QLineEdit(title, this);
+  m_titleEdit = new QLineEdit(m_title, this);
   m_titleEdit->setContextMenuPolicy(Qt::NoContextMenu);
   m_titleEdit->setStyleSheet(
       "QLineEdit { background: transparent; border: none; color: #ffffff; "
@@ -55,6 +67,7 @@ void TaskNode::setupUI(const QString &title) {
   header->addWidget(m_deleteBtn);
 
   m_descEdit = new QTextEdit(this);
+  m_descEdit->setPlainText(m_description);
   m_descEdit->setContextMenuPolicy(Qt::NoContextMenu);
   m_descEdit->setPlaceholderText("Notes...");
   m_descEdit->setStyleSheet(
@@ -67,7 +80,7 @@ void TaskNode::setupUI(const QString &title) {
   m_descEdit->installEventFilter(this);
   m_descEdit->viewport()->installEventFilter(this);
 
-  if (title.isEmpty()) {
+  if (m_isNote) {
     m_titleEdit->hide();
     layout->setContentsMargins(10, 8, 10, 8);
     layout->setSpacing(4);
@@ -97,6 +110,8 @@ void TaskNode::onContentChanged() { emit changed(); }
 void TaskNode::onDeleteClicked() { emit deleteRequested(this); }
 
 void TaskNode::updateStatusIndicator() {
+  if (!m_statusIndicator)
+    return;
   QString c = getStatuses()[m_status].color;
   m_statusIndicator->setStyleSheet(
       QString("background-color: %1; border-radius: 6px; "
@@ -110,25 +125,55 @@ void TaskNode::setStatus(const QString &s) {
     m_status = s;
     updateStatusIndicator();
     update();
+    if (m_canvas)
+      m_canvas->nodeStatusChanged(this);
     emit changed();
   }
 }
+void TaskNode::setPinned(bool pinned) {
+  if (m_pinned == pinned)
+    return;
+  m_pinned = pinned;
+  update();
+  emit changed();
+}
 void TaskNode::setNodePosition(qreal x, qreal y) {
   m_nodeX = x;
   m_nodeY = y;
 }
-QString TaskNode::title() const { return m_titleEdit->text(); }
-void TaskNode::setTitle(const QString &t) { m_titleEdit->setText(t); }
-QString TaskNode::description() const { return m_descEdit->toPlainText(); }
-void TaskNode::setDescription(const QString &d) { m_descEdit->setPlainText(d); }
+QString TaskNode::title() const {
+  return m_titleEdit ? m_titleEdit->text() : m_title;
+}
+void TaskNode::setTitle(const QString &t) {
+  if (m_titleEdit) {
+    m_titleEdit->setText(t);
+  } else if (t != m_title) {
+    m_title = t;
+    emit changed();
+  }
+}
+QString TaskNode::description() const {
+  return m_descEdit ? m_descEdit->toPlainText() : m_description;
+}
+void TaskNode::setDescription(const QString &d) {
+  if (m_descEdit) {
+    m_descEdit->setPlainText(d);
+  } else if (d != m_description) {
+    m_description = d;
+    emit changed();
+  }
+}
 QPointF TaskNode::getCenter() const {
   return QPointF(m_nodeX + BASE_WIDTH / 2.0, m_nodeY + BASE_HEIGHT / 2.0);
 }
 void TaskNode::updateScale(qreal s) {
   qreal effectiveScale = qMax(s, 0.5);
+  m_scale = s;
 
   setFixedSize(static_cast<int>(BASE_WIDTH * effectiveScale),
                static_cast<int>(BASE_HEIGHT * effectiveScale));
+  if (!m_materialized)
+    return;
 
   int titleFontSize = qMax(static_cast<int>(14 * effectiveScale), 9);
   int descFontSize = qMax(static_cast<int>(13 * effectiveScale), 8);
@@ -198,6 +243,13 @@ void TaskNode::paintEvent(QPaintEvent *event) {
            m_isHoverTarget ? 2 : 1);
   painter.setPen(pen);
   painter.drawPath(path);
+
+  if (m_pinned) {
+    qreal r = qMax(3.0, 4 * m_scale);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(217, 0, 255));
+    painter.drawEllipse(QPointF(width() / 2.0, r + 3), r, r);
+  }
 }
 
 void TaskNode::mousePressEvent(QMouseEvent *e) {
@@ -211,7 +263,13 @@ void TaskNode::mousePressEvent(QMouseEvent *e) {
     return;
   }
   if (e->button() == Qt::LeftButton) {
+    // Grabbing a node hands the board back to the user
+    if (m_canvas) {
+      m_canvas->stopForceLayout();
+      m_canvas->finishTransition();
+    }
     m_isDragging = true;
+    m_dragMoved = false;
     m_dragOffset = e->pos();
     raise();
   } else if (e->button() == Qt::RightButton)
@@ -227,9 +285,11 @@ void TaskNode::mouseMoveEvent(QMouseEvent *e) {
   if (m_isDragging) {
     QPoint p = mapToParent(e->pos() - m_dragOffset);
     move(p);
+    m_dragMoved = true;
     if (m_canvas) {
       m_nodeX = (p.x() - m_canvas->offset().x()) / m_canvas->scale();
       m_nodeY = (p.y() - m_canvas->offset().y()) / m_canvas->scale();
+      m_canvas->nodeMoved(this);
       m_canvas->update();
       m_canvas->updateConnectionOverlay();
     }
@@ -237,10 +297,18 @@ void TaskNode::mouseMoveEvent(QMouseEvent *e) {
 }
 
 void TaskNode::mouseReleaseEvent(QMouseEvent *e) {
+  bool moved = m_isDragging && m_dragMoved;
+  if (moved && m_canvas)
+    m_canvas->invalidatePlacement();
   m_isDragging = false;
-  emit changed();
+  m_dragMoved = false;
+  // A plain click is no edit and keeps the canvas undo entry
+  if (moved)
+    emit changed();
 }
 void TaskNode::enterEvent(QEnterEvent *e) {
+  if (m_canvas)
+    m_canvas->setHoveredNode(this);
   if (m_canvas && m_canvas->isConnecting() &&
       m_canvas->getConnectingFrom() != this) {
     setHoverTarget(true);
@@ -248,6 +316,8 @@ void TaskNode::enterEvent(QEnterEvent *e) {
   }
 }
 void TaskNode::leaveEvent(QEvent *e) {
+  if (m_canvas && m_canvas->hoveredNode() == this)
+    m_canvas->setHoveredNode(nullptr);
   if (m_isHoverTarget) {
     setHoverTarget(false);
     if (m_canvas)
@@ -268,6 +338,10 @@ void TaskNode::showContextMenu(const QPoint &p) {
     connect(a, &QAction::triggered, this, [this, k]() { setStatus(k); });
   }
   menu.addSeparator();
+  connect(menu.addAction("Estimate..."), &QAction::triggered, this,
+          &TaskNode::editEstimate);
+  connect(menu.addAction(m_pinned ? "Unpin" : "Pin"), &QAction::triggered,
+          this, [this]() { setPinned(!m_pinned); });
   connect(menu.addAction("Connect"), &QAction::triggered, this,
           [this]() { emit connectionRequested(this); });
   connect(menu.addAction("Delete"), &QAction::triggered, this,
@@ -276,19 +350,106 @@ void TaskNode::showContextMenu(const QPoint &p) {
 }
 
 void TaskNode::startConnection() { emit connectionRequested(this); }
+
+void TaskNode::setEstimate(const TaskEstimate &estimate) {
+  if (estimate.set == m_estimate.set &&
+      estimate.optimistic == m_estimate.optimistic &&
+      estimate.likely == m_estimate.likely &&
+      estimate.pessimistic == m_estimate.pessimistic)
+    return;
+  m_estimate = estimate;
+  if (m_canvas)
+    m_canvas->nodeEstimateChanged(this);
+  emit changed();
+}
+
+namespace {
+
+// One number is a fixed estimate, three are optimistic / likely /
+// pessimistic, an empty line clears it. On anything else error says why.
+bool parseEstimate(const QString &text, TaskEstimate *estimate,
+                   QString *error) {
+  QStringList parts =
+      text.split(QRegularExpression("[\\s/;]+"), Qt::SkipEmptyParts);
+  QList<float> days;
+  for (const QString &part : parts) {
+    bool number = false;
+    float d = QString(part).replace(',', '.').toFloat(&number);
+    if (!number || !std::isfinite(d)) {
+      *error = QString("\"%1\" is not a number of days").arg(part);
+      return false;
+    }
+    if (d < 0) {
+      *error = QString("%1 days is negative").arg(part);
+      return false;
+    }
+    days.append(d);
+  }
+  if (days.isEmpty()) {
+    *estimate = TaskEstimate();
+  } else if (days.size() == 1) {
+    *estimate = {days[0], days[0], days[0], true};
+  } else if (days.size() == 3) {
+    *estimate = {days[0], days[1], days[2], true};
+  } else {
+    *error = QString("Expected one or three numbers, got %1").arg(days.size());
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+void TaskNode::editEstimate() {
+  QString text;
+  if (m_estimate.isSet())
+    text = QString("%1 / %2 / %3")
+               .arg(m_estimate.optimistic)
+               .arg(m_estimate.likely)
+               .arg(m_estimate.pessimistic);
+  const QString prompt = "Days: optimistic / likely / pessimistic";
+  QString label = prompt;
+  // Asked again with the reason until the input makes sense or is cancelled
+  for (;;) {
+    bool ok = false;
+    text = QInputDialog::getText(this, "Estimate", label, QLineEdit::Normal,
+                                 text, &ok);
+    if (!ok)
+      return;
+    TaskEstimate estimate;
+    QString error;
+    if (parseEstimate(text, &estimate, &error)) {
+      setEstimate(estimate);
+      return;
+    }
+    label = "⚠ " + error + "\n" + prompt;
+  }
+}
+
 QJsonObject TaskNode::getData() const {
   QJsonObject o;
-  o["title"] = m_titleEdit->text();
-  o["description"] = m_descEdit->toPlainText();
+  o["title"] = title();
+  o["description"] = description();
   o["status"] = m_status;
   o["x"] = m_nodeX;
   o["y"] = m_nodeY;
+  if (m_pinned)
+    o["pinned"] = true;
+  if (m_estimate.isSet())
+    o["estimate"] = QJsonArray{m_estimate.optimistic, m_estimate.likely,
+                               m_estimate.pessimistic};
   return o;
 }
 void TaskNode::loadData(const QJsonObject &d) {
-  m_titleEdit->setText(d["title"].toString());
-  m_descEdit->setPlainText(d["description"].toString());
+  setTitle(d["title"].toString());
+  setDescription(d["description"].toString());
   m_status = d["status"].toString("none");
+  m_pinned = d["pinned"].toBool();
+  QJsonArray estimate = d["estimate"].toArray();
+  if (estimate.size() == 3)
+    m_estimate = {static_cast<float>(estimate[0].toDouble()),
+                  static_cast<float>(estimate[1].toDouble()),
+                  static_cast<float>(estimate[2].toDouble()), true};
   updateStatusIndicator();
 }
 
@@ -2,6 +2,7 @@
 #define TASK_NODE_HPP
 
 #include "glassmorphism_widget.hpp"
+#include "graph/schedule_simulator.hpp"
 #include <QLabel>
 #include <QLineEdit>
 #include <QMenu>
@@ -33,6 +34,10 @@ public:
   QString status() const { return m_status; }
   void setStatus(const QString &status);
 
+  // Days left, for the schedule forecast; unset until given
+  const TaskEstimate &estimate() const { return m_estimate; }
+  void setEstimate(const TaskEstimate &estimate);
+
   // Data
   QString title() const;
   void setTitle(const QString &title);
@@ -41,6 +46,16 @@ public:
 
   QPointF getCenter() const;
 
+  // Pinned nodes are left where they are by the force layout
+  bool isPinned() const { return m_pinned; }
+  void setPinned(bool pinned);
+  bool isDragging() const { return m_isDragging; }
+
+  // Child widgets are built when the node first comes into view, so large
+  // boards and AI batches do not pay for off-screen editors
+  bool isMaterialized() const { return m_materialized; }
+  void materialize();
+
   // Scale
   void updateScale(qreal scale);
 
@@ -71,9 +86,10 @@ private slots:
   void onDeleteClicked();
   void showContextMenu(const QPoint &pos);
   void startConnection();
+  void editEstimate();
 
 private:
-  void setupUI(const QString &title);
+  void setupUI();
   void updateStatusIndicator();
   QIcon createColorIcon(const QString &colorHex, int size = 16);
 
@@ -81,13 +97,23 @@ private:
   qreal m_nodeX;
   qreal m_nodeY;
   QString m_status = "none";
+  bool m_pinned = false;
+  TaskEstimate m_estimate;
+
+  // Texts and scale held until the widgets exist
+  bool m_materialized = false;
+  bool m_isNote;
+  QString m_title;
+  QString m_description;
+  qreal m_scale = 1.0;
 
-  QLabel *m_statusIndicator;
-  QLineEdit *m_titleEdit;
-  QTextEdit *m_descEdit;
-  QPushButton *m_deleteBtn;
+  QLabel *m_statusIndicator = nullptr;
+  QLineEdit *m_titleEdit = nullptr;
+  QTextEdit *m_descEdit = nullptr;
+  QPushButton *m_deleteBtn = nullptr;
 
   bool m_isDragging = false;
+  bool m_dragMoved = false;
   QPoint m_dragOffset;
   bool m_isHoverTarget = false;
 };